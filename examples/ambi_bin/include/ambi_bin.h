@@ -265,6 +265,23 @@ void ambi_bin_setUseDefaultHRIRsflag(void* const hAmbi, int newState);
  */
 void ambi_bin_setSofaFilePath(void* const hAmbi, const char* path);
 
+/*
+ * Function: ambi_bin_setCacheDirectory
+ * ------------------------------------
+ * Sets a directory in which the processed HRTF data (filterbank coefficients
+ * and ITDs) and the binaural decoding matrices are cached, keyed by a hash of
+ * the contents of the SOFA file (or of the default HRIR set) and the relevant
+ * settings. Subsequent initialisations with the same HRIR set and settings
+ * then load the cached data, instead of computing it again. Stale, truncated
+ * or corrupt cache files are ignored and re-written.
+ * Disabled by default.
+ *
+ * Input Arguments:
+ *     hAmbi - ambi_bin handle
+ *     path  - existing directory for the cache files (NULL: disable caching)
+ */
+void ambi_bin_setCacheDirectory(void* const hAmbi, const char* path);
+
 /*
  * Function: ambi_bin_setInputOrderPreset
  * --------------------------------------
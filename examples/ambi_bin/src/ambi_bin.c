@@ -84,6 +84,8 @@ void ambi_bin_create
     pars->hrir_dirs_deg = NULL;
     pars->itds_s = NULL;
     pars->hrtf_fb = NULL;
+    pars->cache_dir = NULL;
+    pars->hrtf_cache_key = 0;
     
     /* flags */
     pData->procStatus = PROC_STATUS_NOT_ONGOING;
@@ -128,6 +130,7 @@ void ambi_bin_destroy
         free(pars->itds_s);
         free(pars->hrirs);
         free(pars->hrir_dirs_deg);
+        free(pars->cache_dir);
         free(pars);
         free(pData->progressBarText);
         
@@ -166,7 +169,12 @@ void ambi_bin_initCodec
 {
     ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
     codecPars* pars = pData->pars;
-    int i, j, nSH, order, band;
+    int i, j, nSH, order, band, decoderCached;
+    int decParams[6];
+    uint64_t decCacheKey;
+    void* hCache;
+    const void* cachedDecMtx;
+    size_t nBytes;
     
     if (pData->codecStatus != CODEC_STATUS_NOT_INITIALISED)
         return; /* re-init not required, or already happening */
@@ -192,6 +200,12 @@ void ambi_bin_initCodec
     }
     pData->nSH = nSH;
     
+    if(pData->reinit_hrtfsFLAG){
+        /* the HRIRs need not be processed again, if they have been processed before (with the same settings) */
+        pars->hrtf_cache_key = ambi_bin_getHRTFcacheKey(hAmbi);
+        if(ambi_bin_loadHRTFcache(hAmbi))
+            pData->reinit_hrtfsFLAG = 0;
+    }
     if(pData->reinit_hrtfsFLAG){
         /* load sofa file or default hrir data */
         strcpy(pData->progressBarText,"Preparing HRIRs");
@@ -223,6 +237,8 @@ void ambi_bin_initCodec
         pars->hrtf_fb = realloc1d(pars->hrtf_fb, HYBRID_BANDS * NUM_EARS * (pars->N_hrir_dirs)*sizeof(float_complex));
         HRIRs2FilterbankHRTFs(pars->hrirs, pars->N_hrir_dirs, pars->hrir_len, pars->hrtf_fb);
         diffuseFieldEqualiseHRTFs(pars->N_hrir_dirs, pars->itds_s, pData->freqVector, HYBRID_BANDS, pars->hrtf_fb);
+        if(pars->hrtf_cache_key!=0)
+            ambi_bin_saveHRTFcache(hAmbi);
         
         pData->reinit_hrtfsFLAG = 0;
     }
@@ -232,7 +248,31 @@ void ambi_bin_initCodec
     pData->progressBar0_1 = 0.95f;
     float_complex* decMtx;
     decMtx = calloc1d(HYBRID_BANDS*NUM_EARS*nSH, sizeof(float_complex));
-    switch(pData->method){
+    decCacheKey = 0;
+    decoderCached = 0;
+    if(pars->cache_dir!=NULL && pars->hrtf_cache_key!=0){
+        /* decoders are cached under the key of the HRTFs they were computed from, and the decoder settings */
+        decParams[0] = order;
+        decParams[1] = (int)pData->method;
+        decParams[2] = pData->enableDiffuseMatching;
+        decParams[3] = pData->enableMaxRE;
+        decParams[4] = pData->fs;
+        decParams[5] = HYBRID_BANDS;
+        decCacheKey = hrtfCache_hash(pars->hrtf_cache_key, decParams, sizeof(decParams));
+        if(hrtfCache_open(&hCache, pars->cache_dir, decCacheKey)){
+            cachedDecMtx = hrtfCache_getBlock(hCache, 0, &nBytes);
+            if(cachedDecMtx!=NULL && nBytes==HYBRID_BANDS*NUM_EARS*nSH*sizeof(float_complex)){
+                /* (a decoder with non-finite values is computed again, rather than used) */
+                decoderCached = 1;
+                for(i=0; i<2*HYBRID_BANDS*NUM_EARS*nSH && decoderCached; i++)
+                    decoderCached = isfinite(((const float*)cachedDecMtx)[i]);
+                if(decoderCached)
+                    memcpy(decMtx, cachedDecMtx, nBytes);
+            }
+            hrtfCache_close(&hCache);
+        }
+    }
+    if(!decoderCached) switch(pData->method){
         default:
         case DECODING_METHOD_LS:
             getBinauralAmbiDecoderMtx(pars->hrtf_fb, pars->hrir_dirs_deg, pars->N_hrir_dirs, HYBRID_BANDS,
@@ -260,6 +300,11 @@ void ambi_bin_initCodec
                                       pData->enableDiffuseMatching, pData->enableMaxRE, decMtx);
             break;
     }
+    if(!decoderCached && decCacheKey!=0){
+        cachedDecMtx = decMtx;
+        nBytes = HYBRID_BANDS*NUM_EARS*nSH*sizeof(float_complex);
+        hrtfCache_save(pars->cache_dir, decCacheKey, 1, &cachedDecMtx, &nBytes);
+    }
     
     /* Apply Phase Warping */
     if(pData->enablePhaseWarping){
@@ -457,6 +502,19 @@ void ambi_bin_setSofaFilePath(void* const hAmbi, const char* path)
     ambi_bin_setCodecStatus(hAmbi, CODEC_STATUS_NOT_INITIALISED);
 }
 
+void ambi_bin_setCacheDirectory(void* const hAmbi, const char* path)
+{
+    ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
+    codecPars* pars = pData->pars;
+    
+    free1d((void**)&(pars->cache_dir));
+    if(path!=NULL){
+        pars->cache_dir = malloc1d(strlen(path) + 1);
+        strcpy(pars->cache_dir, path);
+    }
+    pars->hrtf_cache_key = ambi_bin_getHRTFcacheKey(hAmbi);
+}
+
 void ambi_bin_setInputOrderPreset(void* const hAmbi, INPUT_ORDERS newOrder)
 {
     ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
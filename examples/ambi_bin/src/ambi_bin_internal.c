@@ -40,3 +40,87 @@ void ambi_bin_setCodecStatus(void* const hAmbi, CODEC_STATUS newStatus)
     }
     pData->codecStatus = newStatus;
 }
+
+uint64_t ambi_bin_getHRTFcacheKey(void* const hAmbi)
+{
+    ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
+    codecPars* pars = pData->pars;
+    const char tag[] = "ambi_bin_hrtfs";
+    int params[4];
+    uint64_t key;
+
+    if(pars->cache_dir==NULL)
+        return 0;
+    key = hrtfCache_hash(SAF_HRTF_CACHE_HASH_SEED, tag, sizeof(tag));
+    if(!pData->useDefaultHRIRsFLAG && pars->sofa_filepath!=NULL)
+        key = hrtfCache_hashFile(key, pars->sofa_filepath);
+    else{
+        key = hrtfCache_hash(key, __default_hrirs, sizeof(__default_hrirs));
+        key = hrtfCache_hash(key, __default_hrir_dirs_deg, sizeof(__default_hrir_dirs_deg));
+        key = hrtfCache_hash(key, &__default_hrir_fs, sizeof(int));
+    }
+    if(key==0)
+        return 0;
+    params[0] = pData->fs;
+    params[1] = HOP_SIZE;
+    params[2] = HYBRID_BANDS;
+    params[3] = pData->useDefaultHRIRsFLAG;
+    return hrtfCache_hash(key, params, sizeof(params));
+}
+
+int ambi_bin_loadHRTFcache(void* const hAmbi)
+{
+    ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
+    codecPars* pars = pData->pars;
+    void* hCache;
+    const int* dims;
+    const void *dirs, *itds, *fb;
+    size_t nBytesDims, nBytesDirs, nBytesITDs, nBytesFB;
+    int loaded;
+
+    if(!hrtfCache_open(&hCache, pars->cache_dir, pars->hrtf_cache_key))
+        return 0;
+    dims = (const int*)hrtfCache_getBlock(hCache, 0, &nBytesDims);
+    dirs = hrtfCache_getBlock(hCache, 1, &nBytesDirs);
+    itds = hrtfCache_getBlock(hCache, 2, &nBytesITDs);
+    fb = hrtfCache_getBlock(hCache, 3, &nBytesFB);
+    loaded = dims!=NULL && nBytesDims==3*sizeof(int) && dims[0]>0 &&
+             nBytesDirs == (size_t)dims[0]*2*sizeof(float) &&
+             nBytesITDs == (size_t)dims[0]*sizeof(float) &&
+             nBytesFB == (size_t)HYBRID_BANDS*NUM_EARS*dims[0]*sizeof(float_complex);
+    if(loaded){
+        pars->N_hrir_dirs = dims[0];
+        pars->hrir_len = dims[1];
+        pars->hrir_fs = dims[2];
+        pars->hrir_dirs_deg = realloc1d(pars->hrir_dirs_deg, nBytesDirs);
+        memcpy(pars->hrir_dirs_deg, dirs, nBytesDirs);
+        pars->itds_s = realloc1d(pars->itds_s, nBytesITDs);
+        memcpy(pars->itds_s, itds, nBytesITDs);
+        pars->hrtf_fb = realloc1d(pars->hrtf_fb, nBytesFB);
+        memcpy(pars->hrtf_fb, fb, nBytesFB);
+    }
+    hrtfCache_close(&hCache);
+    return loaded;
+}
+
+void ambi_bin_saveHRTFcache(void* const hAmbi)
+{
+    ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
+    codecPars* pars = pData->pars;
+    int dims[3];
+    const void* blocks[4];
+    size_t nBytes[4];
+
+    dims[0] = pars->N_hrir_dirs;
+    dims[1] = pars->hrir_len;
+    dims[2] = pars->hrir_fs;
+    blocks[0] = dims;
+    nBytes[0] = 3*sizeof(int);
+    blocks[1] = pars->hrir_dirs_deg;
+    nBytes[1] = pars->N_hrir_dirs*2*sizeof(float);
+    blocks[2] = pars->itds_s;
+    nBytes[2] = pars->N_hrir_dirs*sizeof(float);
+    blocks[3] = pars->hrtf_fb;
+    nBytes[3] = HYBRID_BANDS*NUM_EARS*(pars->N_hrir_dirs)*sizeof(float_complex);
+    hrtfCache_save(pars->cache_dir, pars->hrtf_cache_key, 4, blocks, nBytes);
+}
@@ -106,6 +106,10 @@ typedef struct _codecPars
     float* itds_s; /* interaural-time differences for each HRIR (in seconds); N_hrirs x 1 */
     float_complex* hrtf_fb; /* HRTF filterbank coeffs; FLAT: nBands x nCH x N_hrirs */
     
+    /* on-disk cache */
+    char* cache_dir; /* directory of the HRTF/decoder cache; NULL: disabled */
+    uint64_t hrtf_cache_key; /* key of the current HRTFs in the cache; 0: not cached */
+    
 }codecPars;
     
 /*
@@ -178,6 +182,43 @@ typedef struct _ambi_bin
  */
 void ambi_bin_setCodecStatus(void* const hAmbi, CODEC_STATUS newStatus);
 
+/*
+ * Function: ambi_bin_getHRTFcacheKey
+ * ----------------------------------
+ * Returns the key of the current HRIR set and settings in the on-disk cache
+ * (see "hrtfCache_hash")
+ *
+ * Input Arguments:
+ *     hAmbi - ambi_bin handle
+ * Returns:
+ *     cache key, or 0 if caching is disabled or the HRIR data cannot be read
+ */
+uint64_t ambi_bin_getHRTFcacheKey(void* const hAmbi);
+
+/*
+ * Function: ambi_bin_loadHRTFcache
+ * --------------------------------
+ * Loads the HRIR directions, ITDs and HRTF filterbank coefficients from the
+ * on-disk cache (if they have been cached under "pars->hrtf_cache_key")
+ *
+ * Input Arguments:
+ *     hAmbi - ambi_bin handle
+ * Returns:
+ *     1: loaded, 0: not cached
+ */
+int ambi_bin_loadHRTFcache(void* const hAmbi);
+
+/*
+ * Function: ambi_bin_saveHRTFcache
+ * --------------------------------
+ * Stores the HRIR directions, ITDs and HRTF filterbank coefficients in the
+ * on-disk cache, under "pars->hrtf_cache_key"
+ *
+ * Input Arguments:
+ *     hAmbi - ambi_bin handle
+ */
+void ambi_bin_saveHRTFcache(void* const hAmbi);
+
 
 #ifdef __cplusplus
 } /* extern "C" { */
@@ -20,7 +20,9 @@
  * Convolves input audio (up to 64 channels) with interpolated HRTFs in the
  * time-frequency domain. The HRTFs are interpolated by applying amplitude-
  * preserving VBAP gains to the HRTF magnitude responses and inter-aural time
- * differences (ITDs) individually, before being re-combined. The example also
+ * differences (ITDs) individually, before being re-combined. Alternatively,
+ * the input audio may be convolved with interpolated minimum-phase HRIRs in
+ * the time domain, with the ITDs applied as fractional delays. The example also
  * allows the user to specify an external SOFA file for the convolution.
  *
  * Dependencies:
@@ -75,6 +77,26 @@ typedef enum _SOURCE_CONFIG_PRESETS{
 typedef enum _INTERP_MODES{
     INTERP_TRI = 1  /* Triangular interpolation */
 }INTERP_MODES;
+
+/*
+ * Enum: RENDER_MODES
+ * ------------------
+ * Available rendering engines
+ *
+ * Options:
+ *     RENDER_MODE_TFT     - The sources are rendered in the time-frequency
+ *                           domain (afSTFT), with HRTFs interpolated as
+ *                           magnitudes plus inter-aural phase differences
+ *     RENDER_MODE_TD_CONV - The sources are convolved with interpolated
+ *                           minimum-phase HRIRs in the time domain (uniformly
+ *                           partitioned convolution), after delaying each ear
+ *                           by the interpolated ITD. This is cheaper and more
+ *                           accurate for lower numbers of sources.
+ */
+typedef enum _RENDER_MODES{
+    RENDER_MODE_TFT = 1,
+    RENDER_MODE_TD_CONV
+}RENDER_MODES;
     
 /*
  * Enum: CODEC_STATUS
@@ -96,7 +118,9 @@ typedef enum _CODEC_STATUS{
     CODEC_STATUS_INITIALISING
 }CODEC_STATUS;
     
-#define BINAURALISER_MAX_NUM_INPUTS ( 64 )
+#ifndef BINAURALISER_MAX_NUM_INPUTS
+# define BINAURALISER_MAX_NUM_INPUTS ( 256 ) /* may be overriden at compile time */
+#endif
 #define BINAURALISER_PROGRESSBARTEXT_CHAR_LENGTH 256
     
     
@@ -247,6 +271,23 @@ void binauraliser_setUseDefaultHRIRsflag(void* const hBin, int newState);
  */
 void binauraliser_setSofaFilePath(void* const hBin, const char* path);
 
+/*
+ * Function: binauraliser_setHRTFcacheDirectory
+ * --------------------------------------------
+ * Sets a directory in which the processed HRTF data (filterbank coefficients,
+ * ITDs and the interpolation table) are cached, keyed by a hash of the
+ * contents of the SOFA file (or of the default HRIR set) and the processing
+ * settings. Subsequent initialisations with the same HRIR set and sampling
+ * rate then load the cached data, instead of processing the HRIRs again.
+ * Stale, truncated or corrupt cache files are ignored and re-written.
+ * Disabled by default.
+ *
+ * Input Arguments:
+ *     hBin - binauraliser handle
+ *     path - existing directory for the cache files (NULL: disable caching)
+ */
+void binauraliser_setHRTFcacheDirectory(void* const hBin, const char* path);
+
 /*
  * Function: binauraliser_setInputConfigPreset
  * -------------------------------------------
@@ -350,6 +391,35 @@ void binauraliser_setRPYflag(void* const hBin, int newState);
     /* NOT IMPLEMENTED YET */
 void binauraliser_setInterpMode(void* const hBin, int newMode);
 
+/*
+ * Function: binauraliser_setRenderMode
+ * ------------------------------------
+ * Sets the rendering engine (see 'RENDER_MODES' enum). The source directions
+ * and rotation settings apply to both.
+ * Note: the codec is re-initialised upon changing the rendering engine
+ *
+ * Input Arguments:
+ *     hBin    - binauraliser handle
+ *     newMode - new rendering engine (see 'RENDER_MODES' enum)
+ */
+void binauraliser_setRenderMode(void* const hBin, int newMode);
+
+/*
+ * Function: binauraliser_setInterpCacheBudget
+ * -------------------------------------------
+ * Sets the memory budget of the interpolated HRTF cache (RENDER_MODE_TFT only).
+ * The interpolated HRTFs for each direction of the interpolation table are
+ * cached once first needed, and reused whenever a source revisits that
+ * direction (e.g. with head-tracking). The least recently used HRTFs are
+ * replaced once the budget is reached. Each direction takes approx. 2kB.
+ * Note: the codec is re-initialised upon changing the budget
+ *
+ * Input Arguments:
+ *     hBin      - binauraliser handle
+ *     budget_kB - memory budget in kilobytes; 0: no cache (default)
+ */
+void binauraliser_setInterpCacheBudget(void* const hBin, int budget_kB);
+
 
 /* ========================================================================== */
 /*                                Get Functions                               */
@@ -672,16 +742,42 @@ int binauraliser_getRPYflag(void* const hBin);
     /* NOT IMPLEMENTED YET */
 int binauraliser_getInterpMode(void* const hBin);
 
+/*
+ * Function: binauraliser_getRenderMode
+ * ------------------------------------
+ * Returns the current rendering engine (see 'RENDER_MODES' enum)
+ *
+ * Input Arguments:
+ *     hBin - binauraliser handle
+ * Returns:
+ *     current rendering engine (see 'RENDER_MODES' enum)
+ */
+int binauraliser_getRenderMode(void* const hBin);
+
+/*
+ * Function: binauraliser_getInterpCacheBudget
+ * -------------------------------------------
+ * Returns the memory budget of the interpolated HRTF cache
+ *
+ * Input Arguments:
+ *     hBin - binauraliser handle
+ * Returns:
+ *     memory budget in kilobytes; 0: no cache
+ */
+int binauraliser_getInterpCacheBudget(void* const hBin);
+
 /*
  * Function: binauraliser_getProcessingDelay
  * -------------------------------------
- * Returns the processing delay in samples. May be used for delay compensation
- * features
+ * Returns the processing delay in samples, for the current rendering engine
+ * (see 'RENDER_MODES' enum). May be used for delay compensation features
  *
+ * Input Arguments:
+ *     hBin - binauraliser handle
  * Returns:
  *     processing delay in samples
  */
-int binauraliser_getProcessingDelay(void);
+int binauraliser_getProcessingDelay(void* const hBin);
     
 
 #ifdef __cplusplus
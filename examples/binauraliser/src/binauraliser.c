@@ -20,7 +20,9 @@
  * Convolves input audio (up to 64 channels) with interpolated HRTFs in the
  * time-frequency domain. The HRTFs are interpolated by applying amplitude-
  * preserving VBAP gains to the HRTF magnitude responses and inter-aural time
- * differences (ITDs) individually, before being re-combined. The example also
+ * differences (ITDs) individually, before being re-combined. Alternatively,
+ * the input audio may be convolved with interpolated minimum-phase HRIRs in
+ * the time domain, with the ITDs applied as fractional delays. The example also
  * allows the user to specify an external SOFA file for the convolution.
  *
  * Dependencies:
@@ -38,7 +40,7 @@ void binauraliser_create
 {
     binauraliser_data* pData = (binauraliser_data*)malloc1d(sizeof(binauraliser_data));
     *phBin = (void*)pData;
-    int ch;
+    int ch, t;
     
     /* time-frequency transform + buffers */
     pData->hSTFT = NULL;
@@ -57,8 +59,10 @@ void binauraliser_create
     /* hrir data */
     pData->useDefaultHRIRsFLAG=1;
     pData->hrirs = NULL;
+    pData->hHRIRfile = NULL;
     pData->hrir_dirs_deg = NULL;
     pData->sofa_filepath = NULL;
+    pData->hrtf_cache_dir = NULL;
     
     /* vbap (amplitude normalised) */
     pData->hrtf_vbap_gtableIdx = NULL;
@@ -68,6 +72,27 @@ void binauraliser_create
     pData->itds_s = NULL;
     pData->hrtf_fb = NULL;
     pData->hrtf_fb_mag = NULL;
+    pData->hrtf_fb_mag_dirs = NULL;
+    
+    /* interpolated HRTF cache */
+    pData->interpCache_nSlots = 0;
+    pData->interpCache_slotIdx = NULL;
+    pData->interpCache_dirIdx = NULL;
+    pData->interpCache_prev = NULL;
+    pData->interpCache_next = NULL;
+    pData->interpCache_hrtfs = NULL;
+    
+    /* time-domain convolution */
+    pData->hTDfft = NULL;
+    pData->td_nParts = 0;
+    pData->td_hrtfs = NULL;
+    pData->td_nSources = 0;
+    pData->td_X = NULL;
+    pData->td_H = NULL;
+    pData->td_H_prev = NULL;
+    pData->td_xPrev = NULL;
+    for(t=1; t<=FRAME_SIZE; t++)
+        pData->td_interpolator[t-1] = (float)t/(float)FRAME_SIZE;
     
     /* flags/status */
     pData->progressBar0_1 = 0.0f;
@@ -76,14 +101,22 @@ void binauraliser_create
     pData->codecStatus = CODEC_STATUS_NOT_INITIALISED;
     pData->procStatus = PROC_STATUS_NOT_ONGOING;
     pData->reInitHRTFsAndGainTables = 1;
-    for(ch=0; ch<MAX_NUM_INPUTS; ch++)
+    pData->reInitInterpCache = 1;
+    for(ch=0; ch<MAX_NUM_INPUTS; ch++){
         pData->recalc_hrtf_interpFLAG[ch] = 1;
+        pData->hrtf_interp_validFLAG[ch] = 0;
+        pData->hrtf_fadeFLAG[ch] = 0;
+    }
     pData->recalc_M_rotFLAG = 1;
+    for(t=1; t<=TIME_SLOTS; t++)
+        pData->interpolator[t-1] = (float)t/(float)TIME_SLOTS;
     
     /* user parameters */
     binauraliser_loadPreset(SOURCE_CONFIG_PRESET_DEFAULT, pData->src_dirs_deg, &(pData->new_nSources), &(pData->input_nDims)); /*check setStateInformation if you change default preset*/
     pData->nSources = pData->new_nSources;
     pData->interpMode = INTERP_TRI;
+    pData->renderMode = RENDER_MODE_TFT;
+    pData->interpCache_budget_kB = 0;
     pData->yaw = 0.0f;
     pData->pitch = 0.0f;
     pData->roll = 0.0f;
@@ -128,9 +161,23 @@ void binauraliser_destroy
         free(pData->hrtf_vbap_gtableIdx);
         free(pData->hrtf_fb);
         free(pData->hrtf_fb_mag);
+        free(pData->hrtf_fb_mag_dirs);
         free(pData->itds_s);
-        free(pData->hrirs);
+        free(pData->interpCache_slotIdx);
+        free(pData->interpCache_dirIdx);
+        free(pData->interpCache_prev);
+        free(pData->interpCache_next);
+        free(pData->interpCache_hrtfs);
+        if(pData->hTDfft!=NULL)
+            saf_rfft_destroy(&(pData->hTDfft));
+        free(pData->td_X);
+        free(pData->td_H);
+        free(pData->td_H_prev);
+        free(pData->td_xPrev);
+        free(pData->td_hrtfs);
+        binauraliser_releaseHRIRs(pData);
         free(pData->hrir_dirs_deg);
+        free(pData->hrtf_cache_dir);
         free(pData->progressBarText);
          
         free(pData);
@@ -157,6 +204,11 @@ void binauraliser_init
     }
     /* defaults */
     pData->recalc_M_rotFLAG = 1;
+    
+    /* the cached HRTFs depend on the frequency vector; the cache is emptied by
+     * initCodec, as it may currently be in use by the process function */
+    pData->reInitInterpCache = 1;
+    binauraliser_setCodecStatus(hBin, CODEC_STATUS_NOT_INITIALISED);
 }
 
 void binauraliser_initCodec
@@ -165,6 +217,7 @@ void binauraliser_initCodec
 )
 {
     binauraliser_data *pData = (binauraliser_data*)(hBin);
+    int ch;
     
     if (pData->codecStatus != CODEC_STATUS_NOT_INITIALISED)
         return; /* re-init not required, or already happening */
@@ -186,8 +239,27 @@ void binauraliser_initCodec
     if(pData->reInitHRTFsAndGainTables){
         binauraliser_initHRTFsAndGainTables(hBin);
         pData->reInitHRTFsAndGainTables = 0;
+        free1d((void**)&(pData->td_hrtfs)); /* i.e. recomputed for the new HRIR set, when needed */
+        pData->reInitInterpCache = 1;
+        
+        /* HRTFs from the previous HRIR set are not faded from */
+        for(ch=0; ch<MAX_NUM_INPUTS; ch++){
+            pData->hrtf_interp_validFLAG[ch] = 0;
+            pData->hrtf_fadeFLAG[ch] = 0;
+            pData->recalc_hrtf_interpFLAG[ch] = 1;
+        }
     }
     
+    /* empty the interpolated HRTF cache, and resize it to the current budget */
+    if(pData->reInitInterpCache){
+        binauraliser_initInterpCache(hBin);
+        pData->reInitInterpCache = 0;
+    }
+    
+    /* minimum-phase HRIRs and convolution buffers for the time-domain rendering engine */
+    if(pData->renderMode == RENDER_MODE_TD_CONV)
+        binauraliser_initTDconv(hBin);
+    
     /* done! */
     strcpy(pData->progressBarText,"Done!");
     pData->progressBar0_1 = 1.0f;
@@ -206,12 +278,18 @@ void binauraliser_process
 )
 {
     binauraliser_data *pData = (binauraliser_data*)(hBin);
-    int t, ch, ear, i, band, nSources;
-    float src_dirs[MAX_NUM_INPUTS][2], Rxyz[3][3], hypotxy;
+    int t, ch, ear, i, band, nSources, part, nParts, nBins, anyFade;
+    float src_dirs[MAX_NUM_INPUTS][2], Rxyz[3][3], hypotxy, scale, energy;
+    float h_re[HYBRID_BANDS], h_im[HYBRID_BANDS];
+    float* xPrev;
+    float_complex* X, *H, *H_prev, *X_part;
     int enableRotation;
+    RENDER_MODES renderMode;
     
-    /* apply binaural panner */
-    if ((nSamples == FRAME_SIZE) && (pData->hrtf_fb!=NULL) && (pData->codecStatus==CODEC_STATUS_INITIALISED) ){
+    /* apply binaural panner (the time-domain engine is only used once its HRIRs have been computed by initCodec) */
+    renderMode = pData->renderMode;
+    if ((nSamples == FRAME_SIZE) && (pData->hrtf_fb!=NULL) && (pData->codecStatus==CODEC_STATUS_INITIALISED) &&
+        (renderMode!=RENDER_MODE_TD_CONV || pData->td_hrtfs!=NULL) ){
         pData->procStatus = PROC_STATUS_ONGOING;
         
         /* copy user parameters to local variables */
@@ -225,16 +303,6 @@ void binauraliser_process
         for(; i<MAX_NUM_INPUTS; i++)
             memset(pData->inputFrameTD[i], 0, FRAME_SIZE * sizeof(float));
         
-        /* Apply time-frequency transform (TFT) */
-        for(t=0; t< TIME_SLOTS; t++) {
-            for(ch = 0; ch < nSources; ch++)
-                utility_svvcopy(&(pData->inputFrameTD[ch][t*HOP_SIZE]), HOP_SIZE, pData->tempHopFrameTD[ch]);
-            afSTFTforward(pData->hSTFT, (float**)pData->tempHopFrameTD, (complexVector*)pData->STFTInputFrameTF);
-            for(band=0; band<HYBRID_BANDS; band++)
-                for(ch=0; ch < nSources; ch++)
-                    pData->inputframeTF[band][ch][t] = cmplxf(pData->STFTInputFrameTF[ch].re[band], pData->STFTInputFrameTF[ch].im[band]);
-        }
-        
         /* Main processing: */
         /* Rotate source directions */
         if(enableRotation && pData->recalc_M_rotFLAG){
@@ -256,42 +324,172 @@ void binauraliser_process
             }
             pData->recalc_M_rotFLAG = 0;
         }
-         
-        /* interpolate hrtfs and apply to each source */
-        memset(pData->outputframeTF, 0, HYBRID_BANDS*NUM_EARS*TIME_SLOTS * sizeof(float_complex));
-        for (ch = 0; ch < nSources; ch++) {
-            if(pData->recalc_hrtf_interpFLAG[ch]){
-                if(enableRotation)
-                    binauraliser_interpHRTFs(hBin, pData->src_dirs_rot_deg[ch][0], pData->src_dirs_rot_deg[ch][1], pData->hrtf_interp[ch]);
-                else
-                    binauraliser_interpHRTFs(hBin, pData->src_dirs_deg[ch][0], pData->src_dirs_deg[ch][1], pData->hrtf_interp[ch]);
-                pData->recalc_hrtf_interpFLAG[ch] = 0;
+        scale = 1.0f/sqrtf((float)nSources);
+        
+        if(renderMode == RENDER_MODE_TD_CONV){
+            /* Convolve each source with its interpolated minimum-phase HRIRs (uniformly partitioned convolution,
+             * overlap-save), after delaying each ear by the interpolated ITD */
+            nParts = pData->td_nParts;
+            nBins = FRAME_SIZE + 1;
+            anyFade = 0;
+            memset(pData->td_Y, 0, NUM_EARS*nBins*sizeof(float_complex));
+            memset(pData->td_Y_prev, 0, NUM_EARS*nBins*sizeof(float_complex));
+            memset(pData->td_Y_fade, 0, NUM_EARS*nBins*sizeof(float_complex));
+            pData->td_fdlPos = (pData->td_fdlPos + 1) % nParts; /* the oldest input spectra are replaced */
+            for (ch = 0; ch < nSources; ch++) {
+                memmove(pData->td_delayLine[ch], &(pData->td_delayLine[ch][FRAME_SIZE]), ITD_DELAY_LINE_LENGTH*sizeof(float));
+                utility_svvcopy(pData->inputFrameTD[ch], FRAME_SIZE, &(pData->td_delayLine[ch][ITD_DELAY_LINE_LENGTH]));
+                
+                /* skip sources which have been silent for long enough that their delay lines and convolution tails
+                 * are also silent; their HRIRs are also only updated once they are audible again */
+                energy = cblas_sdot(FRAME_SIZE, pData->inputFrameTD[ch], 1, pData->inputFrameTD[ch], 1);
+                pData->td_silentFrames[ch] = energy < SOURCE_ENERGY_GATE ? MIN(pData->td_silentFrames[ch]+1, pData->td_gateFrames+1) : 0;
+                if(pData->td_silentFrames[ch] > pData->td_gateFrames){
+                    if(pData->recalc_hrtf_interpFLAG[ch])
+                        pData->hrtf_interp_validFLAG[ch] = 0; /* i.e. do not fade from the out-of-date HRIRs */
+                    pData->hrtf_fadeFLAG[ch] = 0;
+                    continue;
+                }
+                
+                H = &(pData->td_H[ch*NUM_EARS*nParts*nBins]);
+                H_prev = &(pData->td_H_prev[ch*NUM_EARS*nParts*nBins]);
+                if(pData->recalc_hrtf_interpFLAG[ch]){
+                    /* sources which have moved are crossfaded from their previous HRIRs over this frame, and their
+                     * ITD delays are ramped to the new ones */
+                    if(pData->hrtf_interp_validFLAG[ch]){
+                        memcpy(H_prev, H, NUM_EARS*nParts*nBins*sizeof(float_complex));
+                        pData->hrtf_fadeFLAG[ch] = 1;
+                    }
+                    if(enableRotation)
+                        binauraliser_interpHRIRs(hBin, pData->src_dirs_rot_deg[ch][0], pData->src_dirs_rot_deg[ch][1], H, pData->td_delay_target[ch]);
+                    else
+                        binauraliser_interpHRIRs(hBin, pData->src_dirs_deg[ch][0], pData->src_dirs_deg[ch][1], H, pData->td_delay_target[ch]);
+                    if(!pData->hrtf_interp_validFLAG[ch])
+                        memcpy(pData->td_delay[ch], pData->td_delay_target[ch], NUM_EARS*sizeof(float));
+                    pData->recalc_hrtf_interpFLAG[ch] = 0;
+                    pData->hrtf_interp_validFLAG[ch] = 1;
+                }
+                for (ear = 0; ear < NUM_EARS; ear++) {
+                    /* spectrum of the previous and current (delayed) frames */
+                    xPrev = &(pData->td_xPrev[(ch*NUM_EARS + ear)*FRAME_SIZE]);
+                    utility_svvcopy(xPrev, FRAME_SIZE, pData->td_frameTD);
+                    binauraliser_fractionalDelay(pData->td_delayLine[ch], pData->td_delay[ch][ear], pData->td_delay_target[ch][ear], &(pData->td_frameTD[FRAME_SIZE]));
+                    utility_svvcopy(&(pData->td_frameTD[FRAME_SIZE]), FRAME_SIZE, xPrev);
+                    X = &(pData->td_X[(ch*NUM_EARS + ear)*nParts*nBins]);
+                    saf_rfft_forward(pData->hTDfft, pData->td_frameTD, &X[pData->td_fdlPos*nBins]);
+                    
+                    /* sum of each HRIR partition times the input spectra of the corresponding earlier frame */
+                    for (part = 0; part < nParts; part++) {
+                        X_part = &X[((pData->td_fdlPos - part + nParts) % nParts)*nBins];
+                        if(pData->hrtf_fadeFLAG[ch]){
+                            binauraliser_accumulateSpectra(X_part, &H_prev[(ear*nParts + part)*nBins], nBins, pData->td_Y_prev[ear]);
+                            binauraliser_accumulateSpectra(X_part, &H[(ear*nParts + part)*nBins], nBins, pData->td_Y_fade[ear]);
+                        }
+                        else
+                            binauraliser_accumulateSpectra(X_part, &H[(ear*nParts + part)*nBins], nBins, pData->td_Y[ear]);
+                    }
+                }
+                memcpy(pData->td_delay[ch], pData->td_delay_target[ch], NUM_EARS*sizeof(float));
+                anyFade = anyFade || pData->hrtf_fadeFLAG[ch];
+                pData->hrtf_fadeFLAG[ch] = 0;
             }
-            for (band = 0; band < HYBRID_BANDS; band++)
-                for (ear = 0; ear < NUM_EARS; ear++)
-                    for (t = 0; t < TIME_SLOTS; t++)
-                        pData->outputframeTF[band][ear][t] = ccaddf(pData->outputframeTF[band][ear][t], ccmulf(pData->inputframeTF[band][ch][t], pData->hrtf_interp[ch][band][ear]));
+            
+            /* back to the time-domain (only the last FRAME_SIZE samples are valid), with the faded sources
+             * crossfaded from their previous HRIRs to their new ones */
+            for (ear = 0; ear < NUM_EARS; ear++) {
+                saf_rfft_backward(pData->hTDfft, pData->td_Y[ear], pData->td_frameTD);
+                utility_svvcopy(&(pData->td_frameTD[FRAME_SIZE]), FRAME_SIZE, pData->outframeTD[ear]);
+                if(anyFade){
+                    saf_rfft_backward(pData->hTDfft, pData->td_Y_prev[ear], pData->td_frameTD);
+                    for (i = 0; i < FRAME_SIZE; i++)
+                        pData->outframeTD[ear][i] += (1.0f - pData->td_interpolator[i]) * pData->td_frameTD[FRAME_SIZE + i];
+                    saf_rfft_backward(pData->hTDfft, pData->td_Y_fade[ear], pData->td_frameTD);
+                    for (i = 0; i < FRAME_SIZE; i++)
+                        pData->outframeTD[ear][i] += pData->td_interpolator[i] * pData->td_frameTD[FRAME_SIZE + i];
+                }
+                utility_svsmul(pData->outframeTD[ear], &scale, FRAME_SIZE, NULL);
+            }
+            for (ch = 0; ch < MIN(NUM_EARS, nOutputs); ch++)
+                utility_svvcopy(pData->outframeTD[ch], FRAME_SIZE, outputs[ch]);
+            for (; ch < nOutputs; ch++)
+                memset(outputs[ch], 0, FRAME_SIZE*sizeof(float));
         }
+        else{
+            /* Apply time-frequency transform (TFT) */
+            for(t=0; t< TIME_SLOTS; t++) {
+                for(ch = 0; ch < nSources; ch++)
+                    utility_svvcopy(&(pData->inputFrameTD[ch][t*HOP_SIZE]), HOP_SIZE, pData->tempHopFrameTD[ch]);
+                afSTFTforward(pData->hSTFT, (float**)pData->tempHopFrameTD, (complexVector*)pData->STFTInputFrameTF);
+                for(ch=0; ch < nSources; ch++){
+                    utility_svvcopy(pData->STFTInputFrameTF[ch].re, HYBRID_BANDS, pData->inputframeTF_re[ch][t]);
+                    utility_svvcopy(pData->STFTInputFrameTF[ch].im, HYBRID_BANDS, pData->inputframeTF_im[ch][t]);
+                }
+            }
+        
+            /* interpolate hrtfs and apply to each source (the 1/sqrt(nSources) scaling is applied along with them) */
+            memset(pData->outputframeTF_re, 0, NUM_EARS*TIME_SLOTS*HYBRID_BANDS * sizeof(float));
+            memset(pData->outputframeTF_im, 0, NUM_EARS*TIME_SLOTS*HYBRID_BANDS * sizeof(float));
+            for (ch = 0; ch < nSources; ch++) {
+                /* skip silent sources; their HRTFs are also only updated once they are audible again */
+                energy = cblas_sdot(TIME_SLOTS*HYBRID_BANDS, (float*)pData->inputframeTF_re[ch], 1, (float*)pData->inputframeTF_re[ch], 1) +
+                         cblas_sdot(TIME_SLOTS*HYBRID_BANDS, (float*)pData->inputframeTF_im[ch], 1, (float*)pData->inputframeTF_im[ch], 1);
+                if(energy < SOURCE_ENERGY_GATE){
+                    if(pData->recalc_hrtf_interpFLAG[ch])
+                        pData->hrtf_interp_validFLAG[ch] = 0; /* i.e. do not fade from the out-of-date HRTFs */
+                    pData->hrtf_fadeFLAG[ch] = 0;
+                    continue;
+                }
             
-        /* scale by number of sources */
-        for (band = 0; band < HYBRID_BANDS; band++)
-            for (ear = 0; ear < NUM_EARS; ear++)
-                for (t = 0; t < TIME_SLOTS; t++)
-                    pData->outputframeTF[band][ear][t] = crmulf(pData->outputframeTF[band][ear][t], 1.0f/sqrtf((float)nSources));
+                if(pData->recalc_hrtf_interpFLAG[ch]){
+                    /* sources which have moved are crossfaded from their previous HRTFs over this frame */
+                    if(pData->hrtf_interp_validFLAG[ch]){
+                        memcpy(pData->hrtf_interp_prev_re[ch], pData->hrtf_interp_re[ch], NUM_EARS*HYBRID_BANDS*sizeof(float));
+                        memcpy(pData->hrtf_interp_prev_im[ch], pData->hrtf_interp_im[ch], NUM_EARS*HYBRID_BANDS*sizeof(float));
+                        pData->hrtf_fadeFLAG[ch] = 1;
+                    }
+                    if(enableRotation)
+                        binauraliser_interpHRTFsCached(hBin, pData->src_dirs_rot_deg[ch][0], pData->src_dirs_rot_deg[ch][1], pData->hrtf_interp_re[ch], pData->hrtf_interp_im[ch]);
+                    else
+                        binauraliser_interpHRTFsCached(hBin, pData->src_dirs_deg[ch][0], pData->src_dirs_deg[ch][1], pData->hrtf_interp_re[ch], pData->hrtf_interp_im[ch]);
+                    pData->recalc_hrtf_interpFLAG[ch] = 0;
+                    pData->hrtf_interp_validFLAG[ch] = 1;
+                }
+                if(pData->hrtf_fadeFLAG[ch]){
+                    for (t = 0; t < TIME_SLOTS; t++){
+                        for (ear = 0; ear < NUM_EARS; ear++){
+                            for (band = 0; band < HYBRID_BANDS; band++){
+                                h_re[band] = pData->hrtf_interp_prev_re[ch][ear][band] + pData->interpolator[t] *
+                                             (pData->hrtf_interp_re[ch][ear][band] - pData->hrtf_interp_prev_re[ch][ear][band]);
+                                h_im[band] = pData->hrtf_interp_prev_im[ch][ear][band] + pData->interpolator[t] *
+                                             (pData->hrtf_interp_im[ch][ear][band] - pData->hrtf_interp_prev_im[ch][ear][band]);
+                            }
+                            binauraliser_applyHRTF(pData->inputframeTF_re[ch][t], pData->inputframeTF_im[ch][t], h_re, h_im, scale,
+                                                   pData->outputframeTF_re[ear][t], pData->outputframeTF_im[ear][t]);
+                        }
+                    }
+                    pData->hrtf_fadeFLAG[ch] = 0;
+                }
+                else{
+                    for (t = 0; t < TIME_SLOTS; t++)
+                        for (ear = 0; ear < NUM_EARS; ear++)
+                            binauraliser_applyHRTF(pData->inputframeTF_re[ch][t], pData->inputframeTF_im[ch][t],
+                                                   pData->hrtf_interp_re[ch][ear], pData->hrtf_interp_im[ch][ear], scale,
+                                                   pData->outputframeTF_re[ear][t], pData->outputframeTF_im[ear][t]);
+                }
+            }
        
-        /* inverse-TFT */
-        for (t = 0; t < TIME_SLOTS; t++) {
-            for (band = 0; band < HYBRID_BANDS; band++) {
+            /* inverse-TFT */
+            for (t = 0; t < TIME_SLOTS; t++) {
                 for (ch = 0; ch < NUM_EARS; ch++) {
-                    pData->STFTOutputFrameTF[ch].re[band] = crealf(pData->outputframeTF[band][ch][t]);
-                    pData->STFTOutputFrameTF[ch].im[band] = cimagf(pData->outputframeTF[band][ch][t]);
+                    utility_svvcopy(pData->outputframeTF_re[ch][t], HYBRID_BANDS, pData->STFTOutputFrameTF[ch].re);
+                    utility_svvcopy(pData->outputframeTF_im[ch][t], HYBRID_BANDS, pData->STFTOutputFrameTF[ch].im);
                 }
+                afSTFTinverse(pData->hSTFT, pData->STFTOutputFrameTF, pData->tempHopFrameTD);
+                for (ch = 0; ch < MIN(NUM_EARS, nOutputs); ch++)
+                    utility_svvcopy(pData->tempHopFrameTD[ch], HOP_SIZE, &(outputs[ch][t* HOP_SIZE]));
+                for (; ch < nOutputs; ch++)
+                    memset(&(outputs[ch][t* HOP_SIZE]), 0, HOP_SIZE*sizeof(float));
             }
-            afSTFTinverse(pData->hSTFT, pData->STFTOutputFrameTF, pData->tempHopFrameTD);
-            for (ch = 0; ch < MIN(NUM_EARS, nOutputs); ch++)
-                utility_svvcopy(pData->tempHopFrameTD[ch], HOP_SIZE, &(outputs[ch][t* HOP_SIZE]));
-            for (; ch < nOutputs; ch++)
-                memset(&(outputs[ch][t* HOP_SIZE]), 0, HOP_SIZE*sizeof(float));
         }
     }
     else{
@@ -369,6 +567,17 @@ void binauraliser_setSofaFilePath(void* const hBin, const char* path)
     binauraliser_setCodecStatus(hBin, CODEC_STATUS_NOT_INITIALISED);
 }
 
+void binauraliser_setHRTFcacheDirectory(void* const hBin, const char* path)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    
+    free1d((void**)&(pData->hrtf_cache_dir));
+    if(path!=NULL){
+        pData->hrtf_cache_dir = malloc1d(strlen(path) + 1);
+        strcpy(pData->hrtf_cache_dir, path);
+    }
+}
+
 void binauraliser_setInputConfigPreset(void* const hBin, int newPresetID)
 {
     binauraliser_data *pData = (binauraliser_data*)(hBin);
@@ -452,6 +661,41 @@ void binauraliser_setInterpMode(void* const hBin, int newMode)
     pData->interpMode = newMode;
 }
 
+void binauraliser_setInterpCacheBudget(void* const hBin, int budget_kB)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    
+    budget_kB = MAX(budget_kB, 0);
+    if(pData->interpCache_budget_kB != budget_kB){
+        pData->interpCache_budget_kB = budget_kB;
+        pData->reInitInterpCache = 1;
+        binauraliser_setCodecStatus(hBin, CODEC_STATUS_NOT_INITIALISED);
+    }
+}
+
+void binauraliser_setRenderMode(void* const hBin, int newMode)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    int ch;
+    
+    if(pData->renderMode != (RENDER_MODES)newMode){
+        /* the new engine may not be used until initCodec has initialised it, so the codec is flagged as such (and
+         * the current processing loop, which may still be using the old engine, is waited for) before switching */
+        binauraliser_setCodecStatus(hBin, CODEC_STATUS_NOT_INITIALISED);
+        while(pData->procStatus == PROC_STATUS_ONGOING)
+            SAF_SLEEP(10);
+        pData->renderMode = (RENDER_MODES)newMode;
+        /* the HRTFs of the other engine are out-of-date, and are not faded from */
+        for(ch=0; ch<MAX_NUM_INPUTS; ch++){
+            pData->recalc_hrtf_interpFLAG[ch] = 1;
+            pData->hrtf_interp_validFLAG[ch] = 0;
+            pData->hrtf_fadeFLAG[ch] = 0;
+        }
+        /* (again, in case an initialisation for the old engine was started in the meantime) */
+        binauraliser_setCodecStatus(hBin, CODEC_STATUS_NOT_INITIALISED);
+    }
+}
+
 
 /* Get Functions */
 
@@ -618,8 +862,23 @@ int binauraliser_getInterpMode(void* const hBin)
     return (int)pData->interpMode;
 }
 
-int binauraliser_getProcessingDelay()
+int binauraliser_getRenderMode(void* const hBin)
 {
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    return (int)pData->renderMode;
+}
+
+int binauraliser_getInterpCacheBudget(void* const hBin)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    return pData->interpCache_budget_kB;
+}
+
+int binauraliser_getProcessingDelay(void* const hBin)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    if(pData->renderMode == RENDER_MODE_TD_CONV)
+        return 1; /* the delay line interpolator (see binauraliser_interpHRIRs) */
     return 12*HOP_SIZE;
 }
  
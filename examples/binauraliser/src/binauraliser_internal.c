@@ -20,7 +20,9 @@
  * Convolves input audio (up to 64 channels) with interpolated HRTFs in the
  * time-frequency domain. The HRTFs are interpolated by applying amplitude-
  * preserving VBAP gains to the HRTF magnitude responses and inter-aural time
- * differences (ITDs) individually, before being re-combined. The example also
+ * differences (ITDs) individually, before being re-combined. Alternatively,
+ * the input audio may be convolved with interpolated minimum-phase HRIRs in
+ * the time domain, with the ITDs applied as fractional delays. The example also
  * allows the user to specify an external SOFA file for the convolution.
  *
  * Dependencies:
@@ -42,6 +44,62 @@ void binauraliser_setCodecStatus(void* const hBin, CODEC_STATUS newStatus)
     pData->codecStatus = newStatus;
 }
 
+void binauraliser_applyHRTF
+(
+    const float* x_re,
+    const float* x_im,
+    const float* h_re,
+    const float* h_im,
+    float gain,
+    float* y_re,
+    float* y_im
+)
+{
+    int band;
+    
+    for (band = 0; band < HYBRID_BANDS; band++) {
+        y_re[band] += gain * (h_re[band]*x_re[band] - h_im[band]*x_im[band]);
+        y_im[band] += gain * (h_re[band]*x_im[band] + h_im[band]*x_re[band]);
+    }
+}
+
+/* out = w[0]*rows[0] + w[1]*rows[1] + w[2]*rows[2]; a single pass over
+ * three contiguous rows, which the compiler is free to vectorise */
+static void binauraliser_blendRows3
+(
+    const float* row0,
+    const float* row1,
+    const float* row2,
+    const float w[3],
+    int len,
+    float* out
+)
+{
+    int i;
+    
+    for (i = 0; i < len; i++)
+        out[i] = w[0]*row0[i] + w[1]*row1[i] + w[2]*row2[i];
+}
+
+/* index of the closest pre-computed VBAP direction */
+static int binauraliser_getVBAPtableIndex
+(
+    binauraliser_data* pData,
+    float azimuth_deg,
+    float elevation_deg
+)
+{
+    int aziIndex, elevIndex, N_azi;
+    float aziRes, elevRes;
+    
+    aziRes = (float)pData->hrtf_vbapTableRes[0];
+    elevRes = (float)pData->hrtf_vbapTableRes[1];
+    N_azi = (int)(360.0f / aziRes + 0.5f) + 1;
+    aziIndex = (int)(matlab_fmodf(azimuth_deg + 180.0f, 360.0f) / aziRes + 0.5f);
+    elevIndex = (int)((elevation_deg + 90.0f) / elevRes + 0.5f);
+    return elevIndex * N_azi + aziIndex;
+}
+
 void binauraliser_interpHRTFs
 (
     void* const hBin,
@@ -51,65 +109,264 @@ void binauraliser_interpHRTFs
 )
 {
     binauraliser_data *pData = (binauraliser_data*)(hBin);
-    int i, band;
-    int aziIndex, elevIndex, N_azi, idx3d;
-    float_complex ipd;
-    float aziRes, elevRes, weights[3], itds3[3],  itdInterp;
-    float magnitudes3[HYBRID_BANDS][3][NUM_EARS], magInterp[HYBRID_BANDS][NUM_EARS];
+    int i, band, idx3d;
+    const int* idx3;
+    float ipd, cos_ipd, sin_ipd;
+    float weights[3], itdInterp;
+    float magInterp[HYBRID_BANDS][NUM_EARS];
      
     /* find closest pre-computed VBAP direction */
-    aziRes = (float)pData->hrtf_vbapTableRes[0];
-    elevRes = (float)pData->hrtf_vbapTableRes[1];
-    N_azi = (int)(360.0f / aziRes + 0.5f) + 1;
-    aziIndex = (int)(matlab_fmodf(azimuth_deg + 180.0f, 360.0f) / aziRes + 0.5f);
-    elevIndex = (int)((elevation_deg + 90.0f) / elevRes + 0.5f);
-    idx3d = elevIndex * N_azi + aziIndex;
+    idx3d = binauraliser_getVBAPtableIndex(pData, azimuth_deg, elevation_deg);
     for (i = 0; i < 3; i++)
         weights[i] = pData->hrtf_vbap_gtableComp[idx3d*3 + i];
     
-    /* retrieve the 3 itds and hrtf magnitudes */
-    for (i = 0; i < 3; i++) {
-        itds3[i] = pData->itds_s[pData->hrtf_vbap_gtableIdx[idx3d*3+i]];
-        for (band = 0; band < HYBRID_BANDS; band++) {
-            magnitudes3[band][i][0] = pData->hrtf_fb_mag[band*NUM_EARS*(pData->N_hrir_dirs) + 0*(pData->N_hrir_dirs) + pData->hrtf_vbap_gtableIdx[idx3d*3+i]];
-            magnitudes3[band][i][1] = pData->hrtf_fb_mag[band*NUM_EARS*(pData->N_hrir_dirs) + 1*(pData->N_hrir_dirs) + pData->hrtf_vbap_gtableIdx[idx3d*3+i]];
+    /* interpolate the itd and hrtf magnitudes of the 3 hrirs (whose
+     * magnitudes are each stored contiguously, for all bands and ears) */
+    idx3 = &(pData->hrtf_vbap_gtableIdx[idx3d*3]);
+    itdInterp = weights[0]*pData->itds_s[idx3[0]] + weights[1]*pData->itds_s[idx3[1]] + weights[2]*pData->itds_s[idx3[2]];
+    binauraliser_blendRows3(&(pData->hrtf_fb_mag_dirs[idx3[0]*HYBRID_BANDS*NUM_EARS]),
+                            &(pData->hrtf_fb_mag_dirs[idx3[1]*HYBRID_BANDS*NUM_EARS]),
+                            &(pData->hrtf_fb_mag_dirs[idx3[2]*HYBRID_BANDS*NUM_EARS]),
+                            weights, HYBRID_BANDS*NUM_EARS, (float*)magInterp);
+    
+    /* introduce interaural phase difference (below 1.5kHz only) */
+    for (band = 0; band < HYBRID_BANDS; band++) {
+        if(pData->freqVector[band]<1.5e3f){
+            ipd = 1.3f*(matlab_fmodf(2.0f*PI*(pData->freqVector[band]) * itdInterp + PI, 2.0f*PI) - PI)/2.0f;
+            cos_ipd = cosf(ipd);
+            sin_ipd = sinf(ipd);
+            h_intrp[band][0] = cmplxf(cos_ipd*magInterp[band][0], sin_ipd*magInterp[band][0]);
+            h_intrp[band][1] = cmplxf(cos_ipd*magInterp[band][1], -sin_ipd*magInterp[band][1]);
+        }
+        else{
+            h_intrp[band][0] = cmplxf(magInterp[band][0], 0.0f);
+            h_intrp[band][1] = cmplxf(magInterp[band][1], 0.0f);
         }
     }
+}
+
+/* moves a slot of the interpolated hrtf cache to the front of the least-recently-used list */
+static void binauraliser_touchInterpCacheSlot(binauraliser_data* pData, int slot)
+{
+    if(slot == pData->interpCache_head)
+        return;
     
-    /* interpolate hrtf magnitudes and itd */
-    cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, 1, 1, 3, 1.0f,
-                (float*)weights, 3,
-                (float*)itds3, 1, 0.0f,
-                &itdInterp, 1);
-    for (band = 0; band < HYBRID_BANDS; band++) {
-        cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, 1, 2, 3, 1.0f,
-                    (float*)weights, 3,
-                    (float*)magnitudes3[band], 2, 0.0f,
-                    (float*)magInterp[band], 2);
+    /* unlink */
+    pData->interpCache_next[pData->interpCache_prev[slot]] = pData->interpCache_next[slot];
+    if(slot == pData->interpCache_tail)
+        pData->interpCache_tail = pData->interpCache_prev[slot];
+    else
+        pData->interpCache_prev[pData->interpCache_next[slot]] = pData->interpCache_prev[slot];
+    
+    /* re-link as the most recently used */
+    pData->interpCache_prev[slot] = -1;
+    pData->interpCache_next[slot] = pData->interpCache_head;
+    pData->interpCache_prev[pData->interpCache_head] = slot;
+    pData->interpCache_head = slot;
+}
+
+void binauraliser_interpHRTFsCached
+(
+    void* const hBin,
+    float azimuth_deg,
+    float elevation_deg,
+    float h_re[NUM_EARS][HYBRID_BANDS],
+    float h_im[NUM_EARS][HYBRID_BANDS]
+)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    int band, ear, idx3d, slot;
+    float* entry;
+    float_complex h_intrp[HYBRID_BANDS][NUM_EARS];
+    
+    /* cache hit */
+    slot = -1;
+    if(pData->interpCache_nSlots>0){
+        idx3d = binauraliser_getVBAPtableIndex(pData, azimuth_deg, elevation_deg);
+        slot = pData->interpCache_slotIdx[idx3d];
+        if(slot>=0){
+            binauraliser_touchInterpCacheSlot(pData, slot);
+            entry = &(pData->interpCache_hrtfs[slot*2*NUM_EARS*HYBRID_BANDS]);
+            memcpy(h_re, entry, NUM_EARS*HYBRID_BANDS*sizeof(float));
+            memcpy(h_im, &entry[NUM_EARS*HYBRID_BANDS], NUM_EARS*HYBRID_BANDS*sizeof(float));
+            return;
+        }
+        
+        /* cache miss: the least recently used entry is replaced */
+        slot = pData->interpCache_tail;
+        if(pData->interpCache_dirIdx[slot]>=0)
+            pData->interpCache_slotIdx[pData->interpCache_dirIdx[slot]] = -1;
+        pData->interpCache_dirIdx[slot] = idx3d;
+        pData->interpCache_slotIdx[idx3d] = slot;
+        binauraliser_touchInterpCacheSlot(pData, slot);
     }
     
-    /* introduce interaural phase difference */
-    for (band = 0; band < HYBRID_BANDS; band++) {
-        if(pData->freqVector[band]<1.5e3f)
-            ipd = cmplxf(0.0f, 1.3f*(matlab_fmodf(2.0f*PI*(pData->freqVector[band]) * itdInterp + PI, 2.0f*PI) - PI)/2.0f);
-        else
-            ipd = cmplxf(0.0f, 0.0f);
-        h_intrp[band][0] = crmulf(cexpf(ipd), magInterp[band][0]);
-        h_intrp[band][1] = crmulf(conjf(cexpf(ipd)), magInterp[band][1]);
+    binauraliser_interpHRTFs(hBin, azimuth_deg, elevation_deg, h_intrp);
+    for (band = 0; band < HYBRID_BANDS; band++){
+        for (ear = 0; ear < NUM_EARS; ear++){
+            h_re[ear][band] = crealf(h_intrp[band][ear]);
+            h_im[ear][band] = cimagf(h_intrp[band][ear]);
+        }
+    }
+    if(slot>=0){
+        entry = &(pData->interpCache_hrtfs[slot*2*NUM_EARS*HYBRID_BANDS]);
+        memcpy(entry, h_re, NUM_EARS*HYBRID_BANDS*sizeof(float));
+        memcpy(&entry[NUM_EARS*HYBRID_BANDS], h_im, NUM_EARS*HYBRID_BANDS*sizeof(float));
     }
 }
 
-void binauraliser_initHRTFsAndGainTables(void* const hBin)
+void binauraliser_interpHRIRs
+(
+    void* const hBin,
+    float azimuth_deg,
+    float elevation_deg,
+    float_complex* H_intrp,
+    float delays[NUM_EARS]
+)
 {
     binauraliser_data *pData = (binauraliser_data*)(hBin);
+    int i, ear, idx3d, len;
+    const int* idx3;
+    float weights[3], itdInterp, itd_samples;
+    
+    /* find closest pre-computed VBAP direction */
+    idx3d = binauraliser_getVBAPtableIndex(pData, azimuth_deg, elevation_deg);
+    for (i = 0; i < 3; i++)
+        weights[i] = pData->hrtf_vbap_gtableComp[idx3d*3 + i];
+    
+    /* interpolate the itd and the partitioned minimum-phase hrtfs of the 3
+     * directions (whose partitions are each stored contiguously, for both ears) */
+    idx3 = &(pData->hrtf_vbap_gtableIdx[idx3d*3]);
+    itdInterp = weights[0]*pData->itds_s[idx3[0]] + weights[1]*pData->itds_s[idx3[1]] + weights[2]*pData->itds_s[idx3[2]];
+    len = NUM_EARS*(pData->td_nParts)*(FRAME_SIZE+1);
+    binauraliser_blendRows3((float*)&(pData->td_hrtfs[idx3[0]*len]),
+                            (float*)&(pData->td_hrtfs[idx3[1]*len]),
+                            (float*)&(pData->td_hrtfs[idx3[2]*len]),
+                            weights, 2*len, (float*)H_intrp);
+    
+    /* the lagging ear is delayed by the ITD (positive ITDs: the left ear leads). Both ears are delayed by an
+     * additional sample, as the delay line interpolator also requires the sample after the one read */
+    itd_samples = itdInterp * (float)pData->fs;
+    delays[0] = 1.0f + MAX(-itd_samples, 0.0f);
+    delays[1] = 1.0f + MAX(itd_samples, 0.0f);
+    for (ear = 0; ear < NUM_EARS; ear++)
+        delays[ear] = MIN(delays[ear], (float)(ITD_DELAY_LINE_LENGTH-3));
+}
+
+void binauraliser_fractionalDelay
+(
+    const float* delayLine,
+    float delay0,
+    float delay1,
+    float* out
+)
+{
+    int n, k;
+    float delay, delta, f, h[4];
+    const float* x;
+    
+    delta = (delay1 - delay0)/(float)FRAME_SIZE;
+    for (n = 0; n < FRAME_SIZE; n++) {
+        delay = delay0 + (float)(n+1)*delta;
+        k = (int)delay;
+        f = delay - (float)k;
+        
+        /* 3rd order Lagrange interpolation between the samples delayed by k-1, k, k+1 and k+2 */
+        x = &delayLine[ITD_DELAY_LINE_LENGTH + n - k];
+        h[0] = -f*(f-1.0f)*(f-2.0f)/6.0f;
+        h[1] = (f+1.0f)*(f-1.0f)*(f-2.0f)/2.0f;
+        h[2] = -(f+1.0f)*f*(f-2.0f)/2.0f;
+        h[3] = (f+1.0f)*f*(f-1.0f)/6.0f;
+        out[n] = h[0]*x[1] + h[1]*x[0] + h[2]*x[-1] + h[3]*x[-2];
+    }
+}
+
+void binauraliser_accumulateSpectra
+(
+    const float_complex* X,
+    const float_complex* H,
+    int nBins,
+    float_complex* Y
+)
+{
     int i;
-    float* hrtf_vbap_gtable;
+    const float* x, *h;
+    float* y;
     
-    strcpy(pData->progressBarText,"Loading HRIRs");
-    pData->progressBar0_1 = 0.2f;
+    /* on the interleaved real/imag values, which the compiler is free to vectorise */
+    x = (const float*)X;
+    h = (const float*)H;
+    y = (float*)Y;
+    for (i = 0; i < nBins; i++) {
+        y[2*i]   += x[2*i]*h[2*i]   - x[2*i+1]*h[2*i+1];
+        y[2*i+1] += x[2*i]*h[2*i+1] + x[2*i+1]*h[2*i];
+    }
+}
+
+/* key of the HRTF cache entry for the current HRIR set and settings (0: the
+ * HRIR data could not be read, i.e. no caching) */
+static uint64_t binauraliser_getHRTFcacheKey(binauraliser_data* pData)
+{
+    const char tag[] = "binauraliser_hrtfs";
+    int params[6];
+    uint64_t key;
+
+    key = hrtfCache_hash(SAF_HRTF_CACHE_HASH_SEED, tag, sizeof(tag));
+    if(!pData->useDefaultHRIRsFLAG && pData->sofa_filepath!=NULL)
+        key = hrtfCache_hashFile(key, pData->sofa_filepath);
+    else{
+        key = hrtfCache_hash(key, __default_hrirs, sizeof(__default_hrirs));
+        key = hrtfCache_hash(key, __default_hrir_dirs_deg, sizeof(__default_hrir_dirs_deg));
+        key = hrtfCache_hash(key, &__default_hrir_fs, sizeof(int));
+    }
+    if(key==0)
+        return 0;
+    params[0] = pData->fs;
+    params[1] = HOP_SIZE;
+    params[2] = HYBRID_BANDS;
+    params[3] = pData->hrtf_vbapTableRes[0];
+    params[4] = pData->hrtf_vbapTableRes[1];
+    params[5] = pData->useDefaultHRIRsFLAG;
+    return hrtfCache_hash(key, params, sizeof(params));
+}
+
+void binauraliser_releaseHRIRs(void* const hBin)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
     
-    /* load sofa file or load default hrir data */
-    if(!pData->useDefaultHRIRsFLAG && pData->sofa_filepath!=NULL){
+    if(pData->hHRIRfile!=NULL){
+        hrirFile_close(&(pData->hHRIRfile));
+        pData->hrirs = NULL;
+    }
+    else
+        free1d((void**)&(pData->hrirs));
+}
+
+/* loads the sofa file, or the default hrir data */
+static void binauraliser_loadHRIRs(binauraliser_data* pData)
+{
+    const float* file_hrirs, *file_dirs_deg;
+    int i;
+
+    binauraliser_releaseHRIRs(pData);
+    
+    /* the HRIRs of .safhrir files are used directly from the memory mapped file, unless they are longer than
+     * loadSofaFile would return them (in which case, they are read and truncated by loadSofaFile below) */
+    if(!pData->useDefaultHRIRsFLAG && pData->sofa_filepath!=NULL &&
+       hrirFile_open(&(pData->hHRIRfile), pData->sofa_filepath)){
+        hrirFile_getData(pData->hHRIRfile, &file_hrirs, &file_dirs_deg, &(pData->N_hrir_dirs),
+                         &(pData->hrir_len), &(pData->hrir_fs));
+        if(pData->hrir_len > MAX_SOFA_HRIR_LENGTH)
+            hrirFile_close(&(pData->hHRIRfile));
+    }
+    if(pData->hHRIRfile!=NULL){
+        pData->hrirs = (float*)file_hrirs; /* only ever read */
+        pData->hrir_dirs_deg = realloc1d(pData->hrir_dirs_deg, pData->N_hrir_dirs*2*sizeof(float));
+        memcpy(pData->hrir_dirs_deg, file_dirs_deg, pData->N_hrir_dirs*2*sizeof(float));
+        for(i=0; i<pData->N_hrir_dirs; i++) /* -180..180 */
+            pData->hrir_dirs_deg[2*i+0] = pData->hrir_dirs_deg[2*i+0]>180.0f ? pData->hrir_dirs_deg[2*i+0] - 360.0f : pData->hrir_dirs_deg[2*i+0];
+    }
+    else if(!pData->useDefaultHRIRsFLAG && pData->sofa_filepath!=NULL){
         loadSofaFile(pData->sofa_filepath,
                      &(pData->hrirs),
                      &(pData->hrir_dirs_deg),
@@ -125,6 +382,115 @@ void binauraliser_initHRTFsAndGainTables(void* const hBin)
                      &(pData->hrir_len),
                      &(pData->hrir_fs));
     }
+}
+
+/* copies the hrtf magnitudes into the direction-major table used for the interpolation */
+static void binauraliser_initMagnitudeTable(binauraliser_data* pData)
+{
+    int i, band, ear;
+    
+    pData->hrtf_fb_mag_dirs = realloc1d(pData->hrtf_fb_mag_dirs, HYBRID_BANDS*NUM_EARS*(pData->N_hrir_dirs)*sizeof(float));
+    for(band=0; band<HYBRID_BANDS; band++)
+        for(ear=0; ear<NUM_EARS; ear++)
+            for(i=0; i<pData->N_hrir_dirs; i++)
+                pData->hrtf_fb_mag_dirs[i*HYBRID_BANDS*NUM_EARS + band*NUM_EARS + ear] =
+                    pData->hrtf_fb_mag[band*NUM_EARS*(pData->N_hrir_dirs) + ear*(pData->N_hrir_dirs) + i];
+}
+
+/* order of the blocks in the binauraliser's HRTF cache entries */
+enum {
+    HRTF_CACHE_BLOCK_DIMS = 0,  /* N_hrir_dirs, hrir_len, hrir_fs, N_hrtf_vbap_gtable, nTriangles */
+    HRTF_CACHE_BLOCK_DIRS,
+    HRTF_CACHE_BLOCK_ITDS,
+    HRTF_CACHE_BLOCK_GTABLE_COMP,
+    HRTF_CACHE_BLOCK_GTABLE_IDX,
+    HRTF_CACHE_BLOCK_FB,
+    HRTF_CACHE_BLOCK_FB_MAG,
+    HRTF_CACHE_NUM_BLOCKS
+};
+
+/* copies a cached HRTF set into pData; returns 0 if the entry is not as expected */
+static int binauraliser_loadHRTFcache(binauraliser_data* pData, void* hCache)
+{
+    const void* block[HRTF_CACHE_NUM_BLOCKS];
+    size_t nBytes[HRTF_CACHE_NUM_BLOCKS];
+    const int* dims, *gtableIdx;
+    const float* gtableComp;
+    int i, nDirs, nTable;
+
+    for(i=0; i<HRTF_CACHE_NUM_BLOCKS; i++)
+        block[i] = hrtfCache_getBlock(hCache, i, &nBytes[i]);
+    if(block[HRTF_CACHE_BLOCK_DIMS]==NULL || nBytes[HRTF_CACHE_BLOCK_DIMS]!=5*sizeof(int))
+        return 0;
+    dims = (const int*)block[HRTF_CACHE_BLOCK_DIMS];
+    nDirs = dims[0];
+    nTable = dims[3];
+    if(nDirs<=0 || nTable<=0 ||
+       nBytes[HRTF_CACHE_BLOCK_DIRS] != (size_t)nDirs*2*sizeof(float) ||
+       nBytes[HRTF_CACHE_BLOCK_ITDS] != (size_t)nDirs*sizeof(float) ||
+       nBytes[HRTF_CACHE_BLOCK_GTABLE_COMP] != (size_t)nTable*3*sizeof(float) ||
+       nBytes[HRTF_CACHE_BLOCK_GTABLE_IDX] != (size_t)nTable*3*sizeof(int) ||
+       nBytes[HRTF_CACHE_BLOCK_FB] != (size_t)HYBRID_BANDS*NUM_EARS*nDirs*sizeof(float_complex) ||
+       nBytes[HRTF_CACHE_BLOCK_FB_MAG] != (size_t)HYBRID_BANDS*NUM_EARS*nDirs*sizeof(float))
+        return 0;
+    
+    /* the interpolation table is used to index the HRTFs directly, so each entry must refer to one of them */
+    gtableIdx = (const int*)block[HRTF_CACHE_BLOCK_GTABLE_IDX];
+    gtableComp = (const float*)block[HRTF_CACHE_BLOCK_GTABLE_COMP];
+    for(i=0; i<nTable*3; i++)
+        if(gtableIdx[i]<0 || gtableIdx[i]>=nDirs || !isfinite(gtableComp[i]))
+            return 0;
+
+    pData->N_hrir_dirs = nDirs;
+    pData->hrir_len = dims[1];
+    pData->hrir_fs = dims[2];
+    pData->N_hrtf_vbap_gtable = nTable;
+    pData->nTriangles = dims[4];
+    pData->hrir_dirs_deg = realloc1d(pData->hrir_dirs_deg, nBytes[HRTF_CACHE_BLOCK_DIRS]);
+    memcpy(pData->hrir_dirs_deg, block[HRTF_CACHE_BLOCK_DIRS], nBytes[HRTF_CACHE_BLOCK_DIRS]);
+    pData->itds_s = realloc1d(pData->itds_s, nBytes[HRTF_CACHE_BLOCK_ITDS]);
+    memcpy(pData->itds_s, block[HRTF_CACHE_BLOCK_ITDS], nBytes[HRTF_CACHE_BLOCK_ITDS]);
+    pData->hrtf_vbap_gtableComp = realloc1d(pData->hrtf_vbap_gtableComp, nBytes[HRTF_CACHE_BLOCK_GTABLE_COMP]);
+    memcpy(pData->hrtf_vbap_gtableComp, block[HRTF_CACHE_BLOCK_GTABLE_COMP], nBytes[HRTF_CACHE_BLOCK_GTABLE_COMP]);
+    pData->hrtf_vbap_gtableIdx = realloc1d(pData->hrtf_vbap_gtableIdx, nBytes[HRTF_CACHE_BLOCK_GTABLE_IDX]);
+    memcpy(pData->hrtf_vbap_gtableIdx, block[HRTF_CACHE_BLOCK_GTABLE_IDX], nBytes[HRTF_CACHE_BLOCK_GTABLE_IDX]);
+    pData->hrtf_fb = realloc1d(pData->hrtf_fb, nBytes[HRTF_CACHE_BLOCK_FB]);
+    memcpy(pData->hrtf_fb, block[HRTF_CACHE_BLOCK_FB], nBytes[HRTF_CACHE_BLOCK_FB]);
+    pData->hrtf_fb_mag = realloc1d(pData->hrtf_fb_mag, nBytes[HRTF_CACHE_BLOCK_FB_MAG]);
+    memcpy(pData->hrtf_fb_mag, block[HRTF_CACHE_BLOCK_FB_MAG], nBytes[HRTF_CACHE_BLOCK_FB_MAG]);
+    binauraliser_initMagnitudeTable(pData);
+    return 1;
+}
+
+void binauraliser_initHRTFsAndGainTables(void* const hBin)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    int i;
+    int dims[5];
+    float* hrtf_vbap_gtable;
+    uint64_t cacheKey;
+    void* hCache;
+    const void* blocks[HRTF_CACHE_NUM_BLOCKS];
+    size_t nBytes[HRTF_CACHE_NUM_BLOCKS];
+    
+    strcpy(pData->progressBarText,"Loading HRIRs");
+    pData->progressBar0_1 = 0.2f;
+    pData->hrtf_vbapTableRes[0] = 2;
+    pData->hrtf_vbapTableRes[1] = 5;
+    
+    /* skip all of the processing below, if it has been done before for this HRIR set and these settings */
+    cacheKey = pData->hrtf_cache_dir!=NULL ? binauraliser_getHRTFcacheKey(pData) : 0;
+    if(hrtfCache_open(&hCache, pData->hrtf_cache_dir, cacheKey)){
+        i = binauraliser_loadHRTFcache(pData, hCache);
+        hrtfCache_close(&hCache);
+        if(i){
+            binauraliser_releaseHRIRs(pData); /* not loaded; see binauraliser_initTDconv */
+            return;
+        }
+    }
+    
+    /* load sofa file or load default hrir data */
+    binauraliser_loadHRIRs(pData);
     
     /* estimate the ITDs for each HRIR */
     pData->itds_s = realloc1d(pData->itds_s, pData->N_hrir_dirs*sizeof(float));
@@ -134,14 +500,13 @@ void binauraliser_initHRTFsAndGainTables(void* const hBin)
     strcpy(pData->progressBarText,"Generating interpolation table");
     pData->progressBar0_1 = 0.6f;
     hrtf_vbap_gtable = NULL;
-    pData->hrtf_vbapTableRes[0] = 2;
-    pData->hrtf_vbapTableRes[1] = 5;
     generateVBAPgainTable3D(pData->hrir_dirs_deg, pData->N_hrir_dirs, pData->hrtf_vbapTableRes[0], pData->hrtf_vbapTableRes[1], 1, 0, 0.0f,
                             &hrtf_vbap_gtable, &(pData->N_hrtf_vbap_gtable), &(pData->nTriangles));
     if(hrtf_vbap_gtable==NULL){
         /* if generating vbap gain tabled failed, re-calculate with default HRIR set */
         pData->useDefaultHRIRsFLAG = 1;
         binauraliser_initHRTFsAndGainTables(hBin);
+        return;
     }
     
     /* compress VBAP table (i.e. remove the zero elements) */
@@ -160,25 +525,157 @@ void binauraliser_initHRTFsAndGainTables(void* const hBin)
     pData->hrtf_fb_mag = realloc1d(pData->hrtf_fb_mag, HYBRID_BANDS*NUM_EARS*(pData->N_hrir_dirs)*sizeof(float)); 
     for(i=0; i<HYBRID_BANDS*NUM_EARS* (pData->N_hrir_dirs); i++)
         pData->hrtf_fb_mag[i] = cabsf(pData->hrtf_fb[i]);
+    binauraliser_initMagnitudeTable(pData);
+    
+    /* store for next time */
+    if(cacheKey!=0){
+        dims[0] = pData->N_hrir_dirs;
+        dims[1] = pData->hrir_len;
+        dims[2] = pData->hrir_fs;
+        dims[3] = pData->N_hrtf_vbap_gtable;
+        dims[4] = pData->nTriangles;
+        blocks[HRTF_CACHE_BLOCK_DIMS] = dims;
+        nBytes[HRTF_CACHE_BLOCK_DIMS] = 5*sizeof(int);
+        blocks[HRTF_CACHE_BLOCK_DIRS] = pData->hrir_dirs_deg;
+        nBytes[HRTF_CACHE_BLOCK_DIRS] = pData->N_hrir_dirs*2*sizeof(float);
+        blocks[HRTF_CACHE_BLOCK_ITDS] = pData->itds_s;
+        nBytes[HRTF_CACHE_BLOCK_ITDS] = pData->N_hrir_dirs*sizeof(float);
+        blocks[HRTF_CACHE_BLOCK_GTABLE_COMP] = pData->hrtf_vbap_gtableComp;
+        nBytes[HRTF_CACHE_BLOCK_GTABLE_COMP] = pData->N_hrtf_vbap_gtable*3*sizeof(float);
+        blocks[HRTF_CACHE_BLOCK_GTABLE_IDX] = pData->hrtf_vbap_gtableIdx;
+        nBytes[HRTF_CACHE_BLOCK_GTABLE_IDX] = pData->N_hrtf_vbap_gtable*3*sizeof(int);
+        blocks[HRTF_CACHE_BLOCK_FB] = pData->hrtf_fb;
+        nBytes[HRTF_CACHE_BLOCK_FB] = HYBRID_BANDS*NUM_EARS*(pData->N_hrir_dirs)*sizeof(float_complex);
+        blocks[HRTF_CACHE_BLOCK_FB_MAG] = pData->hrtf_fb_mag;
+        nBytes[HRTF_CACHE_BLOCK_FB_MAG] = HYBRID_BANDS*NUM_EARS*(pData->N_hrir_dirs)*sizeof(float);
+        hrtfCache_save(pData->hrtf_cache_dir, cacheKey, HRTF_CACHE_NUM_BLOCKS, blocks, nBytes);
+    }
     
     /* clean-up */
     free1d((void**)&(hrtf_vbap_gtable));
 }
 
+void binauraliser_initInterpCache
+(
+    void* const hBin
+)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    int i, nSlots;
+    
+    /* number of entries which fit into the budget (more than one per interpolation table direction are never needed) */
+    nSlots = (int)(((size_t)(pData->interpCache_budget_kB)*1024) / INTERP_CACHE_ENTRY_SIZE);
+    nSlots = pData->hrtf_vbap_gtableComp==NULL ? 0 : MIN(nSlots, pData->N_hrtf_vbap_gtable);
+    pData->interpCache_nSlots = nSlots;
+    free1d((void**)&(pData->interpCache_slotIdx));
+    free1d((void**)&(pData->interpCache_dirIdx));
+    free1d((void**)&(pData->interpCache_prev));
+    free1d((void**)&(pData->interpCache_next));
+    free1d((void**)&(pData->interpCache_hrtfs));
+    if(nSlots==0)
+        return;
+    pData->interpCache_slotIdx = malloc1d(pData->N_hrtf_vbap_gtable*sizeof(int));
+    pData->interpCache_dirIdx = malloc1d(nSlots*sizeof(int));
+    pData->interpCache_prev = malloc1d(nSlots*sizeof(int));
+    pData->interpCache_next = malloc1d(nSlots*sizeof(int));
+    pData->interpCache_hrtfs = malloc1d(nSlots*2*NUM_EARS*HYBRID_BANDS*sizeof(float));
+    
+    /* all slots start empty, linked in order of use */
+    for(i=0; i<pData->N_hrtf_vbap_gtable; i++)
+        pData->interpCache_slotIdx[i] = -1;
+    for(i=0; i<nSlots; i++){
+        pData->interpCache_dirIdx[i] = -1;
+        pData->interpCache_prev[i] = i-1;
+        pData->interpCache_next[i] = i<nSlots-1 ? i+1 : -1;
+    }
+    pData->interpCache_head = 0;
+    pData->interpCache_tail = nSlots-1;
+}
+
+void binauraliser_initTDconv
+(
+    void* const hBin
+)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    int i, ch, ear, part, len, nParts, nBins;
+    float* hrirs_mp;
+    
+    /* partitioned spectra of the minimum-phase hrirs, computed once per hrir set */
+    nBins = FRAME_SIZE + 1;
+    if(pData->hTDfft==NULL)
+        saf_rfft_create(&(pData->hTDfft), 2*FRAME_SIZE);
+    if(pData->td_hrtfs==NULL){
+        strcpy(pData->progressBarText,"Computing minimum-phase HRIRs");
+        pData->progressBar0_1 = 0.9f;
+        if(pData->hrirs==NULL) /* i.e. the HRTFs were loaded from the cache */
+            binauraliser_loadHRIRs(pData);
+        hrirs_mp = malloc1d(pData->N_hrir_dirs*NUM_EARS*(pData->hrir_len)*sizeof(float));
+        HRIRs2MinPhaseHRIRs(pData->hrirs, pData->N_hrir_dirs, pData->hrir_len, hrirs_mp);
+        pData->td_nParts = nParts = (pData->hrir_len + FRAME_SIZE - 1) / FRAME_SIZE;
+        pData->td_hrtfs = malloc1d(pData->N_hrir_dirs*NUM_EARS*nParts*nBins*sizeof(float_complex));
+        for(i=0; i<pData->N_hrir_dirs; i++){
+            for(ear=0; ear<NUM_EARS; ear++){
+                for(part=0; part<nParts; part++){
+                    len = MIN(FRAME_SIZE, pData->hrir_len - part*FRAME_SIZE);
+                    memset(pData->td_frameTD, 0, 2*FRAME_SIZE*sizeof(float));
+                    memcpy(pData->td_frameTD, &(hrirs_mp[(i*NUM_EARS + ear)*(pData->hrir_len) + part*FRAME_SIZE]), len*sizeof(float));
+                    saf_rfft_forward(pData->hTDfft, pData->td_frameTD, &(pData->td_hrtfs[((i*NUM_EARS + ear)*nParts + part)*nBins]));
+                }
+            }
+        }
+        free(hrirs_mp);
+        pData->td_nSources = 0; /* the number of partitions may have changed */
+    }
+    
+    /* convolution buffers */
+    nParts = pData->td_nParts;
+    if(pData->td_nSources != pData->nSources){
+        pData->td_nSources = pData->nSources;
+        pData->td_X = realloc1d(pData->td_X, pData->nSources*NUM_EARS*nParts*nBins*sizeof(float_complex));
+        memset(pData->td_X, 0, pData->nSources*NUM_EARS*nParts*nBins*sizeof(float_complex));
+        pData->td_H = realloc1d(pData->td_H, pData->nSources*NUM_EARS*nParts*nBins*sizeof(float_complex));
+        pData->td_H_prev = realloc1d(pData->td_H_prev, pData->nSources*NUM_EARS*nParts*nBins*sizeof(float_complex));
+        pData->td_xPrev = realloc1d(pData->td_xPrev, pData->nSources*NUM_EARS*FRAME_SIZE*sizeof(float));
+        memset(pData->td_xPrev, 0, pData->nSources*NUM_EARS*FRAME_SIZE*sizeof(float));
+        pData->td_fdlPos = 0;
+        memset(pData->td_delayLine, 0, MAX_NUM_INPUTS*(ITD_DELAY_LINE_LENGTH+FRAME_SIZE)*sizeof(float));
+        for(ch=0; ch<MAX_NUM_INPUTS; ch++){
+            pData->td_silentFrames[ch] = 0;
+            pData->hrtf_interp_validFLAG[ch] = 0;
+            pData->hrtf_fadeFLAG[ch] = 0;
+            pData->recalc_hrtf_interpFLAG[ch] = 1;
+        }
+    }
+    
+    /* by then, the delay line and the convolution tail of a silent source are also silent */
+    pData->td_gateFrames = nParts + ITD_DELAY_LINE_LENGTH/FRAME_SIZE + 1;
+}
+
 void binauraliser_initTFT
 (
     void* const hBin
 )
 {
     binauraliser_data *pData = (binauraliser_data*)(hBin);
+    int ch;
  
-    if(pData->hSTFT==NULL)
+    if(pData->hSTFT==NULL){
         afSTFTinit(&(pData->hSTFT), HOP_SIZE, pData->new_nSources, NUM_EARS, 0, 1);
+        pData->nSources = pData->new_nSources;
+    }
     else if(pData->new_nSources!=pData->nSources){
         afSTFTchannelChange(pData->hSTFT, pData->new_nSources, NUM_EARS);
         afSTFTclearBuffers(pData->hSTFT);
         pData->nSources = pData->new_nSources;
     }
+    
+    /* the HRTFs of removed sources are out-of-date if they are added again */
+    for(ch=pData->nSources; ch<MAX_NUM_INPUTS; ch++){
+        pData->hrtf_interp_validFLAG[ch] = 0;
+        pData->hrtf_fadeFLAG[ch] = 0;
+        pData->recalc_hrtf_interpFLAG[ch] = 1;
+    }
 }
 
 void binauraliser_loadPreset(SOURCE_CONFIG_PRESETS preset, float dirs_deg[MAX_NUM_INPUTS][2], int* newNCH, int* nDims)
@@ -328,10 +825,10 @@ void binauraliser_loadPreset(SOURCE_CONFIG_PRESETS preset, float dirs_deg[MAX_NU
             break; 
     }
     
-    /* Fill remaining slots with default coords */
+    /* Fill remaining slots with default coords (repeated, beyond the first 64) */
     for(; ch<MAX_NUM_INPUTS; ch++){
         for(i=0; i<2; i++){
-            dirs_deg[ch][i] = default_LScoords64_rad[ch][i]* (180.0f/M_PI);
+            dirs_deg[ch][i] = default_LScoords64_rad[ch%64][i]* (180.0f/M_PI);
         }
     }
     
@@ -20,7 +20,9 @@
  * Convolves input audio (up to 64 channels) with interpolated HRTFs in the
  * time-frequency domain. The HRTFs are interpolated by applying amplitude-
  * preserving VBAP gains to the HRTF magnitude responses and inter-aural time
- * differences (ITDs) individually, before being re-combined. The example also
+ * differences (ITDs) individually, before being re-combined. Alternatively,
+ * the input audio may be convolved with interpolated minimum-phase HRIRs in
+ * the time domain, with the ITDs applied as fractional delays. The example also
  * allows the user to specify an external SOFA file for the convolution.
  *
  * Dependencies:
@@ -71,8 +73,11 @@ typedef enum _PROC_STATUS{
 #define HOP_SIZE ( 128 )                                    /* STFT hop size = nBands */
 #define HYBRID_BANDS ( HOP_SIZE + 5 )                       /* hybrid mode incurs an additional 5 bands  */
 #define TIME_SLOTS ( FRAME_SIZE / HOP_SIZE )                /* 4/8/16 */
-#define MAX_NUM_INPUTS ( BINAURALISER_MAX_NUM_INPUTS )      /* Maximum permited channels for the VST standard */
+#define MAX_NUM_INPUTS ( BINAURALISER_MAX_NUM_INPUTS )      /* Maximum number of sources */
+#define SOURCE_ENERGY_GATE ( 1e-12f )                       /* sources with less energy than this (summed over all bands and time slots of a frame) are not rendered */
 #define NUM_EARS ( 2 )                                      /* true for most humans */
+#define ITD_DELAY_LINE_LENGTH ( 256 )                       /* ITD delay line history, in samples (>0.7ms at up to 192kHz, plus the interpolator taps) */
+#define INTERP_CACHE_ENTRY_SIZE ( 2*NUM_EARS*HYBRID_BANDS*sizeof(float) + 3*sizeof(int) ) /* bytes per interpolated HRTF cache entry */
 #ifndef DEG2RAD
 # define DEG2RAD(x) (x * PI / 180.0f)
 #endif
@@ -96,8 +101,10 @@ typedef struct _binauraliser
     /* audio buffers */
     float inputFrameTD[MAX_NUM_INPUTS][FRAME_SIZE];
     float outframeTD[NUM_EARS][FRAME_SIZE];
-    float_complex inputframeTF[HYBRID_BANDS][MAX_NUM_INPUTS][TIME_SLOTS];
-    float_complex outputframeTF[HYBRID_BANDS][NUM_EARS][TIME_SLOTS];
+    float inputframeTF_re[MAX_NUM_INPUTS][TIME_SLOTS][HYBRID_BANDS];   /* split-complex, so that all bands of a time slot are contiguous */
+    float inputframeTF_im[MAX_NUM_INPUTS][TIME_SLOTS][HYBRID_BANDS];
+    float outputframeTF_re[NUM_EARS][TIME_SLOTS][HYBRID_BANDS];
+    float outputframeTF_im[NUM_EARS][TIME_SLOTS][HYBRID_BANDS];
     complexVector* STFTInputFrameTF;
     complexVector* STFTOutputFrameTF;
     float** tempHopFrameTD;
@@ -107,7 +114,9 @@ typedef struct _binauraliser
     
     /* sofa file info */
     char* sofa_filepath; 
+    char* hrtf_cache_dir; /* directory of the on-disk HRTF cache; NULL: disabled */
     float* hrirs;
+    void* hHRIRfile; /* .safhrir file that "hrirs" points into (i.e. no copy); NULL: "hrirs" is allocated */
     float* hrir_dirs_deg;
     int N_hrir_dirs;
     int hrir_len;
@@ -124,7 +133,43 @@ typedef struct _binauraliser
     float* itds_s; /* interaural-time differences for each HRIR (in seconds); nBands x 1 */
     float_complex* hrtf_fb; /* hrtf filterbank coefficients; nBands x nCH x N_hrirs */
     float* hrtf_fb_mag; /* magnitudes of the hrtf filterbank coefficients; nBands x nCH x N_hrirs */
-    float_complex hrtf_interp[MAX_NUM_INPUTS][HYBRID_BANDS][NUM_EARS];
+    float* hrtf_fb_mag_dirs; /* the same magnitudes, direction-major (for the interpolation); N_hrirs x nBands x nCH */
+    float hrtf_interp_re[MAX_NUM_INPUTS][NUM_EARS][HYBRID_BANDS];      /* interpolated hrtfs, split-complex (as applied to the sources) */
+    float hrtf_interp_im[MAX_NUM_INPUTS][NUM_EARS][HYBRID_BANDS];
+    float hrtf_interp_prev_re[MAX_NUM_INPUTS][NUM_EARS][HYBRID_BANDS]; /* faded from, over the frame after a source has moved */
+    float hrtf_interp_prev_im[MAX_NUM_INPUTS][NUM_EARS][HYBRID_BANDS];
+    float interpolator[TIME_SLOTS]; /* crossfade weights for the new hrtf_interp, per time slot */
+    
+    /* interpolated hrtf cache (least-recently-used), per direction of the vbap gain table */
+    int interpCache_nSlots; /* number of entries which fit into the budget; 0: no cache */
+    int* interpCache_slotIdx; /* slot holding each vbap table direction (-1: not cached); N_hrtf_vbap_gtable x 1 */
+    int* interpCache_dirIdx; /* vbap table direction held in each slot (-1: empty); nSlots x 1 */
+    int* interpCache_prev; /* next more recently used slot (-1: none); nSlots x 1 */
+    int* interpCache_next; /* next less recently used slot (-1: none); nSlots x 1 */
+    int interpCache_head; /* most recently used slot */
+    int interpCache_tail; /* least recently used slot, replaced next */
+    float* interpCache_hrtfs; /* split-complex interpolated hrtfs; nSlots x 2 x nCH x nBands */
+    
+    /* time-domain convolution (RENDER_MODE_TD_CONV) */
+    void* hTDfft; /* real FFT of length 2*FRAME_SIZE */
+    int td_nParts; /* number of FRAME_SIZE long HRIR partitions */
+    float_complex* td_hrtfs; /* partitioned spectra of the minimum-phase HRIRs (NULL: not yet computed for the current HRIR set); N_hrirs x nCH x td_nParts x (FRAME_SIZE+1) */
+    int td_nSources; /* number of sources the convolution buffers are allocated for */
+    int td_fdlPos; /* partition slot holding the current input spectra */
+    int td_gateFrames; /* number of silent frames after which a source is no longer convolved */
+    float_complex* td_X; /* input spectra of the last td_nParts frames (circular); nSources x nCH x td_nParts x (FRAME_SIZE+1) */
+    float_complex* td_H; /* partitioned spectra of the interpolated minimum-phase HRIRs; nSources x nCH x td_nParts x (FRAME_SIZE+1) */
+    float_complex* td_H_prev; /* faded from, over the frame after a source has moved; nSources x nCH x td_nParts x (FRAME_SIZE+1) */
+    float* td_xPrev; /* previous frame of the delayed source signals (overlap-save); nSources x nCH x FRAME_SIZE */
+    float td_frameTD[2*FRAME_SIZE];
+    float_complex td_Y[NUM_EARS][FRAME_SIZE+1]; /* output spectra of the sources which are not being faded */
+    float_complex td_Y_prev[NUM_EARS][FRAME_SIZE+1]; /* output spectra of the faded sources, with their previous HRIRs */
+    float_complex td_Y_fade[NUM_EARS][FRAME_SIZE+1]; /* output spectra of the faded sources, with their new HRIRs */
+    float td_delayLine[MAX_NUM_INPUTS][ITD_DELAY_LINE_LENGTH+FRAME_SIZE];
+    float td_delay[MAX_NUM_INPUTS][NUM_EARS]; /* current ITD delays, in samples */
+    float td_delay_target[MAX_NUM_INPUTS][NUM_EARS]; /* ITD delays reached by the end of the current frame */
+    int td_silentFrames[MAX_NUM_INPUTS];
+    float td_interpolator[FRAME_SIZE]; /* crossfade weights for the new HRIRs, per sample */
     
     /* flags/status */
     CODEC_STATUS codecStatus;
@@ -132,7 +177,10 @@ typedef struct _binauraliser
     char* progressBarText;
     PROC_STATUS procStatus;
     int recalc_hrtf_interpFLAG[MAX_NUM_INPUTS];
+    int hrtf_interp_validFLAG[MAX_NUM_INPUTS]; /* 1: hrtf_interp holds HRTFs from the current HRIR set */
+    int hrtf_fadeFLAG[MAX_NUM_INPUTS]; /* 1: crossfade from hrtf_interp_prev during this frame */
     int reInitHRTFsAndGainTables;
+    int reInitInterpCache;
     int recalc_M_rotFLAG;
     
     /* misc. */
@@ -148,6 +196,8 @@ typedef struct _binauraliser
     int new_nSources;
     float src_dirs_deg[MAX_NUM_INPUTS][2];
     INTERP_MODES interpMode;
+    RENDER_MODES renderMode;
+    int interpCache_budget_kB;
     int enableRotation;
     float yaw, roll, pitch;                  /* rotation angles in degrees */
     int bFlipYaw, bFlipPitch, bFlipRoll;     /* flag to flip the sign of the individual rotation angles */
@@ -171,6 +221,31 @@ typedef struct _binauraliser
  */
 void binauraliser_setCodecStatus(void* const hBin, CODEC_STATUS newStatus);
 
+/*
+ * Function: binauraliser_applyHRTF
+ * --------------------------------
+ * Applies an HRTF to one time slot of a source signal, and adds the result to
+ * the output, i.e. y += gain * h * x (for all bands). All arguments are in
+ * split-complex form, so that the loop runs over contiguous bands.
+ *
+ * Input Arguments:
+ *     x_re, x_im - source signal (real/imag); HYBRID_BANDS x 1
+ *     h_re, h_im - HRTF for one ear (real/imag); HYBRID_BANDS x 1
+ *     gain       - gain applied along with the HRTF
+ * Output Arguments:
+ *     y_re, y_im - output signal of that ear, accumulated (real/imag);
+ *                  HYBRID_BANDS x 1
+ */
+void binauraliser_applyHRTF(/* Input Arguments */
+                            const float* x_re,
+                            const float* x_im,
+                            const float* h_re,
+                            const float* h_im,
+                            float gain,
+                            /* Output Arguments */
+                            float* y_re,
+                            float* y_im);
+
 /*
  * binauraliser_interpHRTFs
  * ------------------------
@@ -189,6 +264,87 @@ void binauraliser_interpHRTFs(void* const hBin,
                               float elevation_deg,
                               float_complex h_intrp[HYBRID_BANDS][NUM_EARS]);
     
+/*
+ * binauraliser_interpHRTFsCached
+ * ------------------------------
+ * Returns the interpolated HRTFs for a direction (see binauraliser_interpHRTFs)
+ * in split-complex form. They are taken from the interpolated HRTF cache, if
+ * enabled, and are only interpolated (and cached) if not already cached.
+ *
+ * Input Arguments:
+ *     hBin          - binauraliser handle
+ *     azimuth_deg   - source azimuth in DEGREES
+ *     elevation_deg - source elevation in DEGREES
+ * Output Arguments:
+ *     h_re, h_im    - interpolated HRTFs (real/imag)
+ */
+void binauraliser_interpHRTFsCached(void* const hBin,
+                                    float azimuth_deg,
+                                    float elevation_deg,
+                                    float h_re[NUM_EARS][HYBRID_BANDS],
+                                    float h_im[NUM_EARS][HYBRID_BANDS]);
+
+/*
+ * binauraliser_interpHRIRs
+ * ------------------------
+ * The time-domain counterpart of binauraliser_interpHRTFs: interpolates
+ * between 3 minimum-phase HRIRs via AN-VBAP gains. The HRIRs are interpolated
+ * as their FRAME_SIZE long partitions (zero-padded to 2*FRAME_SIZE) in the
+ * frequency domain, which is equivalent to interpolating them in the time
+ * domain. The ITDs are interpolated seperately, and returned as the delays to
+ * apply to each ear.
+ *
+ * Input Arguments:
+ *     hBin          - binauraliser handle
+ *     azimuth_deg   - source azimuth in DEGREES
+ *     elevation_deg - source elevation in DEGREES
+ * Output Arguments:
+ *     H_intrp       - partitioned spectra of the interpolated HRIRs;
+ *                     FLAT: NUM_EARS x td_nParts x (FRAME_SIZE+1)
+ *     delays        - ITD delay for each ear, in samples; NUM_EARS x 1
+ */
+void binauraliser_interpHRIRs(void* const hBin,
+                              float azimuth_deg,
+                              float elevation_deg,
+                              float_complex* H_intrp,
+                              float delays[NUM_EARS]);
+
+/*
+ * binauraliser_fractionalDelay
+ * ----------------------------
+ * Reads one frame from an ITD delay line, with a delay that moves linearly
+ * from 'delay0' to 'delay1' over the frame (3rd order Lagrange interpolation)
+ *
+ * Input Arguments:
+ *     delayLine - delay line, the current frame is in the last FRAME_SIZE
+ *                 samples; (ITD_DELAY_LINE_LENGTH + FRAME_SIZE) x 1
+ *     delay0    - delay at the start of the frame, in samples (>=1)
+ *     delay1    - delay at the end of the frame, in samples (>=1)
+ * Output Arguments:
+ *     out       - delayed frame; FRAME_SIZE x 1
+ */
+void binauraliser_fractionalDelay(const float* delayLine,
+                                  float delay0,
+                                  float delay1,
+                                  float* out);
+
+/*
+ * binauraliser_accumulateSpectra
+ * ------------------------------
+ * Multiplies two spectra and adds the result to a third, i.e. Y += X .* H
+ *
+ * Input Arguments:
+ *     X     - spectrum; nBins x 1
+ *     H     - spectrum; nBins x 1
+ *     nBins - number of bins
+ * Output Arguments:
+ *     Y     - accumulated spectrum; nBins x 1
+ */
+void binauraliser_accumulateSpectra(const float_complex* X,
+                                    const float_complex* H,
+                                    int nBins,
+                                    float_complex* Y);
+
 /*
  * binauraliser_initHRTFsAndGainTables
  * -----------------------------------
@@ -201,6 +357,42 @@ void binauraliser_interpHRTFs(void* const hBin,
  */
 void binauraliser_initHRTFsAndGainTables(void* const hBin);
     
+/*
+ * binauraliser_releaseHRIRs
+ * -------------------------
+ * Frees the HRIRs, or closes the .safhrir file that they are mapped from.
+ *
+ * Input Arguments:
+ *     hBin - binauraliser handle
+ */
+void binauraliser_releaseHRIRs(void* const hBin);
+    
+/*
+ * binauraliser_initInterpCache
+ * ----------------------------
+ * (Re)allocates the interpolated HRTF cache for the current memory budget and
+ * interpolation table, and empties it.
+ * Note: Call this function after 'binauraliser_initHRTFsAndGainTables'
+ *
+ * Input Arguments:
+ *     hBin - binauraliser handle
+ */
+void binauraliser_initInterpCache(void* const hBin);
+
+/*
+ * binauraliser_initTDconv
+ * -----------------------
+ * Initialise the time-domain convolution engine (RENDER_MODE_TD_CONV): the
+ * partitioned spectra of the minimum-phase HRIRs, and the convolution buffers
+ * for the current number of sources.
+ * Note: Call this function after 'binauraliser_initHRTFsAndGainTables' and
+ * 'binauraliser_initTFT'
+ *
+ * Input Arguments:
+ *     hBin - binauraliser handle
+ */
+void binauraliser_initTDconv(void* const hBin);
+
 /*
  * binauraliser_initTFT
  * --------------------
@@ -52,6 +52,7 @@ void dirass_create
     pars->interp_dirs_rad = NULL;
     pars->Y_up = NULL;
     pars->interp_table = NULL;
+    pars->interp_table_idx = NULL;
     pars->w = NULL;
     pars->Cw = NULL;
     pars->Uw = NULL;
@@ -117,6 +118,7 @@ void dirass_destroy
         free(pars->interp_dirs_deg);
         free(pars->Y_up);
         free(pars->interp_table);
+        free(pars->interp_table_idx);
         free(pars->ss);
         free(pars->ssxyz);
         free(pars->Cxyz);
@@ -199,6 +201,7 @@ void dirass_analysis
     int i, j, k, n, ch, sec_nSH, secOrder, nSH, up_nSH;
     int o[MAX_INPUT_SH_ORDER+2];
     float intensity[3];
+    float* ss_i, *ssx, *ssy, *ssz;
     
     /* local parameters */
     int inputOrder, DirAssMode, upscaleOrder;
@@ -290,18 +293,25 @@ void dirass_analysis
                             (const float*)pData->SHframeTD, FRAME_SIZE, 0.0f,
                             pars->ss, FRAME_SIZE);
                 
+                /* beamforming to get the velocity patterns of all sectors at once */
+                cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, 3*(pars->grid_nDirs), FRAME_SIZE, nSH, 1.0f,
+                            pars->Cxyz, nSH,
+                            (const float*)pData->SHframeTD, FRAME_SIZE, 0.0f,
+                            pars->ssxyz, FRAME_SIZE);
+                
                 for(i=0; i<pars->grid_nDirs; i++){
-                    /* beamforming to get velocity patterns */
-                    cblas_sgemm(CblasRowMajor, CblasTrans, CblasNoTrans, 3, FRAME_SIZE, nSH, 1.0f,
-                                &(pars->Cxyz[i*nSH*3]), 3,
-                                (const float*)pData->SHframeTD, FRAME_SIZE, 0.0f,
-                                pars->ssxyz, FRAME_SIZE);
-                    
-                    /* take the sum or mean ss.*ssxyz, to get intensity vector */
+                    /* take the mean of ss.*ssxyz, to get intensity vector (all three components in one pass) */
+                    ss_i = &(pars->ss[i*FRAME_SIZE]);
+                    ssx = &(pars->ssxyz[(i*3+0)*FRAME_SIZE]);
+                    ssy = &(pars->ssxyz[(i*3+1)*FRAME_SIZE]);
+                    ssz = &(pars->ssxyz[(i*3+2)*FRAME_SIZE]);
                     memset(intensity, 0, 3*sizeof(float));
-                    for(k=0; k<3; k++){ 
-                        for(j=0; j<FRAME_SIZE; j++)
-                            intensity[k] += pars->ssxyz[k*FRAME_SIZE + j] * pars->ss[i*FRAME_SIZE+j];
+                    for(j=0; j<FRAME_SIZE; j++){
+                        intensity[0] += ssx[j] * ss_i[j];
+                        intensity[1] += ssy[j] * ss_i[j];
+                        intensity[2] += ssz[j] * ss_i[j];
+                    }
+                    for(k=0; k<3; k++){
                         intensity[k] /= (float)FRAME_SIZE;
                         
                         /* average over time */
@@ -341,10 +351,10 @@ void dirass_analysis
                     }
                     
                     /* interpolate the pmap */
-                    cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, pars->interp_nDirs, 1, pars->grid_nDirs, 1.0f,
-                                pars->interp_table, pars->grid_nDirs,
-                                pData->pmap, 1, 0.0f,
-                                pData->pmap_grid[pData->dispSlotIdx], 1);
+                    for(i=0; i<pars->interp_nDirs; i++)
+                        pData->pmap_grid[pData->dispSlotIdx][i] = pars->interp_table[i*3+0] * pData->pmap[pars->interp_table_idx[i*3+0]] +
+                                                                  pars->interp_table[i*3+1] * pData->pmap[pars->interp_table_idx[i*3+1]] +
+                                                                  pars->interp_table[i*3+2] * pData->pmap[pars->interp_table_idx[i*3+2]];
                     break;
                     
                 case REASS_UPSCALE:
@@ -374,10 +384,10 @@ void dirass_analysis
                     }
                     
                     /* interpolate the pmap */
-                    cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, pars->interp_nDirs, 1, pars->grid_nDirs, 1.0f,
-                                pars->interp_table, pars->grid_nDirs,
-                                pData->pmap, 1, 0.0f,
-                                pData->pmap_grid[pData->dispSlotIdx], 1);
+                    for(i=0; i<pars->interp_nDirs; i++)
+                        pData->pmap_grid[pData->dispSlotIdx][i] = pars->interp_table[i*3+0] * pData->pmap[pars->interp_table_idx[i*3+0]] +
+                                                                  pars->interp_table[i*3+1] * pData->pmap[pars->interp_table_idx[i*3+1]] +
+                                                                  pars->interp_table[i*3+2] * pData->pmap[pars->interp_table_idx[i*3+2]];
                     break;
                  
                 case REASS_NEAREST:
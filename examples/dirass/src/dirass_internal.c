@@ -51,9 +51,9 @@ void dirass_initAna(void* const hDir)
 {
     dirass_data *pData = (dirass_data*)(hDir);
     codecPars* pars = pData->pars;
-    int i, j, N_azi, N_ele, nSH_order, order, nSH_sec, order_sec, order_up, nSH_up, geosphere_ico_freq, td_degree;
+    int i, j, k, N_azi, N_ele, nSH_order, order, nSH_sec, order_sec, order_up, nSH_up, geosphere_ico_freq, td_degree;
     float hfov, vfov, fi, aspectRatio;
-    float *grid_x_axis, *grid_y_axis, *c_n;
+    float *grid_x_axis, *grid_y_axis, *c_n, *interp_table, *Cxyz_n;
     float_complex* A_xyz;
     
     order = pData->new_inputOrder;
@@ -160,9 +160,14 @@ void dirass_initAna(void* const hDir)
             pars->interp_dirs_rad[(i*N_azi + j)*2+1] = grid_y_axis[i] * M_PI/180.0f;
         }
     }
-    free(pars->interp_table);
-    generateVBAPgainTable3D_srcs(pars->interp_dirs_deg, N_azi*N_ele, pars->grid_dirs_deg, pars->grid_nDirs, 0, 0, 0.0f, &(pars->interp_table), &(pars->interp_nDirs), &(pars->interp_nTri));
-    VBAPgainTable2InterpTable(pars->interp_table, pars->interp_nDirs, pars->grid_nDirs);
+    interp_table = NULL;
+    generateVBAPgainTable3D_srcs(pars->interp_dirs_deg, N_azi*N_ele, pars->grid_dirs_deg, pars->grid_nDirs, 0, 0, 0.0f, &interp_table, &(pars->interp_nDirs), &(pars->interp_nTri));
+    
+    /* each display point depends on (at most) 3 grid points, so only their indices and AMPLITUDE-normalised gains are kept */
+    pars->interp_table = realloc1d(pars->interp_table, pars->interp_nDirs*3*sizeof(float));
+    pars->interp_table_idx = realloc1d(pars->interp_table_idx, pars->interp_nDirs*3*sizeof(int));
+    compressVBAPgainTable3D(interp_table, pars->interp_nDirs, pars->grid_nDirs, pars->interp_table, pars->interp_table_idx);
+    free(interp_table);
     
     strcpy(pData->progressBarText,"Computing Sector coefficients");
     pData->progressBar0_1 = 0.85f;
@@ -180,13 +185,19 @@ void dirass_initAna(void* const hDir)
     }
     pars->Cxyz = realloc1d(pars->Cxyz, pars->grid_nDirs * nSH_order * 3 * sizeof(float));
     pars->Cw = realloc1d(pars->Cw, pars->grid_nDirs * nSH_sec * sizeof(float));
+    Cxyz_n = malloc1d(nSH_order*3*sizeof(float));
     for(i=0; i<pars->grid_nDirs; i++){
+        /* velocity patterns are stored transposed, so that all sectors may be beamformed with a single sgemm */
         beamWeightsVelocityPatternsReal(order_sec, c_n, pars->grid_dirs_deg[i*2]*M_PI/180.0f,
-                                        pars->grid_dirs_deg[i*2+1]*M_PI/180.0f, A_xyz, &(pars->Cxyz[i*nSH_order*3]));
+                                        pars->grid_dirs_deg[i*2+1]*M_PI/180.0f, A_xyz, Cxyz_n);
+        for(j=0; j<nSH_order; j++)
+            for(k=0; k<3; k++)
+                pars->Cxyz[(i*3+k)*nSH_order+j] = Cxyz_n[j*3+k];
         rotateAxisCoeffsReal(order_sec, c_n, M_PI/2.0f - pars->grid_dirs_deg[i*2+1]*M_PI/180.0f,
                              pars->grid_dirs_deg[i*2]*M_PI/180.0f, &(pars->Cw[i*nSH_sec]));
     }
     free(A_xyz);
+    free(Cxyz_n);
     free(c_n);
 
     /* get regular beamforming weights */
@@ -221,7 +232,7 @@ void dirass_initAna(void* const hDir)
     pars->Y_up = realloc1d(pars->Y_up, nSH_up* (pars->grid_nDirs)*sizeof(float));
     pars->est_dirs = realloc1d(pars->est_dirs, pars->grid_nDirs * 2 * sizeof(float));
     pars->ss = realloc1d(pars->ss, pars->grid_nDirs * FRAME_SIZE * sizeof(float));
-    pars->ssxyz = realloc1d(pars->ssxyz, 3 * FRAME_SIZE * sizeof(float));
+    pars->ssxyz = realloc1d(pars->ssxyz, pars->grid_nDirs * 3 * FRAME_SIZE * sizeof(float));
     pData->pmap = realloc1d(pData->pmap, pars->grid_nDirs*sizeof(float));
     pars->est_dirs_idx = realloc1d(pars->est_dirs_idx, pars->grid_nDirs*sizeof(int));
     pars->prev_intensity = realloc1d(pars->prev_intensity, pars->grid_nDirs*3*sizeof(float));
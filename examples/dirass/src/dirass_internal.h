@@ -98,17 +98,18 @@ typedef struct _codecPars
     int grid_nDirs;           /* number of grid directions */
     float* interp_dirs_deg;   /* interpolation directions, in degrees; FLAT: interp_nDirs x 2 */
     float* interp_dirs_rad;   /* interpolation directions, in radians; FLAT: interp_nDirs x 2 */
-    float* interp_table;      /* interpolation table (spherical->rectangular grid); FLAT: interp_nDirs x grid_nDirs */
+    float* interp_table;      /* compressed interpolation table (spherical->rectangular grid); FLAT: interp_nDirs x 3 */
+    int* interp_table_idx;    /* grid indices for the compressed interpolation table; FLAT: interp_nDirs x 3 */
     int interp_nDirs;         /* number of interpolation directions */
     int interp_nTri;          /* number of triangles in the spherical scanning grid mesh */
     float* ss;                /* beamformer sector signals; FLAT: grid_nDirs x FRAME_SIZE */
-    float* ssxyz;             /* beamformer velocity signals; FLAT: 3 x FRAME_SIZE */
+    float* ssxyz;             /* beamformer velocity signals; FLAT: (grid_nDirs x 3) x FRAME_SIZE */
     int* est_dirs_idx;        /* DoA indices, into the interpolation directions; grid_nDirs x 1 */
     float* prev_intensity;    /* previous intensity vectors (for averaging); FLAT: grid_nDirs x 3 */
     float* prev_energy;       /* previous energy (for averaging); FLAT: grid_nDirs x 1 */
     
     /* sector beamforming and upscaling */
-    float* Cxyz;              /* beamforming weights for velocity patterns; FLAT: nDirs x (order+1)^2 x 3 */
+    float* Cxyz;              /* beamforming weights for velocity patterns; FLAT: (nDirs x 3) x (order+1)^2 */
     float* Cw;                /* beamforming weights; FLAT: nDirs x (order)^2 */
     float* Uw;                /* beamforming weights; FLAT: nDirs x (upscaleOrder+1)^2 */
     float* Y_up;              /* real SH weights for upscaling; FLAT: (upscaleOrder+1)^2 x grid_nDirs */
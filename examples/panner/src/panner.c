@@ -68,6 +68,10 @@ void panner_create
     for(ch=0; ch<MAX_NUM_INPUTS; ch++)
         pData->recalc_gainsFLAG[ch] = 1;
     pData->vbap_gtable = NULL;
+    pData->vbap_gtableIdx = NULL;
+    pData->hVBAPtable = NULL;
+    pData->G_src = NULL;
+    pData->G_srcIdx = NULL;
     pData->recalc_M_rotFLAG = 1;
     pData->reInitGainTables = 1;
     
@@ -117,6 +121,10 @@ void panner_destroy
         free(pData->STFTOutputFrameTF);
         free(pData->tempHopFrameTD);
         free1d((void**)&(pData->vbap_gtable));
+        free1d((void**)&(pData->vbap_gtableIdx));
+        vbapGainTable3D_destroy(&(pData->hVBAPtable));
+        free1d((void**)&(pData->G_src));
+        free1d((void**)&(pData->G_srcIdx));
         free(pData->progressBarText);
         
         free(pData);
@@ -143,7 +151,7 @@ void panner_init
     }
     
     /* calculate pValue per frequency */
-    getPvalues(pData->DTT, pData->freqVector, HYBRID_BANDS, pData->pValue);
+    panner_initPvalues(hPan);
 
     /* reinitialise if needed */
     pData->recalc_M_rotFLAG = 1;
@@ -196,11 +204,10 @@ void panner_process
 )
 {
     panner_data *pData = (panner_data*)(hPan);
-    int t, ch, ls, i, band, nSources, nLoudspeakers, N_azi, aziIndex, elevIndex, idx3d, idx2D;
-    float aziRes, elevRes, pv_f, gains3D_sum_pvf, gains2D_sum_pvf, Rxyz[3][3], hypotxy;
-    float src_dirs[MAX_NUM_INPUTS][2], pValue[HYBRID_BANDS], gains3D[MAX_NUM_OUTPUTS], gains2D[MAX_NUM_OUTPUTS];
-	const float_complex calpha = cmplxf(1.0f, 0.0f), cbeta = cmplxf(0.0f, 0.0f);
-	float_complex outputTemp[MAX_NUM_OUTPUTS][TIME_SLOTS];
+    int t, ch, ls, i, k, band, grp, nSources, nLoudspeakers, nnz, N_azi, aziIndex, elevIndex, idx3d, idx2D;
+    float aziRes, elevRes, pv_f, g, scale, gains_sum_pvf, Rxyz[3][3], hypotxy;
+    float src_dirs[MAX_NUM_INPUTS][2], pValue[HYBRID_BANDS], log_gains[MAX_NUM_OUTPUTS];
+    float* gains, *inTF, *outTF;
 
     /* apply panner */
     if ((nSamples == FRAME_SIZE) && (pData->vbap_gtable != NULL) && (pData->codecStatus == CODEC_STATUS_INITIALISED) ) {
@@ -211,6 +218,7 @@ void panner_process
         memcpy(pValue, pData->pValue, HYBRID_BANDS*sizeof(float));
         nSources = pData->nSources;
         nLoudspeakers = pData->nLoudpkrs;
+        nnz = pData->vbap_gtable_nnz;
         
         /* Load time-domain data */
         for(i=0; i < MIN(nSources,nInputs); i++)
@@ -228,7 +236,6 @@ void panner_process
                     pData->inputframeTF[band][ch][t] = cmplxf(pData->STFTInputFrameTF[ch].re[band], pData->STFTInputFrameTF[ch].im[band]);
         }
         memset(pData->outputframeTF, 0, HYBRID_BANDS*MAX_NUM_OUTPUTS*TIME_SLOTS * sizeof(float_complex));
-		memset(outputTemp, 0, MAX_NUM_OUTPUTS*TIME_SLOTS * sizeof(float_complex));
         
         /* Main processing: */
         /* Rotate source directions */
@@ -253,88 +260,66 @@ void panner_process
         }
             
         /* Apply VBAP Panning */
-        if(pData->output_nDims == 3){/* 3-D case */
-            aziRes = (float)pData->vbapTableRes[0];
-            elevRes = (float)pData->vbapTableRes[1];
-            N_azi = (int)(360.0f / aziRes + 0.5f) + 1;
-            for (ch = 0; ch < nSources; ch++) {
-                /* recalculate frequency dependent panning gains */
-                if(pData->recalc_gainsFLAG[ch]){
-                    //aziIndex = (int)(matlab_fmodf(pData->src_dirs_deg[ch][0] + 180.0f, 360.0f) / aziRes + 0.5f);
-                    //elevIndex = (int)((pData->src_dirs_deg[ch][1] + 90.0f) / elevRes + 0.5f);
+        aziRes = (float)pData->vbapTableRes[0];
+        elevRes = (float)pData->vbapTableRes[1];
+        N_azi = (int)(360.0f / aziRes + 0.5f) + 1;
+        for (ch = 0; ch < nSources; ch++) {
+            /* recalculate frequency dependent panning gains */
+            if(pData->recalc_gainsFLAG[ch]){
+                if(pData->output_nDims == 3){/* 3-D case */
                     aziIndex = (int)(matlab_fmodf(pData->src_dirs_rot_deg[ch][0] + 180.0f, 360.0f) / aziRes + 0.5f);
                     elevIndex = (int)((pData->src_dirs_rot_deg[ch][1] + 90.0f) / elevRes + 0.5f);
                     idx3d = elevIndex * N_azi + aziIndex;
-                    for (ls = 0; ls < nLoudspeakers; ls++)
-                        gains3D[ls] =  pData->vbap_gtable[idx3d*nLoudspeakers+ls];
-                    for (band = 0; band < HYBRID_BANDS; band++){
-                        /* apply pValue per frequency */
-                        pv_f = pData->pValue[band];
-                        if(pv_f != 2.0f){
-                            gains3D_sum_pvf = 0.0f;
-                            for (ls = 0; ls < nLoudspeakers; ls++)
-                                gains3D_sum_pvf += powf(MAX(gains3D[ls], 0.0f), pv_f);
-                            gains3D_sum_pvf = powf(gains3D_sum_pvf, 1.0f/(pv_f+2.23e-9f));
-                            for (ls = 0; ls < nLoudspeakers; ls++)
-                                pData->G_src[band][ch][ls] = cmplxf(gains3D[ls] / (gains3D_sum_pvf+2.23e-9f), 0.0f);
-                        }
-                        else
-                            for (ls = 0; ls < nLoudspeakers; ls++)
-                                pData->G_src[band][ch][ls] = cmplxf(gains3D[ls], 0.0f);
-                    }
-                    pData->recalc_gainsFLAG[ch] = 0;
-                } 
-            }
-			/* apply panning gains */
-			for (band = 0; band < HYBRID_BANDS; band++) {
-				cblas_cgemm(CblasRowMajor, CblasTrans, CblasNoTrans, nLoudspeakers, TIME_SLOTS, nSources, &calpha,
-					pData->G_src[band], MAX_NUM_OUTPUTS,
-					pData->inputframeTF[band], TIME_SLOTS, &cbeta,
-					outputTemp, TIME_SLOTS);
-				for (i = 0; i < nLoudspeakers; i++)
-					for (t = 0; t < TIME_SLOTS; t++)
-						pData->outputframeTF[band][i][t] = ccaddf(pData->outputframeTF[band][i][t], outputTemp[i][t]);
-			}
-        }
-        else{/* 2-D case */
-            aziRes = (float)pData->vbapTableRes[0];
-            for (ch = 0; ch < nSources; ch++) {
-                /* recalculate frequency dependent panning gains */
-                if(pData->recalc_gainsFLAG[ch]){
-                    //idx2D = (int)((matlab_fmodf(pData->src_dirs_deg[ch][0]+180.0f,360.0f)/aziRes)+0.5f);
+                    gains = &(pData->vbap_gtable[idx3d*nnz]);
+                    memcpy(&(pData->G_srcIdx[ch*nnz]), &(pData->vbap_gtableIdx[idx3d*nnz]), nnz*sizeof(int));
+                }
+                else{/* 2-D case */
                     idx2D = (int)((matlab_fmodf(pData->src_dirs_rot_deg[ch][0]+180.0f,360.0f)/aziRes)+0.5f);
-                    for (ls = 0; ls < nLoudspeakers; ls++)
-                        gains2D[ls] = pData->vbap_gtable[idx2D*nLoudspeakers+ls];
-                    for (band = 0; band < HYBRID_BANDS; band++){
-                        /* apply pValue per frequency */
-                        pv_f = pData->pValue[band];
-                        if(pv_f != 2.0f){
-                            gains2D_sum_pvf = 0.0f;
-                            for (ls = 0; ls < nLoudspeakers; ls++)
-                                gains2D_sum_pvf += powf(MAX(gains2D[ls], 0.0f), pv_f);
-                            gains2D_sum_pvf = powf(gains2D_sum_pvf, 1.0f/(pv_f+2.23e-9f));
-                            for (ls = 0; ls < nLoudspeakers; ls++)
-                                pData->G_src[band][ch][ls] = cmplxf(gains2D[ls] / (gains2D_sum_pvf+2.23e-9f), 0.0f);
-                        }
-                        else
-                            for (ls = 0; ls < nLoudspeakers; ls++)
-                                pData->G_src[band][ch][ls] = cmplxf(gains2D[ls], 0.0f);
+                    gains = &(pData->vbap_gtable[idx2D*nnz]);
+                    memcpy(&(pData->G_srcIdx[ch*nnz]), &(pData->vbap_gtableIdx[idx2D*nnz]), nnz*sizeof(int));
+                }
+                /* apply pValue per group of bands (only the non-zero gains are stored). The powers are evaluated as
+                 * exp(pv*log(gain)), with the logarithms computed only once for all groups */
+                for (k = 0; k < nnz; k++)
+                    log_gains[k] = logf(MAX(gains[k], 0.0f)); /* -inf for unused entries, which then contribute 0 */
+                for (grp = 0; grp < pData->nPvGroups; grp++){
+                    pv_f = pData->pValue[pData->pvGroupStart[grp]];
+                    if(pv_f != 2.0f){
+                        gains_sum_pvf = 0.0f;
+                        for (k = 0; k < nnz; k++)
+                            gains_sum_pvf += expf(pv_f*log_gains[k]);
+                        gains_sum_pvf = expf(logf(gains_sum_pvf)/(pv_f+2.23e-9f));
+                        for (k = 0; k < nnz; k++)
+                            pData->G_src[(grp*MAX_NUM_INPUTS + ch)*nnz + k] = gains[k] / (gains_sum_pvf+2.23e-9f);
                     }
-                    pData->recalc_gainsFLAG[ch] = 0;
+                    else
+                        memcpy(&(pData->G_src[(grp*MAX_NUM_INPUTS + ch)*nnz]), gains, nnz*sizeof(float));
                 }
-                /* apply panning gains */
-                for (band = 0; band < HYBRID_BANDS; band++){
-                    for (ls = 0; ls < nLoudspeakers; ls++)
-                        for (t = 0; t < TIME_SLOTS; t++)
-                            pData->outputframeTF[band][ls][t] = ccaddf(pData->outputframeTF[band][ls][t], ccmulf(pData->inputframeTF[band][ch][t], pData->G_src[band][ch][ls]));
+                pData->recalc_gainsFLAG[ch] = 0;
+            }
+            
+            /* apply panning gains (the gains are real, so the complex frames are treated as interleaved real
+             * vectors of length 2*TIME_SLOTS, and the products are accumulated directly into the output). These
+             * vectors are short, so a plain loop is used rather than a BLAS call per band */
+            for (grp = 0; grp < pData->nPvGroups; grp++){
+                for (k = 0; k < nnz; k++){
+                    g = pData->G_src[(grp*MAX_NUM_INPUTS + ch)*nnz + k];
+                    if(g == 0.0f)
+                        continue; /* unused entry */
+                    ls = pData->G_srcIdx[ch*nnz + k];
+                    for (band = pData->pvGroupStart[grp]; band < pData->pvGroupStart[grp+1]; band++){
+                        inTF = (float*)pData->inputframeTF[band][ch];
+                        outTF = (float*)pData->outputframeTF[band][ls];
+                        for (t = 0; t < 2*TIME_SLOTS; t++)
+                            outTF[t] += g*inTF[t];
+                    }
                 }
             }
         }
         /* scale by sqrt(number of sources) */
+        scale = 1.0f/sqrtf((float)nSources);
         for (band = 0; band < HYBRID_BANDS; band++)
-            for (ls = 0; ls < nLoudspeakers; ls++)
-                for (t = 0; t < TIME_SLOTS; t++)
-                    pData->outputframeTF[band][ls][t] = crmulf(pData->outputframeTF[band][ls][t], 1.0f/sqrtf((float)nSources));
+            cblas_sscal(2*nLoudspeakers*TIME_SLOTS, scale, (float*)pData->outputframeTF[band], 1);
          
         /* inverse-TFT */
         for(t = 0; t < TIME_SLOTS; t++) {
@@ -491,7 +476,7 @@ void panner_setDTT(void* const hPan, float newValue)
     int ch;
     if(pData->DTT != newValue){
         pData->DTT = newValue;
-        getPvalues(pData->DTT, pData->freqVector, HYBRID_BANDS, pData->pValue);
+        panner_initPvalues(hPan);
         for(ch=0; ch<pData->new_nSources; ch++)
             pData->recalc_gainsFLAG[ch] = 1;
         pData->recalc_M_rotFLAG = 1;
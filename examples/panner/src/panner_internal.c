@@ -48,11 +48,32 @@ void panner_setCodecStatus(void* const hPan, CODEC_STATUS newStatus)
     pData->codecStatus = newStatus;
 }
 
+/* the 3-D gain table is only updated around the moved loudspeaker, if just one has moved since the last call */
+static void panner_initGainTable3D(void* const hPan)
+{
+    panner_data *pData = (panner_data*)(hPan);
+    
+    if(pData->hVBAPtable==NULL){
+        free1d((void**)&(pData->vbap_gtable));
+        free1d((void**)&(pData->vbap_gtableIdx));
+        vbapGainTable3D_create(&(pData->hVBAPtable), (float*)pData->loudpkrs_dirs_deg, pData->nLoudpkrs, pData->vbapTableRes[0],
+                               pData->vbapTableRes[1], 1, 1, pData->spread_deg, &(pData->vbap_gtable), &(pData->vbap_gtableIdx),
+                               &(pData->vbap_gtable_nnz), &(pData->N_vbap_gtable), &(pData->nTriangles));
+    }
+    else
+        vbapGainTable3D_update(pData->hVBAPtable, (float*)pData->loudpkrs_dirs_deg, pData->nLoudpkrs, pData->spread_deg,
+                               &(pData->vbap_gtable), &(pData->vbap_gtableIdx), &(pData->vbap_gtable_nnz),
+                               &(pData->N_vbap_gtable), &(pData->nTriangles));
+    if(pData->vbap_gtable==NULL)
+        vbapGainTable3D_destroy(&(pData->hVBAPtable));
+}
+
 void panner_initGainTables(void* const hPan)
 {
     panner_data *pData = (panner_data*)(hPan);
 #ifndef FORCE_3D_LAYOUT
     int i;
+    float* vbap_gtable;
     float sum_elev;
     
     /* determine dimensionality */
@@ -66,27 +87,59 @@ void panner_initGainTables(void* const hPan)
 #endif
     
     /* generate VBAP gain table */
-    free1d((void**)&(pData->vbap_gtable));
     pData->vbapTableRes[0] = 2;
     pData->vbapTableRes[1] = 5;
 #ifdef FORCE_3D_LAYOUT
     pData->output_nDims = 3;
-    generateVBAPgainTable3D((float*)pData->loudpkrs_dirs_deg, pData->nLoudpkrs, pData->vbapTableRes[0], pData->vbapTableRes[1], 1, 1, pData->spread_deg,
-                            &(pData->vbap_gtable), &(pData->N_vbap_gtable), &(pData->nTriangles));
+    panner_initGainTable3D(hPan);
 #else
-    if(pData->output_nDims==2)
+    if(pData->output_nDims==2){
+        vbapGainTable3D_destroy(&(pData->hVBAPtable));
+        free1d((void**)&(pData->vbap_gtable));
+        free1d((void**)&(pData->vbap_gtableIdx));
+        vbap_gtable = NULL;
         generateVBAPgainTable2D((float*)pData->loudpkrs_dirs_deg, pData->nLoudpkrs, pData->vbapTableRes[0],
-                                &(pData->vbap_gtable), &(pData->N_vbap_gtable), &(pData->nTriangles));
+                                &vbap_gtable, &(pData->N_vbap_gtable), &(pData->nTriangles));
+        
+        /* only the non-zero gains (and their loudspeaker indices) are kept */
+        if(vbap_gtable!=NULL){
+            compressVBAPgainTable(vbap_gtable, pData->N_vbap_gtable, pData->nLoudpkrs, &(pData->vbap_gtable_nnz),
+                                  &(pData->vbap_gtable), &(pData->vbap_gtableIdx));
+            free(vbap_gtable);
+        }
+    }
     else{
-        generateVBAPgainTable3D((float*)pData->loudpkrs_dirs_deg, pData->nLoudpkrs, pData->vbapTableRes[0], pData->vbapTableRes[1], 1, 1, pData->spread_deg,
-                                &(pData->vbap_gtable), &(pData->N_vbap_gtable), &(pData->nTriangles));
+        panner_initGainTable3D(hPan);
         if(pData->vbap_gtable==NULL){
             /* if generating vbap gain tabled failed, re-calculate with 2D VBAP */
             pData->output_nDims = 2;
             panner_initGainTables(hPan);
+            return;
         }
     }
 #endif
+    
+    /* the panning gains of each source are only stored for the non-zero entries of the gain table too (there may
+     * be up to HYBRID_BANDS pValue groups, so that these need not be re-allocated when the DTT changes) */
+    if(pData->vbap_gtable!=NULL){
+        pData->G_src = realloc1d(pData->G_src, HYBRID_BANDS*MAX_NUM_INPUTS*(pData->vbap_gtable_nnz)*sizeof(float));
+        pData->G_srcIdx = realloc1d(pData->G_srcIdx, MAX_NUM_INPUTS*(pData->vbap_gtable_nnz)*sizeof(int));
+    }
+}
+
+void panner_initPvalues(void* const hPan)
+{
+    panner_data *pData = (panner_data*)(hPan);
+    int band;
+    
+    getPvalues(pData->DTT, pData->freqVector, HYBRID_BANDS, pData->pValue);
+    
+    /* the pValue only varies at low frequencies (and is 2 everywhere when DTT=0) */
+    pData->nPvGroups = 0;
+    for(band=0; band<HYBRID_BANDS; band++)
+        if(band==0 || pData->pValue[band]!=pData->pValue[band-1])
+            pData->pvGroupStart[pData->nPvGroups++] = band;
+    pData->pvGroupStart[pData->nPvGroups] = HYBRID_BANDS;
 }
 
 void panner_initTFT
@@ -115,9 +115,13 @@ typedef struct _panner
     
     /* Internal */
     int vbapTableRes[2];
-    float* vbap_gtable; /* N_hrtf_vbap_gtable x nLoudpkrs */
+    float* vbap_gtable; /* compressed VBAP gain table; FLAT: N_vbap_gtable x vbap_gtable_nnz */
+    int* vbap_gtableIdx; /* loudspeaker indices of the compressed VBAP gain table; FLAT: N_vbap_gtable x vbap_gtable_nnz */
+    int vbap_gtable_nnz; /* number of (non-zero) gains per point of the compressed VBAP gain table */
     int N_vbap_gtable;
-    float_complex G_src[HYBRID_BANDS][MAX_NUM_INPUTS][MAX_NUM_OUTPUTS];
+    void* hVBAPtable; /* keeps the 3-D triangulation, so that the gain table may be updated incrementally */
+    float* G_src; /* panning gains per pValue group (only the first nPvGroups are used); FLAT: HYBRID_BANDS x MAX_NUM_INPUTS x vbap_gtable_nnz */
+    int* G_srcIdx; /* loudspeaker indices of the panning gains; FLAT: MAX_NUM_INPUTS x vbap_gtable_nnz */
     
     /* flags */
     CODEC_STATUS codecStatus;
@@ -137,6 +141,8 @@ typedef struct _panner
     
     /* pValue */
     float pValue[HYBRID_BANDS];
+    int nPvGroups; /* number of groups of adjacent bands which share the same pValue */
+    int pvGroupStart[HYBRID_BANDS+1]; /* first band of each group (and the number of bands, after the last group) */
     
     /* user parameters */
     int nSources, new_nSources;
@@ -176,6 +182,18 @@ void panner_setCodecStatus(void* const hPan, CODEC_STATUS newStatus);
  */
 void panner_initGainTables(void* const hPan);
     
+/*
+ * panner_initPvalues
+ * ------------------
+ * Computes the pValue of each band (for the current DTT), and groups the
+ * adjacent bands which share the same pValue; the panning gains are then
+ * computed and stored only once per group.
+ *
+ * Input Arguments:
+ *     hPan - panner handle
+ */
+void panner_initPvalues(void* const hPan);
+    
 /*
  * panner_initTFT
  * --------------
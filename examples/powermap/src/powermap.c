@@ -54,6 +54,7 @@ void powermap_create
         pars->Y_grid_cmplx[n] = NULL;
     }
     pars->interp_table = NULL;
+    pars->interp_table_idx = NULL;
     
     /* internal */
     pData->progressBar0_1 = 0.0f;
@@ -122,6 +123,7 @@ void powermap_destroy
             free1d((void**)&(pars->Y_grid_cmplx[i]));
         }
         free1d((void**)&(pars->interp_table));
+        free1d((void**)&(pars->interp_table_idx));
         free(pData->pars);
         free(pData->progressBarText);
         free(pData);
@@ -388,10 +390,10 @@ void powermap_analysis
             utility_svvcopy(pData->pmap, pars->grid_nDirs, pData->prev_pmap);
 
             /* interpolate powermap */
-            cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, pars->interp_nDirs, 1, pars->grid_nDirs, 1.0f,
-                        pars->interp_table, pars->grid_nDirs,
-                        pData->pmap, 1, 0.0f,
-                        pData->pmap_grid[pData->dispSlotIdx], 1);
+            for(i=0; i<pars->interp_nDirs; i++)
+                pData->pmap_grid[pData->dispSlotIdx][i] = pars->interp_table[i*3+0] * pData->pmap[pars->interp_table_idx[i*3+0]] +
+                                                          pars->interp_table[i*3+1] * pData->pmap[pars->interp_table_idx[i*3+1]] +
+                                                          pars->interp_table[i*3+2] * pData->pmap[pars->interp_table_idx[i*3+2]];
 
             /* ascertain minimum and maximum values for powermap colour scaling */
             int ind;
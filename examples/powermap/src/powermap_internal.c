@@ -46,7 +46,7 @@ void powermap_initAna(void* const hPm)
     codecPars* pars = pData->pars;
     int i, j, n, N_azi, N_ele, nSH_order, order;
     float scaleY, hfov, vfov, fi, aspectRatio;
-    float* Y_grid_N, *grid_x_axis, *grid_y_axis;
+    float* Y_grid_N, *grid_x_axis, *grid_y_axis, *interp_table;
     
     order = pData->new_masterOrder;
     
@@ -96,9 +96,16 @@ void powermap_initAna(void* const hPm)
             pars->interp_dirs_deg[(i*N_azi + j)*2+1] = grid_y_axis[i];
         }
     }
+    interp_table = NULL;
+    generateVBAPgainTable3D_srcs(pars->interp_dirs_deg, N_azi*N_ele, pars->grid_dirs_deg, pars->grid_nDirs, 0, 0, 0.0f, &interp_table, &(pars->interp_nDirs), &(pars->interp_nTri));
+    
+    /* each display point depends on (at most) 3 grid points, so only their indices and AMPLITUDE-normalised gains are kept */
     free1d((void**)&(pars->interp_table));
-    generateVBAPgainTable3D_srcs(pars->interp_dirs_deg, N_azi*N_ele, pars->grid_dirs_deg, pars->grid_nDirs, 0, 0, 0.0f, &(pars->interp_table), &(pars->interp_nDirs), &(pars->interp_nTri));
-    VBAPgainTable2InterpTable(pars->interp_table, pars->interp_nDirs, pars->grid_nDirs);
+    free1d((void**)&(pars->interp_table_idx));
+    pars->interp_table = malloc1d(pars->interp_nDirs*3*sizeof(float));
+    pars->interp_table_idx = malloc1d(pars->interp_nDirs*3*sizeof(int));
+    compressVBAPgainTable3D(interp_table, pars->interp_nDirs, pars->grid_nDirs, pars->interp_table, pars->interp_table_idx);
+    free(interp_table);
     
     /* reallocate memory for storing the powermaps */
     free(pData->pmap);
@@ -91,7 +91,8 @@ typedef struct _codecPars
     float* grid_dirs_deg; /* grid_nDirs x 2 */
     int grid_nDirs;
     float* interp_dirs_deg;
-    float* interp_table;    /* interp_nDirs x grid_nDirs */
+    float* interp_table;    /* compressed interpolation table; interp_nDirs x 3 */
+    int* interp_table_idx;  /* grid indices for the compressed table; interp_nDirs x 3 */
     int interp_nDirs;
     int interp_nTri;
     
@@ -98,7 +98,7 @@ void rotator_process
 )
 {
     rotator_data *pData = (rotator_data*)(hRot);
-    int i, j, n, order, nSH;
+    int i, j, n, order, nSH, crossfadeFLAG;
     int o[MAX_SH_ORDER+2];
     float Rxyz[3][3];
     float* M_rot_tmp;
@@ -172,22 +172,15 @@ void rotator_process
                         pData->M_rot[i][j] = M_rot_tmp[i*nSH+j];
                 free(M_rot_tmp);
                 pData->recalc_M_rotFLAG = 0;
+                crossfadeFLAG = 1;
             }
-            else
+            else{
                 utility_svvcopy((const float*)pData->prev_M_rot, MAX_NUM_SH_SIGNALS*MAX_NUM_SH_SIGNALS, (float*)pData->M_rot);
+                crossfadeFLAG = 0; /* no change in rotation, so no need to crossfade */
+            }
             
-            /* apply rotation */
-            cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nSH, FRAME_SIZE, nSH, 1.0f,
-                        (float*)(pData->prev_M_rot), MAX_NUM_SH_SIGNALS,
-                        (float*)pData->prev_inputFrameTD, FRAME_SIZE, 0.0f,
-                        (float*)pData->tempFrame, FRAME_SIZE);
-            cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nSH, FRAME_SIZE, nSH, 1.0f,
-                        (float*)(pData->M_rot), MAX_NUM_SH_SIGNALS,
-                        (float*)pData->prev_inputFrameTD, FRAME_SIZE, 0.0f,
-                        (float*)pData->outputFrameTD, FRAME_SIZE);
-            for (i=0; i < nSH; i++)
-                for(j=0; j<FRAME_SIZE; j++)
-                    pData->outputFrameTD[i][j] = pData->interpolator[j] * pData->outputFrameTD[i][j] + (1.0f-pData->interpolator[j]) * pData->tempFrame[i][j];
+            /* apply rotation (block-diagonal, with crossfading from the previous rotation matrix if needed) */
+            rotator_applyRotation(hRot, order, crossfadeFLAG);
             
             /* for next frame */
             utility_svvcopy((const float*)pData->inputFrameTD, nSH*FRAME_SIZE, (float*)pData->prev_inputFrameTD);
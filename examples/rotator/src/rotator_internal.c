@@ -33,4 +33,46 @@
 #include "rotator.h"
 #include "rotator_internal.h"
 
-
+void rotator_applyRotation
+(
+    void* const hRot,
+    int order,
+    int crossfadeFLAG
+)
+{
+    rotator_data *pData = (rotator_data*)(hRot);
+    int l, i, j, t;
+    float m_ij, prev_m_ij;
+    float *in_j, *out_i, *prev_out_i;
+    
+    for(l=0; l<=order; l++){
+        /* only the (2l+1) x (2l+1) block of order l is non-zero */
+        for(i=l*l; i<(l+1)*(l+1); i++){
+            out_i = pData->outputFrameTD[i];
+            prev_out_i = pData->tempFrame[i];
+            memset(out_i, 0, FRAME_SIZE*sizeof(float));
+            if(crossfadeFLAG){
+                memset(prev_out_i, 0, FRAME_SIZE*sizeof(float));
+                for(j=l*l; j<(l+1)*(l+1); j++){
+                    m_ij = pData->M_rot[i][j];
+                    prev_m_ij = pData->prev_M_rot[i][j];
+                    in_j = pData->prev_inputFrameTD[j];
+                    for(t=0; t<FRAME_SIZE; t++){
+                        out_i[t] += m_ij * in_j[t];
+                        prev_out_i[t] += prev_m_ij * in_j[t];
+                    }
+                }
+                for(t=0; t<FRAME_SIZE; t++)
+                    out_i[t] = prev_out_i[t] + pData->interpolator[t] * (out_i[t] - prev_out_i[t]);
+            }
+            else{
+                for(j=l*l; j<(l+1)*(l+1); j++){
+                    m_ij = pData->M_rot[i][j];
+                    in_j = pData->prev_inputFrameTD[j];
+                    for(t=0; t<FRAME_SIZE; t++)
+                        out_i[t] += m_ij * in_j[t];
+                }
+            }
+        }
+    }
+}
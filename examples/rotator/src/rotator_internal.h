@@ -85,6 +85,29 @@ typedef struct _rotator
 } rotator_data;
     
     
+/* ========================================================================== */
+/*                             Internal Functions                             */
+/* ========================================================================== */
+
+/*
+ * rotator_applyRotation
+ * ---------------------
+ * Applies the SH rotation matrix to "prev_inputFrameTD" and writes the result
+ * to "outputFrameTD". Since the rotation matrix is block-diagonal, only the
+ * (2l+1) x (2l+1) block of each order l is applied. If crossfadeFLAG is set,
+ * the output is also crossfaded from "prev_M_rot" to "M_rot" (according to
+ * "interpolator"), in the same pass over the signals.
+ *
+ * Input Arguments:
+ *     hRot          - rotator handle
+ *     order         - order of the input/output signals
+ *     crossfadeFLAG - 1: crossfade from prev_M_rot to M_rot, 0: apply M_rot
+ */
+void rotator_applyRotation(void* const hRot,
+                           int order,
+                           int crossfadeFLAG);
+    
+    
 #ifdef __cplusplus
 } /* extern "C" { */
 #endif /* __cplusplus */
@@ -143,8 +143,7 @@ void sldoa_estimateDoA
 )
 {
     int n, ch, i, j, nSectors, analysisOrder, nSH;
-    float_complex secSig[4][TIME_SLOTS];
-    float_complex* sec_c;
+    float_complex* secSig;
     float secEnergy[TIME_SLOTS], secIntensity[3][TIME_SLOTS], secAzi[TIME_SLOTS], secElev[TIME_SLOTS];
     const float_complex calpha = cmplxf(1.0f, 0.0f); const float_complex cbeta = cmplxf(0.0f, 0.0f);
     int o[MAX_SH_ORDER+2];
@@ -156,36 +155,39 @@ void sldoa_estimateDoA
     analysisOrder = MAX(MIN(MAX_SH_ORDER, anaOrder),1);
     nSectors = ORDER2NUMSECTORS(analysisOrder);
     nSH = (analysisOrder+1)*(analysisOrder+1);
-    sec_c = malloc1d(4*nSH*sizeof(float_complex));
+    secSig = malloc1d(4*nSectors*TIME_SLOTS*sizeof(float_complex)); /* FLAT: 4 x nSectors x TIME_SLOTS */
+    
+    /* obtain the pressure and velocity signals for all sectors */
+    if(anaOrder==1 || secCoeffs == NULL){ /* standard first order active-intensity based DoA estimation */
+        for (i=0; i<4; i++)
+            for( n=0; n<nSectors; n++)
+                memcpy(&secSig[(i*nSectors+n)*TIME_SLOTS], SHframeTF[i], TIME_SLOTS * sizeof(float_complex));
+    }
+    else{ /* spatially localised active-intensity based DoA estimation */
+        /* secCoeffs is FLAT: 4 x nSectors x nSH, i.e. all sector patterns stacked as (4*nSectors) x nSH, which
+         * allows all of the sectors to be beamformed with one matrix multiplication */
+        cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, 4*nSectors, TIME_SLOTS, nSH, &calpha,
+                    secCoeffs, nSH,
+                    SHframeTF, TIME_SLOTS, &cbeta,
+                    secSig, TIME_SLOTS);
+    }
+    
+    /* convert N3D to SN3D */
+    for (ch = 1; ch<4; ch++)
+        for (n = 0; n<nSectors; n++)
+            for(i = 0; i<TIME_SLOTS; i++)
+                secSig[(ch*nSectors+n)*TIME_SLOTS+i] = crmulf(secSig[(ch*nSectors+n)*TIME_SLOTS+i], 1.0f/sqrtf(3.0f));
     
     /* calculate energy and DoA for each sector */
     for( n=0; n<nSectors; n++){
-        if(anaOrder==1 || secCoeffs == NULL) /* standard first order active-intensity based DoA estimation */
-            for (i=0; i<4; i++)
-                memcpy(secSig[i], SHframeTF[i], TIME_SLOTS * sizeof(float_complex));
-        else{ /* spatially localised active-intensity based DoA estimation */
-            for (i=0; i<4; i++)
-                for (j=0; j<nSH; j++)
-                    sec_c[i*nSH+j] = secCoeffs[i*(nSectors*nSH)+n*nSH+j];
-            cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, 4, TIME_SLOTS, nSH, &calpha,
-                        sec_c, nSH,
-                        SHframeTF, TIME_SLOTS, &cbeta,
-                        secSig, TIME_SLOTS);
-        }
-        
-        /* convert N3D to SN3D */
-        for (ch = 1; ch<4; ch++)
-            for(i = 0; i<TIME_SLOTS; i++)
-                secSig[ch][i] = crmulf(secSig[ch][i], 1.0f/sqrtf(3.0f));
-        
         /* calculate sector energy and intensity vector */
         memset(secEnergy, 0, TIME_SLOTS*sizeof(float));
         for (i=0; i<4; i++)
             for (j=0; j<TIME_SLOTS; j++)
-                secEnergy[j] += 0.5f*powf(cabsf(secSig[i][j]), 2.0f);
+                secEnergy[j] += 0.5f*powf(cabsf(secSig[(i*nSectors+n)*TIME_SLOTS+j]), 2.0f);
         for (i=0; i<3; i++)
             for (j=0; j<TIME_SLOTS; j++)
-                secIntensity[i][j] = crealf(ccmulf(conjf(secSig[0][j]), secSig[1+i][j]));
+                secIntensity[i][j] = crealf(ccmulf(conjf(secSig[n*TIME_SLOTS+j]), secSig[((1+i)*nSectors+n)*TIME_SLOTS+j]));
         
         /* extract DoA */
         for (j=0; j<TIME_SLOTS; j++){
@@ -201,6 +203,6 @@ void sldoa_estimateDoA
         }
     }
     
-    free(sec_c);
+    free(secSig);
 }
 
@@ -64,6 +64,7 @@ void upmix_create
     pData->pars = malloc(sizeof(codecPars));
     codecPars* pars = pData->pars;
     pars->grid_vbap_gtable = NULL;
+    pars->grid_vbap_gtableIdx = NULL;
     pars->grp_freqs = NULL;
     pars->grp_idx = NULL;
     pars->prev_est_dir = NULL; 
@@ -146,7 +147,7 @@ void upmix_process
 {
     upmix_data *pData = (upmix_data*)(hUpmx);
     codecPars* pars = pData->pars;
-    int t, sample, ch, i, j, k, band, grpband, num_grpBands, idx2D, ls;
+    int t, sample, ch, i, j, k, band, grpband, num_grpBands, idx2D, nnz;
     int* grp_bands;
     float est_dir, dummy;
     double Cx_grp00, Cx_grp11, ICC_01, A1, A2, B, C, src_en, diff_en, src_diff_en, w_denom;
@@ -164,7 +165,6 @@ void upmix_process
     const double mix_LsRs[MAX_NUM_OUTPUT_CHANNELS][MAX_NUM_INPUT_CHANNELS] = { { 0.0, 0.0}, {0.0,  0.0}, {0.0, 0.0}, {sqrt(4.0), 0.0}, {0.0, sqrt(4.0)}};
     
     /* local copies of user parameters */
-    int nLoudspeakers;
     float paramAvgCoeff, scaleDoAwidth, covAvg;
     
     /* reinitialise codec if needed */
@@ -174,7 +174,6 @@ void upmix_process
         pData->reInitCodec = 0;
     }
     if ((nSamples == FRAME_SIZE) && (isPlaying == 1) && (pData->reInitCodec == 0) ) {
-        nLoudspeakers = pData->nLoudspeakers;
         paramAvgCoeff = pData->paramAvgCoeff;
         scaleDoAwidth = pData->scaleDoAwidth;
         covAvg = pData->covAvg;
@@ -266,21 +265,22 @@ void upmix_process
             w_diff[1][1] = (src_diff_en + diff_en*diff_en)/w_denom;
             
             for(band=0; band<num_grpBands; band++){
-                /* Pull loudspeaker gains from vbap table */
+                /* Pull the (non-zero) loudspeaker gains from the compressed vbap table */
+                nnz = pars->grid_vbap_gtable_nnz;
                 idx2D = (int)((matlab_fmodf(est_dir+180.0f,360.0f)/pars->vbap_azi_res)+0.5f);
-                for (ls = 0; ls < nLoudspeakers; ls++)
-                    gains2D[ls] = (double)pars->grid_vbap_gtable[idx2D*nLoudspeakers+ls];
                  
                 /* apply pValue normalisation (i.e. amplitude normalises the VBAP gains for low frequencies depending on room) */
                 pv_f = pData->pValues[grp_bands[band]];
+                gains2D_sum_pvf = 1.0;
                 if(pv_f != 2.0f){
                     gains2D_sum_pvf = 0.0f;
-                    for (ls = 0; ls < nLoudspeakers; ls++)
-                        gains2D_sum_pvf += pow(MAX(gains2D[ls], 0.0), pv_f);
-                    gains2D_sum_pvf = pow(gains2D_sum_pvf, 1.0/(pv_f+2.23e-9));
-                    for (ls = 0; ls < nLoudspeakers; ls++)
-                        gains2D[ls] = gains2D[ls] / (gains2D_sum_pvf+2.23e-9);
+                    for (k = 0; k < nnz; k++)
+                        gains2D_sum_pvf += pow(MAX((double)pars->grid_vbap_gtable[idx2D*nnz+k], 0.0), pv_f);
+                    gains2D_sum_pvf = pow(gains2D_sum_pvf, 1.0/(pv_f+2.23e-9)) + 2.23e-9;
                 }
+                memset(gains2D, 0, MAX_NUM_OUTPUT_CHANNELS*sizeof(double));
+                for (k = 0; k < nnz; k++)
+                    gains2D[pars->grid_vbap_gtableIdx[idx2D*nnz+k]] += (double)pars->grid_vbap_gtable[idx2D*nnz+k] / gains2D_sum_pvf;
 
                 /* formulate direct mixing matrix */
                 cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, MAX_NUM_OUTPUT_CHANNELS, MAX_NUM_INPUT_CHANNELS, 1, 1.0,
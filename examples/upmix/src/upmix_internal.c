@@ -108,6 +108,7 @@ void upmix_initCodec
     upmix_data *pData = (upmix_data*)(hUpmx);
     codecPars* pars = pData->pars;
     int i, j;
+    float* grid_vbap_gtable;
     
     /* generate VBAP gain table for the grid */
     pars->vbap_azi_res = 1;
@@ -116,7 +117,12 @@ void upmix_initCodec
         for(j=0; j<2; j++)
             pData->loudpkrs_dirs_deg[i][j] = __5pX_dirs_deg[i][j]; /* only stereo to 5.x is currently supported */
     free(pars->grid_vbap_gtable);
-    generateVBAPgainTable2D((float*)pData->loudpkrs_dirs_deg, pData->nLoudspeakers, pars->vbap_azi_res , &(pars->grid_vbap_gtable), &(pars->grid_N_vbap_gtable), &(pars->grid_nPairs));
+    free(pars->grid_vbap_gtableIdx);
+    grid_vbap_gtable = NULL;
+    generateVBAPgainTable2D((float*)pData->loudpkrs_dirs_deg, pData->nLoudspeakers, pars->vbap_azi_res , &grid_vbap_gtable, &(pars->grid_N_vbap_gtable), &(pars->grid_nPairs));
+    compressVBAPgainTable(grid_vbap_gtable, pars->grid_N_vbap_gtable, pData->nLoudspeakers, &(pars->grid_vbap_gtable_nnz),
+                          &(pars->grid_vbap_gtable), &(pars->grid_vbap_gtableIdx));
+    free(grid_vbap_gtable);
     
     /* define band grouping */
     pars->maxGrpFreq = MAX_GROUP_FREQ;
@@ -64,7 +64,9 @@ extern "C" {
 typedef struct _codecPars
 {
     /* 2D VBAP gain table */
-    float* grid_vbap_gtable;                           /* 2D gain table to pan the source signal to estimated azimuth */
+    float* grid_vbap_gtable;                           /* compressed 2D gain table to pan the source signal to estimated azimuth; FLAT: grid_N_vbap_gtable x grid_vbap_gtable_nnz */
+    int* grid_vbap_gtableIdx;                          /* loudspeaker indices of the compressed 2D gain table; FLAT: grid_N_vbap_gtable x grid_vbap_gtable_nnz */
+    int grid_vbap_gtable_nnz;                          /* number of (non-zero) gains per grid direction in the compressed gain table */
     int grid_nPairs;                                   /* number of loudspeaker pairs in vbap gain table */
     int grid_N_vbap_gtable;                            /* number of grid directions in vbap gain table */
     int vbap_azi_res;                                  /* azimuth step size in degrees; (min: 1) */
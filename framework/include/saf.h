@@ -151,16 +151,15 @@
  * SAF Module: SOFA Reader
  * -----------------------
  * A simple SOFA file reader that returns only the bare minimum needed to
- * load HRIR data.
+ * load HRIR data. Note that .safhrir files (and the default HRIR data) may
+ * still be loaded when the SOFA reader is not enabled.
  *
  * Enable instructions:
  *     Add this pre-processor definition to your project: SAF_ENABLE_SOFA_READER
  * Dependencies:
  *     netcdf library
  */
-#ifdef SAF_ENABLE_SOFA_READER
-# include "../modules/saf_hrir/saf_sofa_reader.h"
-#endif
+#include "../modules/saf_hrir/saf_sofa_reader.h"
 
 
 #endif /* SAF_H_INCLUDED */
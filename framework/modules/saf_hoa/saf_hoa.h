@@ -183,7 +183,7 @@ void getRSH(/* Input Arguments */
  * ----------------------
  * This function returns REAL spherical harmonics [1] for multiple directions on
  * the sphere. WITHOUT the 1/sqrt(4*pi) term. i.e. max(omni) = 1
- * Note: Compared to 'getRSH', this function uses 'unnorm_legendreP_recur' and
+ * Note: Compared to 'getRSH', this function uses 'getSHreal_recur' and
  * single precision, so is more suitable for determining 'Y' in a real-time
  * loop. It sacrifices some precision, as numerical error propogates through
  * the recursion, but it is faster.
@@ -45,9 +45,9 @@ void estimateITDs
     float* itds_s
 )
 {
-    int i, n, j, k, maxIdx, xcorr_len;
+    int i, n, j, maxIdx, maxLag;
     float maxVal, itd_bounds, fc, Q, K, KK, D, wn, Wz1[2], Wz2[2], b[3], a[3];
-    float* xcorr_LR, *ir_L, *ir_R, *hrir_lpf;
+    float* xcorr_LR, *ir_L, *ir_R;
 
     /* calculate LPF coefficients, 2nd order IIR design equations from DAFX (2nd ed) p50 */
     fc = 750.0f;
@@ -58,41 +58,38 @@ void estimateITDs
 	b[0] = (KK * Q) / D; b[1] = (2.0f * KK * Q) / D; b[2] = (KK * Q) / D;
 	a[0] = 1.0f; a[1] = (2.0f * Q * (KK - 1.0f)) / D; a[2] = (KK * Q - K + Q) / D;
     
-    /* determine the ITD via the cross-correlation between the LPF'd left and right HRIR signals */
-    xcorr_len = 2*(hrir_len)-1;
-    itd_bounds = sqrtf(2.0f)/2e3f;
-    xcorr_LR = (float*)malloc1d(xcorr_len*sizeof(float));
-    ir_L = (float*)malloc1d(hrir_len*sizeof(float));
-    ir_R = (float*)malloc1d(hrir_len*sizeof(float));
-    hrir_lpf = (float*)malloc1d(hrir_len*2*sizeof(float));
+    /* apply lpf to the left and right HRIR signals */
+    ir_L = (float*)malloc1d(N_dirs*hrir_len*sizeof(float));
+    ir_R = (float*)malloc1d(N_dirs*hrir_len*sizeof(float));
     for(i=0; i<N_dirs; i++){
-        /* apply lpf */
         memset(Wz1, 0, 2*sizeof(float));
         memset(Wz2, 0, 2*sizeof(float));
         for (n=0; n<hrir_len; n++){
             for(j=0; j<NUM_EARS; j++){
                 /* biquad difference equation (Direct form 2) */
                 wn = hrirs[i*NUM_EARS*hrir_len + j*hrir_len + n] - a[1] * Wz1[j] - a[2] * Wz2[j];
-                hrir_lpf[n*2+j]  = b[0] * wn + b[1]*Wz1[j] + b[2]*Wz2[j];
+                (j==0 ? ir_L : ir_R)[i*hrir_len + n] = b[0] * wn + b[1]*Wz1[j] + b[2]*Wz2[j];
                 
                 /* shuffle delays */
                 Wz2[j] = Wz1[j];
                 Wz1[j] = wn;
             }
         }
-        
-        /* xcorr between L and R */
-        for(k=0; k<hrir_len; k++){
-            ir_L[k] = hrir_lpf[k*2+0];
-            ir_R[k] = hrir_lpf[k*2+1];
-        }
-        cxcorr(ir_L, ir_R, xcorr_LR, hrir_len, hrir_len);
+    }
+    
+    /* determine the ITD via the cross-correlation between the LPF'd left and right HRIR signals. Only the lags
+     * which correspond to physically plausible ITDs (+/-itd_bounds, plus one sample) are searched for the peak */
+    itd_bounds = sqrtf(2.0f)/2e3f;
+    maxLag = MIN((int)(itd_bounds*(float)fs) + 1, hrir_len-1);
+    xcorr_LR = (float*)malloc1d(N_dirs*(2*maxLag+1)*sizeof(float));
+    cxcorrBatch(ir_L, ir_R, N_dirs, hrir_len, maxLag, xcorr_LR);
+    for(i=0; i<N_dirs; i++){
         maxIdx = 0;
         maxVal = 0.0f;
-        for(j=0; j<xcorr_len; j++){
-            if(xcorr_LR[j] > maxVal){
-                maxIdx = j;
-                maxVal = xcorr_LR[j];
+        for(j=0; j<2*maxLag+1; j++){
+            if(xcorr_LR[i*(2*maxLag+1)+j] > maxVal){
+                maxIdx = hrir_len-1-maxLag+j; /* index into the full cross-correlation */
+                maxVal = xcorr_LR[i*(2*maxLag+1)+j];
             }
         }
         itds_s[i] = ((float)hrir_len-(float)maxIdx-1.0f)/(float)fs;
@@ -103,7 +100,6 @@ void estimateITDs
     free(xcorr_LR);
     free(ir_L);
     free(ir_R);
-    free(hrir_lpf);
 }
 
 void HRIRs2FilterbankHRTFs
@@ -151,6 +147,54 @@ void HRIRs2HRTFs
     free(hrtf);
 }
 
+void HRIRs2MinPhaseHRIRs
+(
+    float* hrirs,   /* N_dirs x NUM_EARS x hrir_len */
+    int N_dirs,
+    int hrir_len,
+    float* hrirs_mp /* N_dirs x NUM_EARS x hrir_len */
+)
+{
+    int i, j, k, fftSize, nBins;
+    void* hSafFFT;
+    float* x_pad;
+    float_complex* X;
+    
+    /* zero-padding reduces the time-aliasing of the cepstrum */
+    fftSize = 4*hrir_len;
+    nBins = fftSize/2 + 1;
+    saf_rfft_create(&hSafFFT, fftSize);
+    x_pad = malloc1d(fftSize*sizeof(float));
+    X = malloc1d(nBins*sizeof(float_complex));
+    for(i=0; i<N_dirs; i++){
+        for(j=0; j<NUM_EARS; j++){
+            /* real cepstrum, log(abs(fft(x))) */
+            memset(x_pad, 0, fftSize*sizeof(float));
+            memcpy(x_pad, &hrirs[i*NUM_EARS*hrir_len+j*hrir_len], hrir_len*sizeof(float));
+            saf_rfft_forward(hSafFFT, x_pad, X);
+            for(k=0; k<nBins; k++)
+                X[k] = cmplxf(logf(MAX(cabsf(X[k]), 1e-8f)), 0.0f);
+            saf_rfft_backward(hSafFFT, X, x_pad);
+            
+            /* fold the anti-causal part of the cepstrum onto the causal part */
+            for(k=1; k<fftSize/2; k++)
+                x_pad[k] *= 2.0f;
+            memset(&x_pad[fftSize/2+1], 0, (fftSize/2-1)*sizeof(float));
+            
+            /* minimum-phase spectrum, exp(fft(folded cepstrum)) */
+            saf_rfft_forward(hSafFFT, x_pad, X);
+            for(k=0; k<nBins; k++)
+                X[k] = cexpf(X[k]);
+            saf_rfft_backward(hSafFFT, X, x_pad);
+            memcpy(&hrirs_mp[i*NUM_EARS*hrir_len+j*hrir_len], x_pad, hrir_len*sizeof(float));
+        }
+    }
+    
+    saf_rfft_destroy(&hSafFFT);
+    free(x_pad);
+    free(X);
+}
+
 void diffuseFieldEqualiseHRTFs
 (
     int N_dirs,
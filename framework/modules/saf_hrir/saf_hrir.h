@@ -35,6 +35,7 @@
 extern "C" {
 #endif /* __cplusplus */
     
+#include <stdint.h>
 #include "../saf_utilities/saf_utilities.h"
     
 /* misc. */
@@ -61,7 +62,8 @@ extern const int __default_hrir_fs;
  * Function: estimateITDs
  * ----------------------
  * Estimates the interaural time-differences (ITDs) for each HRIR in a set via
- * the cross-correlation between the left and right IRs
+ * the cross-correlation between the left and right IRs. Only the lags which
+ * correspond to physically plausible ITDs (up to +/-0.7ms) are searched
  *
  * Input Arguments:
  *     hrirs    - HRIRs; FLAT: N_dirs x 2 x hrir_len
@@ -127,6 +129,30 @@ void HRIRs2HRTFs(/* Input Arguments */
                  /* Output Arguments */
                  float_complex* hrtfs);
 
+/*
+ * Function: HRIRs2MinPhaseHRIRs
+ * -----------------------------
+ * Converts a HRIR set to its minimum-phase form, via the folded real cepstrum
+ * of the zero-padded HRIRs. The magnitude responses are retained, whereas the
+ * onset delays (and therefore also the ITDs) are removed; which may be
+ * re-introduced using the ITDs estimated with "estimateITDs".
+ * Note: this function is NOT suitable for binaural room impulse responses
+ * (BRIRs).
+ *
+ * Input Arguments:
+ *     hrirs    - HRIRs; FLAT: N_dirs x 2 x hrir_len
+ *     N_dirs   - number of HRIRs
+ *     hrir_len - length of the HRIRs in samples
+ * Output Arguments:
+ *     hrirs_mp - minimum-phase HRIRs; FLAT: N_dirs x 2 x hrir_len
+ */
+void HRIRs2MinPhaseHRIRs(/* Input Arguments */
+                         float* hrirs,
+                         int N_dirs,
+                         int hrir_len,
+                         /* Output Arguments */
+                         float* hrirs_mp);
+
 /*
  * Function: diffuseFieldEqualiseHRTFs
  * -----------------------------------
@@ -216,6 +242,207 @@ void binauralDiffuseCoherence(/* Input Arguments */
                               /* Output Arguments */
                               float* HRTFcoh);
 
+    
+/* ========================================================================== */
+/*                          SAF HRIR File (.safhrir)                          */
+/* ========================================================================== */
+
+/* version of the .safhrir file format */
+#define SAF_HRIR_FILE_VERSION ( 1 )
+
+/*
+ * Function: hrirFile_open
+ * -----------------------
+ * Opens (memory maps) a .safhrir file; a compact HRIR container comprising a
+ * header, the HRIR directions, and the HRIRs in single precision. The data is
+ * used directly from the mapping (no parsing, conversion or copying), and is
+ * only read from disk as it is accessed. SOFA files may be converted to this
+ * format using "convertSofaToHRIRfile" (see saf_sofa_reader.h)
+ *
+ * Input Arguments:
+ *     phHRIR - & address of the HRIR file handle (NULL on failure)
+ *     path   - path to the .safhrir file
+ * Returns:
+ *     1: success, 0: the file does not exist, or is not a valid .safhrir file
+ */
+int hrirFile_open(void** const phHRIR,
+                  const char* path);
+
+/*
+ * Function: hrirFile_getData
+ * --------------------------
+ * Returns pointers to the HRIR data of an opened .safhrir file. The pointers
+ * remain valid until "hrirFile_close" is called. Note that, unlike
+ * "loadSofaFile", the HRIRs are not truncated to "MAX_SOFA_HRIR_LENGTH"
+ *
+ * Input Arguments:
+ *     hHRIR         - HRIR file handle
+ * Output Arguments:
+ *     hrirs         - & HRIR data; FLAT: N_hrir_dirs x 2 x hrir_len
+ *     hrir_dirs_deg - & HRIR directions in degrees [azi elev];
+ *                     FLAT: N_hrir_dirs x 2
+ *     N_hrir_dirs   - & number of HRIR directions
+ *     hrir_len      - & length of the HRIRs in samples
+ *     hrir_fs       - & sampling rate of the HRIRs
+ */
+void hrirFile_getData(/* Input Arguments */
+                      void* const hHRIR,
+                      /* Output Arguments */
+                      const float** hrirs,
+                      const float** hrir_dirs_deg,
+                      int* N_hrir_dirs,
+                      int* hrir_len,
+                      int* hrir_fs);
+
+/*
+ * Function: hrirFile_close
+ * ------------------------
+ * Closes (unmaps) a .safhrir file opened with "hrirFile_open"
+ *
+ * Input Arguments:
+ *     phHRIR - & address of the HRIR file handle
+ */
+void hrirFile_close(void** const phHRIR);
+
+/*
+ * Function: hrirFile_save
+ * -----------------------
+ * Writes an HRIR set to a .safhrir file
+ *
+ * Input Arguments:
+ *     path          - path to the .safhrir file
+ *     hrirs         - HRIR data; FLAT: N_hrir_dirs x 2 x hrir_len
+ *     hrir_dirs_deg - HRIR directions in degrees [azi elev];
+ *                     FLAT: N_hrir_dirs x 2
+ *     N_hrir_dirs   - number of HRIR directions
+ *     hrir_len      - length of the HRIRs in samples
+ *     hrir_fs       - sampling rate of the HRIRs
+ * Returns:
+ *     1: success, 0: the file could not be written
+ */
+int hrirFile_save(const char* path,
+                  const float* hrirs,
+                  const float* hrir_dirs_deg,
+                  int N_hrir_dirs,
+                  int hrir_len,
+                  int hrir_fs);
+
+    
+/* ========================================================================== */
+/*                            On-Disk HRTF Cache                              */
+/* ========================================================================== */
+
+/* version of the cache file format; entries written by other versions are
+ * ignored (and overwritten). Bump this if the layout of the cached data, or the
+ * way in which it is computed, changes */
+#define SAF_HRTF_CACHE_VERSION ( 1 )
+/* initial value for "hrtfCache_hash" */
+#define SAF_HRTF_CACHE_HASH_SEED ( 14695981039346656037ULL )
+
+/*
+ * Function: hrtfCache_hash
+ * ------------------------
+ * Updates a 64-bit FNV-1a hash with a block of data. Cache keys are formed by
+ * hashing everything the cached data depends on (the HRIR data, sampling rate,
+ * processing parameters etc.), starting from SAF_HRTF_CACHE_HASH_SEED
+ *
+ * Input Arguments:
+ *     hash   - hash so far (or SAF_HRTF_CACHE_HASH_SEED)
+ *     data   - data to add to the hash
+ *     nBytes - size of data, in bytes
+ * Returns:
+ *     the updated hash
+ */
+uint64_t hrtfCache_hash(uint64_t hash,
+                        const void* data,
+                        size_t nBytes);
+
+/*
+ * Function: hrtfCache_hashFile
+ * ----------------------------
+ * Updates a 64-bit FNV-1a hash with the size and the full contents of a file
+ * (e.g. a SOFA file). The key therefore only depends on the data itself; a
+ * file that is modified results in a different key, whereas a copy of a file
+ * (or the same file under a different path) results in the same key
+ *
+ * Input Arguments:
+ *     hash - hash so far (or SAF_HRTF_CACHE_HASH_SEED)
+ *     path - path to the file
+ * Returns:
+ *     the updated hash, or 0 if the file could not be read
+ */
+uint64_t hrtfCache_hashFile(uint64_t hash,
+                            const char* path);
+
+/*
+ * Function: hrtfCache_open
+ * ------------------------
+ * Opens (memory maps) the cache entry for "key", if it exists in "cacheDir".
+ * Entries which are truncated, were written by a different version of the
+ * cache, or do not match their stored checksum, are treated as a miss
+ *
+ * Input Arguments:
+ *     phCache  - & address of the cache entry handle (NULL on a miss)
+ *     cacheDir - directory containing the cache files (NULL: disabled)
+ *     key      - key of the entry (see "hrtfCache_hash")
+ * Returns:
+ *     1: a valid entry was opened, 0: miss
+ */
+int hrtfCache_open(void** const phCache,
+                   const char* cacheDir,
+                   uint64_t key);
+
+/*
+ * Function: hrtfCache_getBlock
+ * ----------------------------
+ * Returns a pointer to one of the blocks of an opened cache entry. Blocks are
+ * 64-byte aligned, and remain valid until "hrtfCache_close" is called
+ *
+ * Input Arguments:
+ *     hCache   - cache entry handle
+ *     blockIdx - index of the block (in the order passed to "hrtfCache_save")
+ * Output Arguments:
+ *     nBytes   - & size of the block, in bytes (0 if it does not exist)
+ * Returns:
+ *     pointer to the block data, or NULL if it does not exist
+ */
+const void* hrtfCache_getBlock(void* const hCache,
+                               int blockIdx,
+                               size_t* nBytes);
+
+/*
+ * Function: hrtfCache_close
+ * -------------------------
+ * Closes (unmaps) a cache entry opened with "hrtfCache_open"
+ *
+ * Input Arguments:
+ *     phCache - & address of the cache entry handle
+ */
+void hrtfCache_close(void** const phCache);
+
+/*
+ * Function: hrtfCache_save
+ * ------------------------
+ * Writes a new cache entry for "key", consisting of nBlocks blocks of data.
+ * The entry is first written to a temporary file (unique to the calling
+ * process and thread) and then renamed, so readers never see a partially
+ * written entry
+ *
+ * Input Arguments:
+ *     cacheDir - directory to store the cache file in (must already exist)
+ *     key      - key of the entry (see "hrtfCache_hash")
+ *     nBlocks  - number of blocks
+ *     blocks   - the data of each block; nBlocks x 1
+ *     nBytes   - size of each block, in bytes; nBlocks x 1
+ * Returns:
+ *     1: success, 0: the entry could not be written
+ */
+int hrtfCache_save(const char* cacheDir,
+                   uint64_t key,
+                   int nBlocks,
+                   const void** blocks,
+                   const size_t* nBytes);
+
 
 #ifdef __cplusplus
 } /* extern "C" */
@@ -0,0 +1,182 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Filename: saf_hrir_file.c
+ * -------------------------
+ * A compact binary container for HRIR sets (".safhrir"), which may be memory
+ * mapped and used in-place, without any parsing or conversion. Unlike SOFA
+ * files, it does not require netcdf/HDF5 to read.
+ *
+ * File layout (little-endian):
+ *     header    - see "hrirFile_header"; 64 bytes
+ *     dirs      - HRIR directions in degrees [azi elev]; FLAT: N_dirs x 2
+ *     hrirs     - HRIRs (float32); FLAT: N_dirs x 2 x hrir_len, starting at a
+ *                 64 byte aligned offset
+ *
+ * Dependencies:
+ *     saf_utilities
+ * Author, date created:
+ *     agent, 18.10.2026
+ */
+
+#include "saf_hrir.h"
+#include "saf_hrir_internal.h"
+#include <limits.h>
+
+#define HRIR_FILE_MAGIC "SAFHRIRS"
+#define HRIR_FILE_BYTE_ORDER_MARK ( 0x01020304u )
+#define HRIR_FILE_ALIGNMENT ( 64 )
+
+typedef struct _hrirFile_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrderMark;
+    uint32_t N_dirs;
+    uint32_t nEars;
+    uint32_t hrir_len;
+    uint32_t hrir_fs;
+    uint64_t dirsOffset;
+    uint64_t hrirsOffset;
+    uint8_t reserved[16];
+
+}hrirFile_header;
+
+typedef struct _hrirFile_data {
+    void* hMap;                    /* mapping of the whole file */
+    const hrirFile_header* header; /* start of the mapped file */
+
+}hrirFile_data;
+
+int hrirFile_open
+(
+    void** const phHRIR,
+    const char* path
+)
+{
+    hrirFile_data* h;
+    const hrirFile_header* header;
+    void* hMap;
+    size_t fileSize;
+    uint64_t nDirs, len, fs;
+
+    (*phHRIR) = NULL;
+    if(path==NULL || !hrtfCache_mapFileReadOnly(path, &hMap, (const void**)&header, &fileSize))
+        return 0;
+
+    /* check that this is a (complete) HRIR file, which was written on a host with the same byte order. The dimensions
+     * are returned (and the HRIRs then indexed) as ints, and the sizes are checked by division, so that a corrupt
+     * header cannot overflow either */
+    nDirs = fileSize >= sizeof(hrirFile_header) ? (uint64_t)header->N_dirs : 0;
+    len = fileSize >= sizeof(hrirFile_header) ? (uint64_t)header->hrir_len : 0;
+    fs = fileSize >= sizeof(hrirFile_header) ? (uint64_t)header->hrir_fs : 0;
+    if(fileSize < sizeof(hrirFile_header) || memcmp(header->magic, HRIR_FILE_MAGIC, 8)!=0 ||
+       header->version != SAF_HRIR_FILE_VERSION || header->byteOrderMark != HRIR_FILE_BYTE_ORDER_MARK ||
+       nDirs == 0 || nDirs > INT_MAX || len == 0 || len > INT_MAX || fs > INT_MAX || header->nEars != NUM_EARS ||
+       nDirs > (uint64_t)INT_MAX/(NUM_EARS*len) ||
+       header->dirsOffset % sizeof(float) != 0 || header->hrirsOffset % sizeof(float) != 0 ||
+       header->dirsOffset > (uint64_t)fileSize ||
+       nDirs > ((uint64_t)fileSize - header->dirsOffset)/(2*sizeof(float)) ||
+       header->hrirsOffset > (uint64_t)fileSize ||
+       nDirs > ((uint64_t)fileSize - header->hrirsOffset)/(NUM_EARS*len*sizeof(float))){
+        hrtfCache_unmapFile(&hMap);
+        return 0;
+    }
+    h = (hrirFile_data*)malloc1d(sizeof(hrirFile_data));
+    h->hMap = hMap;
+    h->header = header;
+    (*phHRIR) = (void*)h;
+    return 1;
+}
+
+void hrirFile_getData
+(
+    void* const hHRIR,
+    const float** hrirs,
+    const float** hrir_dirs_deg,
+    int* N_hrir_dirs,
+    int* hrir_len,
+    int* hrir_fs
+)
+{
+    hrirFile_data *h = (hrirFile_data*)(hHRIR);
+    const uint8_t* data = (const uint8_t*)h->header;
+
+    (*hrirs) = (const float*)(data + h->header->hrirsOffset);
+    (*hrir_dirs_deg) = (const float*)(data + h->header->dirsOffset);
+    (*N_hrir_dirs) = (int)h->header->N_dirs;
+    (*hrir_len) = (int)h->header->hrir_len;
+    (*hrir_fs) = (int)h->header->hrir_fs;
+}
+
+void hrirFile_close
+(
+    void** const phHRIR
+)
+{
+    hrirFile_data *h = (hrirFile_data*)(*phHRIR);
+
+    if (h != NULL) {
+        hrtfCache_unmapFile(&(h->hMap));
+        free(h);
+        h = NULL;
+        *phHRIR = NULL;
+    }
+}
+
+int hrirFile_save
+(
+    const char* path,
+    const float* hrirs,
+    const float* hrir_dirs_deg,
+    int N_hrir_dirs,
+    int hrir_len,
+    int hrir_fs
+)
+{
+    FILE* file;
+    hrirFile_header header;
+    const uint8_t zeros[HRIR_FILE_ALIGNMENT] = {0};
+    size_t dirsBytes, hrirsBytes, padBytes;
+    int ok;
+
+    if(path==NULL || N_hrir_dirs<=0 || hrir_len<=0)
+        return 0;
+    dirsBytes = (size_t)N_hrir_dirs*2*sizeof(float);
+    hrirsBytes = (size_t)N_hrir_dirs*NUM_EARS*hrir_len*sizeof(float);
+    memset(&header, 0, sizeof(hrirFile_header));
+    memcpy(header.magic, HRIR_FILE_MAGIC, 8);
+    header.version = SAF_HRIR_FILE_VERSION;
+    header.byteOrderMark = HRIR_FILE_BYTE_ORDER_MARK;
+    header.N_dirs = (uint32_t)N_hrir_dirs;
+    header.nEars = NUM_EARS;
+    header.hrir_len = (uint32_t)hrir_len;
+    header.hrir_fs = (uint32_t)hrir_fs;
+    header.dirsOffset = sizeof(hrirFile_header);
+    header.hrirsOffset = (header.dirsOffset + dirsBytes + HRIR_FILE_ALIGNMENT-1) / HRIR_FILE_ALIGNMENT * HRIR_FILE_ALIGNMENT;
+    padBytes = (size_t)(header.hrirsOffset - header.dirsOffset - dirsBytes);
+
+    if((file = fopen(path, "wb")) == NULL)
+        return 0;
+    ok = fwrite(&header, sizeof(hrirFile_header), 1, file) == 1;
+    ok = ok && fwrite(hrir_dirs_deg, 1, dirsBytes, file) == dirsBytes;
+    ok = ok && fwrite(zeros, 1, padBytes, file) == padBytes;
+    ok = ok && fwrite(hrirs, 1, hrirsBytes, file) == hrirsBytes;
+    ok = (fclose(file) == 0) && ok;
+    if(!ok)
+        remove(path);
+    return ok;
+}
@@ -40,34 +40,93 @@ void cxcorr
     size_t lb
 )
 {
-    int m, n, negFLAG, arg;
-    size_t len, lim;
-    
-    len = la + lb - 1;
-    memset(x_ab, 0, len*sizeof(float));
-    for(m=1; m<=len; m++){
-        arg = m-(int)la;
-        if(arg<0){
-            negFLAG = 1;
-            lim = la + arg;
-        }
-        else{
-            negFLAG = 0;
-            lim = la - arg;
-        }
-        for(n=1; n<=lim; n++){
-            if(negFLAG == 0)
-                x_ab[m-1] += (a[arg+n-1] * b[n-1]);
-            else
-                x_ab[m-1] += (a[n-1] * b[n-arg-1]);
-        }
+    int i, len, fftSize, nBins;
+    float* a0, *b0, *x0;
+    float_complex* A, *B;
+    void* hFFT;
+    
+    /* x_ab(lb-1+lag) = sum_n a(n+lag)*b(n) = IFFT(FFT(a).*conj(FFT(b))), zero-padded to avoid circular
+     * wrapping; negative lags are found at the end of the circular result */
+    len = (int)(la + lb) - 1;
+    for(fftSize=2; fftSize<len; fftSize*=2);
+    nBins = fftSize/2+1;
+    a0 = calloc1d(fftSize, sizeof(float));
+    b0 = calloc1d(fftSize, sizeof(float));
+    x0 = malloc1d(fftSize*sizeof(float));
+    A = malloc1d(nBins*sizeof(float_complex));
+    B = malloc1d(nBins*sizeof(float_complex));
+    saf_rfft_create(&hFFT, fftSize);
+    memcpy(a0, a, la*sizeof(float));
+    memcpy(b0, b, lb*sizeof(float));
+    saf_rfft_forward(hFFT, a0, A);
+    saf_rfft_forward(hFFT, b0, B);
+    for(i=0; i<nBins; i++)
+        A[i] = ccmulf(A[i], conjf(B[i]));
+    saf_rfft_backward(hFFT, A, x0);
+    for(i=0; i<len; i++)
+        x_ab[i] = x0[(i-(int)lb+1+fftSize)%fftSize];
+    
+    saf_rfft_destroy(&hFFT);
+    free(a0);
+    free(b0);
+    free(x0);
+    free(A);
+    free(B);
+}
+
+void cxcorrBatch
+(
+    float* a,
+    float* b,
+    int nPairs,
+    int len,
+    int maxLag,
+    float* x_ab
+)
+{
+    int i, n, lag, fftSize, nBins;
+    float* a0, *b0, *x0;
+    float_complex* A, *B;
+    void* hFFT;
+    
+    /* one FFT plan, and one set of buffers, is shared by all pairs */
+    for(fftSize=2; fftSize<2*len-1; fftSize*=2);
+    nBins = fftSize/2+1;
+    a0 = calloc1d(fftSize, sizeof(float));
+    b0 = calloc1d(fftSize, sizeof(float));
+    x0 = malloc1d(fftSize*sizeof(float));
+    A = malloc1d(nBins*sizeof(float_complex));
+    B = malloc1d(nBins*sizeof(float_complex));
+    saf_rfft_create(&hFFT, fftSize);
+    for(n=0; n<nPairs; n++){
+        memcpy(a0, &a[n*len], len*sizeof(float));
+        memcpy(b0, &b[n*len], len*sizeof(float));
+        saf_rfft_forward(hFFT, a0, A);
+        saf_rfft_forward(hFFT, b0, B);
+        for(i=0; i<nBins; i++)
+            A[i] = ccmulf(A[i], conjf(B[i]));
+        saf_rfft_backward(hFFT, A, x0);
+        
+        /* only the lags within +/-maxLag are returned */
+        for(lag=-maxLag; lag<=maxLag; lag++)
+            x_ab[n*(2*maxLag+1) + maxLag+lag] = lag > -len && lag < len ? x0[(lag+fftSize)%fftSize] : 0.0f;
     }
+    
+    saf_rfft_destroy(&hFFT);
+    free(a0);
+    free(b0);
+    free(x0);
+    free(A);
+    free(B);
 }
 
 /* currently hard coded for a 128 hop size with hybrid mode enabled */
 /* Copyright (c) 2015 Juha Vilkamo, MIT license */
 static void afAnalyse
 (
+    void* hSTFT,
+    complexVector* FrameTF /* nCH x 1 */,
+    float** tempHopFrameTD /* nCH x hopSize */,
     float* inTD/* nSamplesTD x nCH */,
     int nSamplesTD,
     int nCH,
@@ -75,51 +134,105 @@ static void afAnalyse
 )
 {
     int t, ch, sample, band;
-    void* hSTFT;
-    complexVector** FrameTF;
-    float** tempHopFrameTD;
     int nTimeSlots, hyrbidBands, hopSize;
     
     hopSize = 128;
     hyrbidBands =hopSize+5; 
     nTimeSlots = nSamplesTD/hopSize;
     
-    /* allocate memory */
-    afSTFTinit(&(hSTFT), hopSize, nCH, 1, 0, 1);
-    FrameTF = (complexVector**)malloc2d(nTimeSlots, nCH, sizeof(complexVector));
-    for(t=0; t<nTimeSlots; t++) {
-        for(ch=0; ch< nCH; ch++) {
-            FrameTF[t][ch].re = (float*)calloc1d(hyrbidBands, sizeof(float));
-            FrameTF[t][ch].im = (float*)calloc1d(hyrbidBands, sizeof(float));
-        }
-    }
-    tempHopFrameTD = (float**)malloc2d(nCH, hopSize, sizeof(float));
+    /* the filterbank is re-used, so it is first cleared of any previous signal */
+    afSTFTclearBuffers(hSTFT);
     
-    /* perform TF transform */
+    /* perform TF transform, and save result to output */
     for ( t=0; t< nTimeSlots; t++) {
         for( ch=0; ch < nCH; ch++)
             for ( sample=0; sample < hopSize; sample++)
                 tempHopFrameTD[ch][sample] = inTD[(sample + t*hopSize)*nCH + ch];
-        afSTFTforward(hSTFT, (float**)tempHopFrameTD, (complexVector*)FrameTF[t]);
+        afSTFTforward(hSTFT, (float**)tempHopFrameTD, FrameTF);
+        for(band=0; band<hyrbidBands; band++)
+            for( ch=0; ch < nCH; ch++)
+                outTF[band*nTimeSlots*nCH + t*nCH + ch] = cmplxf(FrameTF[ch].re[band], FrameTF[ch].im[band]);
     }
+}
+
+/* converts the FIRs of directions "first" to "last"-1. Each chunk of directions has its own filterbank and scratch
+ * memory, so different chunks may be converted concurrently */
+static void FIRtoFilterbankCoeffs_chunk
+(
+    float* hIR /*N_dirs x nCH x ir_len*/,
+    int first,
+    int last,
+    int N_dirs,
+    int nCH,
+    int ir_len,
+    int ir_pad,
+    int nBands,
+    float_complex* centerImpulseFB /* nBands x nTimeSlots */,
+    float* centerImpulseFB_energy /* nBands x 1 */,
+    float_complex* hFB /* nBands x nCH x N_dirs */
+)
+{
+    int i, j, t, nd, nm, nTimeSlots, hopSize;
+    float irFB_energy, irFB_gain, cross_re, cross_im, cross_abs;
+    float* ir;
+    float** tempHopFrameTD;
+    float_complex* irFB, *x, *c;
+    complexVector* FrameTF;
+    void* hSTFT;
     
-    /* save result to output */
-    for(band=0; band<hyrbidBands; band++)
-        for ( t=0; t<nTimeSlots; t++)
-            for( ch=0; ch < nCH; ch++)
-                outTF[band*nTimeSlots*nCH + t*nCH + ch] = cmplxf(FrameTF[t][ch].re[band], FrameTF[t][ch].im[band]);
+    hopSize = 128;
+    nTimeSlots = (ir_len+ir_pad)/hopSize;
+    
+    /* allocate memory */
+    afSTFTinit(&hSTFT, hopSize, nCH, 1, 0, 1);
+    FrameTF = (complexVector*)malloc1d(nCH*sizeof(complexVector));
+    for(nm=0; nm<nCH; nm++){
+        FrameTF[nm].re = (float*)calloc1d(hopSize+5, sizeof(float));
+        FrameTF[nm].im = (float*)calloc1d(hopSize+5, sizeof(float));
+    }
+    tempHopFrameTD = (float**)malloc2d(nCH, hopSize, sizeof(float));
+    ir = calloc1d( (ir_len+ir_pad) * nCH, sizeof(float));
+    irFB = malloc1d(nBands*nCH*nTimeSlots*sizeof(float_complex));
+    
+    for(nd=first; nd<last; nd++){
+        for(j=0; j<ir_len; j++)
+            for(i=0; i<nCH; i++)
+                ir[j*nCH+i] = hIR[nd*nCH*ir_len + i*ir_len + j];
+        afAnalyse(hSTFT, FrameTF, tempHopFrameTD, ir, ir_len+ir_pad, nCH, irFB);
+        for(nm=0; nm<nCH; nm++){
+            for(i=0; i<nBands; i++){
+                /* energy, and cross-spectrum with the centre impulse (with the real and imaginary parts accumulated
+                 * separately, so that these loops may be vectorised) */
+                x = &irFB[i*nTimeSlots*nCH + nm]; /* out_nBands x nTimeslots x nCH */
+                c = &centerImpulseFB[i*nTimeSlots];
+                irFB_energy = cross_re = cross_im = 0.0f;
+                for(t=0; t<nTimeSlots; t++){
+                    irFB_energy += crealf(x[t*nCH])*crealf(x[t*nCH]) + cimagf(x[t*nCH])*cimagf(x[t*nCH]);
+                    cross_re += crealf(x[t*nCH])*crealf(c[t]) + cimagf(x[t*nCH])*cimagf(c[t]);
+                    cross_im += cimagf(x[t*nCH])*crealf(c[t]) - crealf(x[t*nCH])*cimagf(c[t]);
+                }
+                irFB_gain = sqrtf(irFB_energy/MAX(centerImpulseFB_energy[i], 2.23e-8f));
+                
+                /* gain, with the phase of the cross-spectrum: exp(1i*angle(cross)) = cross/abs(cross) */
+                cross_abs = sqrtf(cross_re*cross_re + cross_im*cross_im);
+                if(cross_abs > 0.0f)
+                    hFB[i*nCH*N_dirs + nm*N_dirs + nd] = cmplxf(irFB_gain*cross_re/cross_abs, irFB_gain*cross_im/cross_abs);
+                else
+                    hFB[i*nCH*N_dirs + nm*N_dirs + nd] = cmplxf(irFB_gain, 0.0f);
+            }
+        }
+    }
     
     /* clean-up */
     afSTFTfree(hSTFT);
-    for (t = 0; t<nTimeSlots; t++) {
-        for(ch=0; ch< nCH; ch++) {
-            free(FrameTF[t][ch].re);
-            free(FrameTF[t][ch].im);
-        }
+    for(nm=0; nm<nCH; nm++){
+        free(FrameTF[nm].re);
+        free(FrameTF[nm].im);
     }
     free(FrameTF);
     free(tempHopFrameTD);
-    
+    free(ir);
+    free(irFB);
 }
 
 void FIRtoFilterbankCoeffs
@@ -132,12 +245,13 @@ void FIRtoFilterbankCoeffs
     float_complex* hFB /* nBands x nCH x N_dirs */
 )
 {
-    int i, j, t, nd, nm, nTimeSlots, ir_pad, hopSize;
+    int i, j, t, n, nChunks, nTimeSlots, ir_pad, hopSize;
     int* maxIdx;
-    float maxVal, idxDel, irFB_energy, irFB_gain, phase;
-    float* centerImpulse, *centerImpulseFB_energy, *ir;
-    float_complex cross;
-    float_complex* centerImpulseFB, *irFB;
+    float maxVal, idxDel;
+    float* centerImpulse, *centerImpulseFB_energy, *tempHopFrameTD;
+    float_complex* centerImpulseFB;
+    complexVector FrameTF;
+    void* hSTFT;
     
     ir_pad = 1024;//+512;
     hopSize = 128;
@@ -165,41 +279,35 @@ void FIRtoFilterbankCoeffs
     centerImpulse[(int)idxDel] = 1.0f;
     
     /* analyse impulse with the filterbank */
-    centerImpulseFB = malloc1d(nBands*nTimeSlots*nCH*sizeof(float_complex));
-    afAnalyse(centerImpulse, ir_len+ir_pad, 1, centerImpulseFB);
+    afSTFTinit(&hSTFT, hopSize, 1, 1, 0, 1);
+    FrameTF.re = (float*)calloc1d(hopSize+5, sizeof(float));
+    FrameTF.im = (float*)calloc1d(hopSize+5, sizeof(float));
+    tempHopFrameTD = (float*)malloc1d(hopSize*sizeof(float));
+    centerImpulseFB = malloc1d(nBands*nTimeSlots*sizeof(float_complex));
+    afAnalyse(hSTFT, &FrameTF, &tempHopFrameTD, centerImpulse, ir_len+ir_pad, 1, centerImpulseFB);
     centerImpulseFB_energy = calloc1d(nBands, sizeof(float));
     for(i=0; i<nBands; i++)
         for(t=0; t<nTimeSlots; t++)
-            centerImpulseFB_energy[i] += powf(cabsf(centerImpulseFB[i*nTimeSlots + t]), 2.0f);
+            centerImpulseFB_energy[i] += crealf(centerImpulseFB[i*nTimeSlots + t])*crealf(centerImpulseFB[i*nTimeSlots + t]) +
+                                         cimagf(centerImpulseFB[i*nTimeSlots + t])*cimagf(centerImpulseFB[i*nTimeSlots + t]);
     
-    /* initialise FB coefficients */
-    ir = calloc1d( (ir_len+ir_pad) * nCH, sizeof(float));
-    irFB = malloc1d(nBands*nCH*nTimeSlots*sizeof(float_complex));
-    for(nd=0; nd<N_dirs; nd++){
-        for(j=0; j<ir_len; j++)
-            for(i=0; i<nCH; i++)
-                ir[j*nCH+i] = hIR[nd*nCH*ir_len + i*ir_len + j];
-        afAnalyse(ir, ir_len+ir_pad, nCH, irFB);
-        for(nm=0; nm<nCH; nm++){
-            for(i=0; i<nBands; i++){
-                irFB_energy = 0;
-                for(t=0; t<nTimeSlots; t++)
-                    irFB_energy += powf(cabsf(irFB[i*nTimeSlots*nCH + t*nCH + nm]), 2.0f); /* out_nBands x nTimeslots x nCH */
-                irFB_gain = sqrtf(irFB_energy/MAX(centerImpulseFB_energy[i], 2.23e-8f));
-                cross = cmplxf(0.0f,0.0f);
-                for(t=0; t<nTimeSlots; t++)
-                    cross = ccaddf(cross, ccmulf(irFB[i*nTimeSlots*nCH + t*nCH + nm], conjf(centerImpulseFB[i*nTimeSlots + t])));
-                phase = atan2f(cimagf(cross), crealf(cross));
-                hFB[i*nCH*N_dirs + nm*N_dirs + nd] = crmulf( cexpf(cmplxf(0.0f, phase)), irFB_gain);
-            }
-        }
-    }
+    /* compute the FB coefficients. The directions are split into chunks, which are converted in parallel if
+     * OpenMP is enabled (the result does not depend on the number of threads used) */
+    nChunks = (N_dirs + FIR2FB_CHUNK_SIZE - 1)/FIR2FB_CHUNK_SIZE;
+#ifdef _OPENMP
+#   pragma omp parallel for schedule(dynamic) if(nChunks > 1)
+#endif
+    for(n=0; n<nChunks; n++)
+        FIRtoFilterbankCoeffs_chunk(hIR, n*FIR2FB_CHUNK_SIZE, MIN((n+1)*FIR2FB_CHUNK_SIZE, N_dirs), N_dirs, nCH, ir_len,
+                                    ir_pad, nBands, centerImpulseFB, centerImpulseFB_energy, hFB);
     
     /* clean-up */
+    afSTFTfree(hSTFT);
+    free(FrameTF.re);
+    free(FrameTF.im);
+    free(tempHopFrameTD);
     free(maxIdx);
     free(centerImpulse);
     free(centerImpulseFB_energy);
     free(centerImpulseFB);
-    free(ir);
-    free(irFB);
 } 
@@ -46,6 +46,9 @@ extern "C" {
 #ifndef NUM_EARS
 # define NUM_EARS 2
 #endif
+/* number of directions converted per chunk by FIRtoFilterbankCoeffs (chunks
+ * may be converted in parallel, if the framework is compiled with OpenMP) */
+#define FIR2FB_CHUNK_SIZE ( 16 )
     
 /* ========================================================================== */
 /*                             Internal Functions                             */
@@ -54,7 +57,9 @@ extern "C" {
 /*
  * Function: cxcorr
  * ----------------
- * Calculates the cross correlation between two vectors
+ * Calculates the cross correlation between two vectors (via the FFT), where
+ * element (lb-1+lag) is the sum over n of a(n+lag)*b(n), for lags -(lb-1) to
+ * (la-1)
  *
  * Input Arguments:
  *     a    - vector a; la x 1
@@ -70,12 +75,42 @@ void cxcorr(float* a,
             size_t la,
             size_t lb);
 
+/*
+ * Function: cxcorrBatch
+ * ---------------------
+ * Calculates the cross correlations between many pairs of vectors (of equal
+ * length), returning only the lags within +/- maxLag. The FFT, and the buffers
+ * used to compute the cross correlations, are shared by all pairs.
+ * The output for each pair is equal to elements (len-1-maxLag) to
+ * (len-1+maxLag) of the output of "cxcorr" (zeros beyond +/-(len-1) lags)
+ *
+ * Input Arguments:
+ *     a      - vectors a; FLAT: nPairs x len
+ *     b      - vectors b; FLAT: nPairs x len
+ *     nPairs - number of pairs of vectors
+ *     len    - length of the vectors
+ *     maxLag - largest lag to return
+ * Output Arguments:
+ *     x_ab   - cross-correlations between a and b, for lags -maxLag to maxLag;
+ *              FLAT: nPairs x (2*maxLag + 1)
+ */
+void cxcorrBatch(/* Input Arguments */
+                 float* a,
+                 float* b,
+                 int nPairs,
+                 int len,
+                 int maxLag,
+                 /* Output Arguments */
+                 float* x_ab);
+
 /*
  * Function: FIRtoFilterbankCoeffs
  * -------------------------------
  * Converts and FIR filter into Filterbank Coefficients
  * Note: This is currently hard coded for a 128 hop size with hybrid mode
  * enabled (see afSTFTlib)
+ * Further note: the directions are converted in chunks of FIR2FB_CHUNK_SIZE,
+ * in parallel if compiled with OpenMP
  *
  * Input Arguments:
  *     hIR     - time-domain FIR; FLAT: N_dirs x nCH x ir_len
@@ -96,6 +131,38 @@ void FIRtoFilterbankCoeffs(/* Input Arguments */
                            /* Output Arguments */
                            float_complex* hFB);
 
+/*
+ * Function: hrtfCache_mapFileReadOnly
+ * ------------------------------------
+ * Maps a whole file into memory, read-only (mmap on POSIX systems, and a file
+ * mapping on Windows). Pages are only read from disk when first touched.
+ *
+ * Input Arguments:
+ *     path   - path to the file
+ * Output Arguments:
+ *     phMap  - & address of the mapping handle (pass to "hrtfCache_unmapFile")
+ *     data   - & start of the mapped file
+ *     nBytes - & size of the file, in bytes
+ * Returns:
+ *     1: success, 0: the file could not be opened, is empty, or mapping failed
+ */
+int hrtfCache_mapFileReadOnly(/* Input Arguments */
+                              const char* path,
+                              /* Output Arguments */
+                              void** const phMap,
+                              const void** data,
+                              size_t* nBytes);
+
+/*
+ * Function: hrtfCache_unmapFile
+ * ------------------------------
+ * Unmaps a file mapped by "hrtfCache_mapFileReadOnly"
+ *
+ * Input Arguments:
+ *     phMap - & address of the mapping handle
+ */
+void hrtfCache_unmapFile(void** const phMap);
+
 
 #ifdef __cplusplus
 } /* extern "C" */
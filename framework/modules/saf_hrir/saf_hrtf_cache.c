@@ -0,0 +1,368 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Filename: saf_hrtf_cache.c
+ * --------------------------
+ * A simple on-disk cache for processed HRTF data (filterbank coefficients,
+ * ITDs, interpolation tables, decoding matrices etc.), which is keyed by a hash
+ * of everything the data was computed from (including the full contents of the
+ * HRIR data or file). Each entry is a single file, which is memory mapped when
+ * it is read.
+ *
+ * File layout (little-endian):
+ *     header      - see "hrtfCache_header"; 64 bytes
+ *     block table - offset and size of each block; nBlocks x 16 bytes
+ *     blocks      - the data, each starting at a 64 byte aligned offset
+ * The checksum covers everything after the header, and is verified whenever an
+ * entry is opened.
+ *
+ * Dependencies:
+ *     saf_utilities
+ * Author, date created:
+ *     agent, 18.10.2026
+ */
+
+#include "saf_hrir.h"
+#include "saf_hrir_internal.h"
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+# include <windows.h>
+#else
+# include <sys/mman.h>
+# include <fcntl.h>
+# include <unistd.h>
+#endif
+
+#define HRTF_CACHE_MAGIC "SAFHRTFC"
+#define HRTF_CACHE_BYTE_ORDER_MARK ( 0x01020304u )
+#define HRTF_CACHE_ALIGNMENT ( 64 )
+#define HRTF_CACHE_MAX_PATH_LENGTH ( 4096 )
+
+typedef struct _hrtfCache_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrderMark;
+    uint64_t key;
+    uint64_t checksum;
+    uint64_t fileSize;
+    uint32_t nBlocks;
+    uint8_t reserved[20];
+
+}hrtfCache_header;
+
+typedef struct _hrtfCache_data {
+    void* hMap;              /* mapping of the whole file */
+    const uint8_t* data;     /* start of the mapped file */
+    const uint64_t* table;   /* offset and size of each block; FLAT: nBlocks x 2 */
+    int nBlocks;
+
+}hrtfCache_data;
+
+/* returns the path of the cache file for "key" */
+static int hrtfCache_getPath(const char* cacheDir, uint64_t key, const char* suffix, char* path)
+{
+    int len;
+
+    len = snprintf(path, HRTF_CACHE_MAX_PATH_LENGTH, "%s/%08x%08x.safcache%s", cacheDir,
+                   (unsigned)(key >> 32), (unsigned)(key & 0xFFFFFFFFu), suffix);
+    return len > 0 && len < HRTF_CACHE_MAX_PATH_LENGTH;
+}
+
+/* the cache files are little-endian; on other hosts the cache is simply never used */
+static int hrtfCache_isLittleEndian(void)
+{
+    const uint32_t one = 1;
+    return *((const uint8_t*)&one) == 1;
+}
+
+int hrtfCache_mapFileReadOnly
+(
+    const char* path,
+    void** const phMap,
+    const void** data,
+    size_t* nBytes
+)
+{
+#ifdef _WIN32
+    HANDLE file, mapping;
+    LARGE_INTEGER size;
+    void* view;
+
+    (*phMap) = NULL;
+    file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if(file == INVALID_HANDLE_VALUE)
+        return 0;
+    if(!GetFileSizeEx(file, &size) || size.QuadPart == 0 || (uint64_t)size.QuadPart > (uint64_t)SIZE_MAX){
+        CloseHandle(file);
+        return 0;
+    }
+    mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file); /* the mapping keeps its own reference to the file */
+    if(mapping == NULL)
+        return 0;
+    view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if(view == NULL)
+        return 0;
+    (*phMap) = view;
+    (*data) = (const void*)view;
+    (*nBytes) = (size_t)size.QuadPart;
+    return 1;
+#else
+    int fd;
+    struct stat st;
+    void* view;
+    size_t* map;
+
+    (*phMap) = NULL;
+    if((fd = open(path, O_RDONLY)) < 0)
+        return 0;
+    if(fstat(fd, &st) != 0 || st.st_size <= 0){
+        close(fd);
+        return 0;
+    }
+    view = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); /* the mapping remains valid after the descriptor is closed */
+    if(view == MAP_FAILED)
+        return 0;
+    /* munmap() also needs the length, so it is kept alongside the address */
+    map = (size_t*)malloc1d(2*sizeof(size_t));
+    map[0] = (size_t)view;
+    map[1] = (size_t)st.st_size;
+    (*phMap) = (void*)map;
+    (*data) = (const void*)view;
+    (*nBytes) = (size_t)st.st_size;
+    return 1;
+#endif
+}
+
+void hrtfCache_unmapFile
+(
+    void** const phMap
+)
+{
+    if((*phMap) == NULL)
+        return;
+#ifdef _WIN32
+    UnmapViewOfFile(*phMap);
+#else
+    munmap((void*)((size_t*)(*phMap))[0], ((size_t*)(*phMap))[1]);
+    free(*phMap);
+#endif
+    (*phMap) = NULL;
+}
+
+uint64_t hrtfCache_hash
+(
+    uint64_t hash,
+    const void* data,
+    size_t nBytes
+)
+{
+    const uint8_t* bytes = (const uint8_t*)data;
+    size_t i;
+
+    /* 64-bit FNV-1a */
+    for(i=0; i<nBytes; i++){
+        hash ^= (uint64_t)bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+uint64_t hrtfCache_hashFile
+(
+    uint64_t hash,
+    const char* path
+)
+{
+    void* hMap;
+    const void* data;
+    size_t nBytes;
+    uint64_t size;
+
+    if(path==NULL || !hrtfCache_mapFileReadOnly(path, &hMap, &data, &nBytes))
+        return 0;
+    size = (uint64_t)nBytes;
+    hash = hrtfCache_hash(hash, &size, sizeof(uint64_t));
+    hash = hrtfCache_hash(hash, data, nBytes);
+    hrtfCache_unmapFile(&hMap);
+    return hash;
+}
+
+int hrtfCache_open
+(
+    void** const phCache,
+    const char* cacheDir,
+    uint64_t key
+)
+{
+    hrtfCache_data* h;
+    char path[HRTF_CACHE_MAX_PATH_LENGTH];
+    const hrtfCache_header* header;
+    void* hMap;
+    const uint8_t* data;
+    size_t fileSize;
+    uint64_t tableSize;
+    int i;
+
+    (*phCache) = NULL;
+    if(cacheDir==NULL || key==0 || !hrtfCache_isLittleEndian() || !hrtfCache_getPath(cacheDir, key, "", path))
+        return 0;
+    if(!hrtfCache_mapFileReadOnly(path, &hMap, (const void**)&data, &fileSize))
+        return 0; /* not cached (yet) */
+
+    /* a file which is truncated, from a different version, or otherwise corrupt is treated as a miss. The checksum is
+     * always verified, so that an entry which has been corrupted on disk is never used */
+    header = (const hrtfCache_header*)data;
+    tableSize = fileSize >= sizeof(hrtfCache_header) ? (uint64_t)header->nBlocks*2*sizeof(uint64_t) : 0;
+    if(fileSize < sizeof(hrtfCache_header) || memcmp(header->magic, HRTF_CACHE_MAGIC, 8)!=0 ||
+       header->version != SAF_HRTF_CACHE_VERSION || header->byteOrderMark != HRTF_CACHE_BYTE_ORDER_MARK ||
+       header->key != key || header->fileSize != (uint64_t)fileSize ||
+       tableSize > (uint64_t)fileSize - sizeof(hrtfCache_header) ||
+       hrtfCache_hash(SAF_HRTF_CACHE_HASH_SEED, data + sizeof(hrtfCache_header),
+                      fileSize - sizeof(hrtfCache_header)) != header->checksum){
+        hrtfCache_unmapFile(&hMap);
+        return 0;
+    }
+    h = (hrtfCache_data*)malloc1d(sizeof(hrtfCache_data));
+    h->hMap = hMap;
+    h->data = data;
+    h->table = (const uint64_t*)(data + sizeof(hrtfCache_header));
+    h->nBlocks = (int)header->nBlocks;
+    for(i=0; i<h->nBlocks; i++){
+        if(h->table[i*2] > (uint64_t)fileSize || h->table[i*2+1] > (uint64_t)fileSize - h->table[i*2]){
+            hrtfCache_close((void**)&h);
+            return 0;
+        }
+    }
+    (*phCache) = (void*)h;
+    return 1;
+}
+
+const void* hrtfCache_getBlock
+(
+    void* const hCache,
+    int blockIdx,
+    size_t* nBytes
+)
+{
+    hrtfCache_data *h = (hrtfCache_data*)(hCache);
+
+    if(blockIdx<0 || blockIdx>=h->nBlocks){
+        (*nBytes) = 0;
+        return NULL;
+    }
+    (*nBytes) = (size_t)h->table[blockIdx*2+1];
+    return h->data + h->table[blockIdx*2];
+}
+
+void hrtfCache_close
+(
+    void** const phCache
+)
+{
+    hrtfCache_data *h = (hrtfCache_data*)(*phCache);
+
+    if (h != NULL) {
+        hrtfCache_unmapFile(&(h->hMap));
+        free(h);
+        h = NULL;
+        *phCache = NULL;
+    }
+}
+
+int hrtfCache_save
+(
+    const char* cacheDir,
+    uint64_t key,
+    int nBlocks,
+    const void** blocks,
+    const size_t* nBytes
+)
+{
+    FILE* file;
+    char path[HRTF_CACHE_MAX_PATH_LENGTH], tmpPath[HRTF_CACHE_MAX_PATH_LENGTH], tmpSuffix[64];
+    hrtfCache_header header;
+    uint64_t offset, checksum;
+    uint64_t* table;
+    const uint8_t zeros[HRTF_CACHE_ALIGNMENT] = {0};
+    int i, ok;
+
+    /* the temporary file is unique to this process and thread (the address of a local variable differs between the
+     * threads of a process), so that concurrent writers of the same entry do not write over each other's file */
+#ifdef _WIN32
+    snprintf(tmpSuffix, sizeof(tmpSuffix), ".tmp%lu_%llx", (unsigned long)GetCurrentProcessId(),
+             (unsigned long long)(size_t)&header);
+#else
+    snprintf(tmpSuffix, sizeof(tmpSuffix), ".tmp%lu_%llx", (unsigned long)getpid(), (unsigned long long)(size_t)&header);
+#endif
+    if(cacheDir==NULL || key==0 || !hrtfCache_isLittleEndian() ||
+       !hrtfCache_getPath(cacheDir, key, "", path) || !hrtfCache_getPath(cacheDir, key, tmpSuffix, tmpPath))
+        return 0;
+
+    /* block table (each block is aligned, so that it may be used directly from the mapped file) */
+    table = malloc1d(nBlocks*2*sizeof(uint64_t));
+    offset = sizeof(hrtfCache_header) + nBlocks*2*sizeof(uint64_t);
+    for(i=0; i<nBlocks; i++){
+        offset = (offset + HRTF_CACHE_ALIGNMENT-1) / HRTF_CACHE_ALIGNMENT * HRTF_CACHE_ALIGNMENT;
+        table[i*2] = offset;
+        table[i*2+1] = (uint64_t)nBytes[i];
+        offset += nBytes[i];
+    }
+
+    /* the checksum covers the table, the padding, and the blocks, in file order */
+    checksum = hrtfCache_hash(SAF_HRTF_CACHE_HASH_SEED, table, nBlocks*2*sizeof(uint64_t));
+    offset = sizeof(hrtfCache_header) + nBlocks*2*sizeof(uint64_t);
+    for(i=0; i<nBlocks; i++){
+        checksum = hrtfCache_hash(checksum, zeros, (size_t)(table[i*2] - offset));
+        checksum = hrtfCache_hash(checksum, blocks[i], nBytes[i]);
+        offset = table[i*2] + nBytes[i];
+    }
+    memset(&header, 0, sizeof(hrtfCache_header));
+    memcpy(header.magic, HRTF_CACHE_MAGIC, 8);
+    header.version = SAF_HRTF_CACHE_VERSION;
+    header.byteOrderMark = HRTF_CACHE_BYTE_ORDER_MARK;
+    header.key = key;
+    header.checksum = checksum;
+    header.fileSize = offset;
+    header.nBlocks = (uint32_t)nBlocks;
+
+    /* written to a temporary file first, and then renamed, so that a partially written entry is never read */
+    ok = 0;
+    if((file = fopen(tmpPath, "wb")) != NULL){
+        ok = fwrite(&header, sizeof(hrtfCache_header), 1, file) == 1;
+        ok = ok && fwrite(table, sizeof(uint64_t), nBlocks*2, file) == (size_t)(nBlocks*2);
+        offset = sizeof(hrtfCache_header) + nBlocks*2*sizeof(uint64_t);
+        for(i=0; i<nBlocks && ok; i++){
+            ok = fwrite(zeros, 1, (size_t)(table[i*2] - offset), file) == (size_t)(table[i*2] - offset);
+            ok = ok && fwrite(blocks[i], 1, nBytes[i], file) == nBytes[i];
+            offset = table[i*2] + nBytes[i];
+        }
+        ok = (fclose(file) == 0) && ok;
+        if(ok){
+            remove(path);
+            ok = rename(tmpPath, path) == 0;
+        }
+        if(!ok)
+            remove(tmpPath);
+    }
+
+    free(table);
+    return ok;
+}
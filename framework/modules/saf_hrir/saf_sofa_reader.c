@@ -29,9 +29,31 @@
 #include "saf_hrir.h"
 
 #ifdef SAF_ENABLE_SOFA_READER
-# ifndef MAX_SOFA_HRIR_LENGTH
-#  define MAX_SOFA_HRIR_LENGTH 1024 /* truncates HRIRs to this length */
-# endif
+/* number of measurements read from the SOFA file at a time */
+# define SOFA_READ_CHUNK_SIZE ( 256 )
+#endif
+
+/* converts the azimuths to -180..180, if they are 0..360 */
+static void convertAzimuthsTo180(float* hrir_dirs_deg, int N_hrir_dirs)
+{
+    int i, is0_360;
+    
+    is0_360 = 0;
+    for(i=0; i<N_hrir_dirs; i++)
+        if(hrir_dirs_deg[2*i+0]>=181.0f)
+            is0_360 = 1;
+    if(is0_360)
+        for(i=0; i<N_hrir_dirs; i++)
+            hrir_dirs_deg[2*i+0] = hrir_dirs_deg[2*i+0]>180.0f ? hrir_dirs_deg[2*i+0] -360.0f : hrir_dirs_deg[2*i+0];
+}
+
+/* clamps the requested measurement range to the number of measurements available */
+static void clampMeasurementRange(int nAvailable, int* firstMeasurement, int* nMeasurements)
+{
+    (*firstMeasurement) = MIN(MAX((*firstMeasurement), 0), nAvailable);
+    if((*nMeasurements)<=0 || (*nMeasurements) > nAvailable-(*firstMeasurement))
+        (*nMeasurements) = nAvailable-(*firstMeasurement);
+}
 
 void loadSofaFile
 (
@@ -43,140 +65,180 @@ void loadSofaFile
     int* hrir_fs
 )
 {
-    int i, j, k, retval,dimid[6], *dimids, ndimsp,ncid, varid, is0_360;
-    size_t dimlength[6], IR_dims[3], SourcePosition_dims[2];
-    size_t hrir_dims[3], hrir_pos_dims[2];
-    char dimname[6];
+    loadSofaFileSubset(sofa_filepath, 0, 0, hrirs, hrir_dirs_deg, N_hrir_dirs, hrir_len, hrir_fs);
+}
+
+void loadSofaFileSubset
+(
+    char* sofa_filepath,
+    int firstMeasurement,
+    int nMeasurements,
+    float** hrirs,
+    float** hrir_dirs_deg,
+    int* N_hrir_dirs,
+    int* hrir_len,
+    int* hrir_fs
+)
+{
+    int i, j, k;
+    void* hHRIRfile;
+    const float* file_hrirs, *file_dirs_deg;
+    int file_N_dirs, file_hrir_len;
+#ifdef SAF_ENABLE_SOFA_READER
+    int retval, ndims, ncid, varid;
+    int* dimids;
+    size_t* IR_dims;
+    size_t start[3], count[3];
     const char* errorMessage;
-    double* IR, *SourcePosition, IR_fs;
+    double IR_fs;
+#endif
     
     /* free any existing memory */
     free1d((void**)&(*hrirs));
     free1d((void**)&(*hrir_dirs_deg));
     
+    /* .safhrir files (see "hrirFile_open") are read directly, bypassing netcdf */
+    if(sofa_filepath!=NULL && hrirFile_open(&hHRIRfile, sofa_filepath)){
+        hrirFile_getData(hHRIRfile, &file_hrirs, &file_dirs_deg, &file_N_dirs, &file_hrir_len, hrir_fs);
+        clampMeasurementRange(file_N_dirs, &firstMeasurement, &nMeasurements);
+        file_hrirs += (size_t)firstMeasurement * 2 * file_hrir_len;
+        file_dirs_deg += (size_t)firstMeasurement * 2;
+        (*N_hrir_dirs) = nMeasurements;
+        (*hrir_len) = MIN(file_hrir_len, MAX_SOFA_HRIR_LENGTH);
+        (*hrirs) = malloc1d((*N_hrir_dirs) * 2 * (*hrir_len)*sizeof(float));
+        for(i=0; i<(*N_hrir_dirs)*2; i++)
+            memcpy(&(*hrirs)[i*(*hrir_len)], &file_hrirs[i*file_hrir_len], (*hrir_len)*sizeof(float));
+        (*hrir_dirs_deg) = malloc1d((*N_hrir_dirs) * 2 * sizeof(float));
+        memcpy((*hrir_dirs_deg), file_dirs_deg, (*N_hrir_dirs) * 2 * sizeof(float));
+        hrirFile_close(&hHRIRfile);
+        convertAzimuthsTo180((*hrir_dirs_deg), (*N_hrir_dirs));
+        return;
+    }
+    
+#ifdef SAF_ENABLE_SOFA_READER
     /* open sofa file */
     /* (returns error value if sofa_filepath==NULL (intentional), or if the file
      * path/name was not found (unintentional). */
     if ((retval = nc_open(sofa_filepath, NC_NOWRITE, &ncid)))
         errorMessage = nc_strerror(retval);
+    if(retval==NC_NOERR){
+        /* Dimensions of the IR data: measurements x receivers x samples */
+        ndims = 0;
+        if ((retval = nc_inq_varid(ncid, "Data.IR", &varid)))
+            errorMessage = nc_strerror(retval);
+        if ((retval = nc_inq_varndims(ncid, varid, &ndims)))
+            errorMessage = nc_strerror(retval);
+        dimids = malloc1d(MAX(ndims,1)*sizeof(int));
+        IR_dims = calloc1d(MAX(ndims,3), sizeof(size_t));
+        if ((retval = nc_inq_vardimid(ncid, varid, dimids)))
+            errorMessage = nc_strerror(retval);
+        for(i=0; i<ndims; i++)
+            if ((retval = nc_inq_dimlen(ncid, dimids[i], &IR_dims[i])))
+                errorMessage = nc_strerror(retval);
+        free(dimids);
     
-    /* if error: */
-    if(retval!=NC_NOERR){
-        is0_360 = 0;
-        /* return default HRIR data */
-        (*N_hrir_dirs) = __default_N_hrir_dirs;
-        (*hrir_len) = __default_hrir_len;
-        (*hrir_fs) = __default_hrir_fs;
-        (*hrirs) = malloc1d((*N_hrir_dirs) * 2 * (*hrir_len)*sizeof(float));
-        for(i=0; i<(*N_hrir_dirs); i++)
-            for(j=0; j<2; j++)
-                for(k=0; k< (*hrir_len); k++)
-                    (*hrirs)[i*2*(*hrir_len) + j*(*hrir_len) + k] = (float)__default_hrirs[i][j][k];
-        (*hrir_dirs_deg) = malloc1d((*N_hrir_dirs) * 2 * sizeof(float));
-        for(i=0; i<(*N_hrir_dirs); i++){
-            for(j=0; j<2; j++)
-                (*hrir_dirs_deg)[i*2+j] = (float)__default_hrir_dirs_deg[i][j];
-            if((*hrir_dirs_deg)[2*i+0]>=181.0f)
-                is0_360 = 1;
-        }
-        /* convert to -180..180, if azi is 0..360 */
-        if(is0_360)
-            for(i=0; i<(*N_hrir_dirs); i++)
-                (*hrir_dirs_deg)[2*i+0] = (*hrir_dirs_deg)[2*i+0]>180.0f ? (*hrir_dirs_deg)[2*i+0] -360.0f : (*hrir_dirs_deg)[2*i+0];
-        
+        /* Only 2-receiver HRIR/BRIR sets are supported (i.e. not multi-emitter
+         * data, such as "MultiSpeakerBRIR": measurements x receivers x
+         * emitters x samples) */
+        if(ndims!=3 || IR_dims[1]!=2){
+            free(IR_dims);
+            nc_close(ncid);
 #ifndef NDEBUG
-        /* also output warning message, if encountering this error value was
-         * unintentional (i.e. sofa_filepath!=NULL) */
-        if(sofa_filepath!=NULL)
-            saf_error_print(SAF_WARNING__SOFA_FILE_NOT_FOUND);
+            saf_error_print(SAF_WARNING__SOFA_FILE_NOT_SUPPORTED);
 #endif
-        return;
-    }
- 
-    /* Determine dimension IDs and lengths */
-    /* Note: there are 6 possible dimension lengths in the sofa standard */
-    for (i=0; i<6; i++){
-        retval = nc_inq_dim(ncid, i, &dimname[i], &dimlength[i]);
-        errorMessage = nc_strerror(retval);
-        retval = nc_inq_dimid(ncid, &dimname[i], &dimid[i]);
-        errorMessage = nc_strerror(retval);
-    }
-    
-    /* Extract IR data */
-    if ((retval = nc_inq_varid(ncid, "Data.IR", &varid)))
-        errorMessage = nc_strerror(retval);
-    if ((retval =  nc_inq_varndims (ncid, varid, &ndimsp)))
-        errorMessage = nc_strerror(retval);
-    dimids = malloc1d(ndimsp*sizeof(int));
-    if ((retval = nc_inq_vardimid(ncid, varid, dimids)))
-        errorMessage = nc_strerror(retval);
-    for(i=0; i<3; i++)
-        IR_dims[i] = dimlength[dimid[dimids[i]]];
-    free(dimids);
-    IR = malloc1d(IR_dims[0]*IR_dims[1]*IR_dims[2]*sizeof(double));
-    if ((retval = nc_get_var(ncid, varid, IR)))
-        errorMessage = nc_strerror(retval);
-    if ((retval = nc_inq_varid(ncid, "Data.SamplingRate", &varid)))
-        errorMessage = nc_strerror(retval);
-    if ((retval = nc_get_var(ncid, varid, &IR_fs)))
-        errorMessage = nc_strerror(retval);
-    
-    /* Extract positional data */
-    if ((retval = nc_inq_varid(ncid, "SourcePosition", &varid)))
-        errorMessage = nc_strerror(retval);
-    if ((retval =  nc_inq_varndims (ncid, varid, &ndimsp)))
-        errorMessage = nc_strerror(retval);
-    dimids = malloc1d(ndimsp*sizeof(int));
-    if ((retval = nc_inq_vardimid(ncid, varid, dimids)))
-        errorMessage = nc_strerror(retval);
-    for(i=0; i<2; i++)
-        SourcePosition_dims[i] = dimlength[dimid[dimids[i]]];
-    free(dimids);
-    SourcePosition = malloc1d(SourcePosition_dims[0]*SourcePosition_dims[1]*sizeof(double));
-    if ((retval = nc_get_var(ncid, varid, SourcePosition)))
-        errorMessage = nc_strerror(retval);
+            sofa_filepath = NULL; /* (already warned) */
+        }
+        else{
+            /* Allocate sufficient memory */
+            clampMeasurementRange((int)IR_dims[0], &firstMeasurement, &nMeasurements);
+            (*hrir_len) = MIN((int)IR_dims[2], MAX_SOFA_HRIR_LENGTH); /* truncate the HRIR length (1024 should be plenty) */
+            (*N_hrir_dirs) = nMeasurements;
+            (*hrirs) = malloc1d((*N_hrir_dirs)*IR_dims[1]*(*hrir_len) *sizeof(float));
+            (*hrir_dirs_deg) = malloc1d((*N_hrir_dirs)*2*sizeof(float));
     
-    /* Close the file, freeing all resources. */
-    if ((retval = nc_close(ncid)))
-        errorMessage = nc_strerror(retval);
+            /* Extract IR data; only the first hrir_len taps of each IR of the
+             * requested measurements are read, in chunks of measurements, and
+             * are converted to single precision by netcdf directly into the
+             * output (i.e. no intermediate copy of Data.IR) */
+            start[1] = start[2] = 0;
+            count[1] = IR_dims[1];
+            count[2] = (size_t)(*hrir_len);
+            for(i=0; i<(*N_hrir_dirs); i+=(int)count[0]){
+                start[0] = (size_t)(firstMeasurement + i);
+                count[0] = MIN((size_t)((*N_hrir_dirs)-i), SOFA_READ_CHUNK_SIZE);
+                if ((retval = nc_get_vara_float(ncid, varid, start, count, &(*hrirs)[(size_t)i*IR_dims[1]*(*hrir_len)])))
+                    errorMessage = nc_strerror(retval);
+            }
+            free(IR_dims);
+            if ((retval = nc_inq_varid(ncid, "Data.SamplingRate", &varid)))
+                errorMessage = nc_strerror(retval);
+            if ((retval = nc_get_var_double(ncid, varid, &IR_fs)))
+                errorMessage = nc_strerror(retval);
+            (*hrir_fs) = (int)(IR_fs+0.5);
     
-    /* Allocate sufficient memory */
-    (*hrir_len) = MIN((int)IR_dims[2], MAX_SOFA_HRIR_LENGTH); /* truncate the HRIR length (1024 should be plenty) */
-    (*hrirs) = malloc1d(IR_dims[0]*IR_dims[1]*(*hrir_len) *sizeof(float));
-    (*hrir_dirs_deg) = malloc1d(SourcePosition_dims[0]*2*sizeof(float));
+            /* Extract positional data; only the azimuth and elevation columns are needed */
+            if ((retval = nc_inq_varid(ncid, "SourcePosition", &varid)))
+                errorMessage = nc_strerror(retval);
+            start[0] = (size_t)firstMeasurement;
+            start[1] = 0;
+            count[0] = (size_t)(*N_hrir_dirs);
+            count[1] = 2;
+            if ((retval = nc_get_vara_float(ncid, varid, start, count, (*hrir_dirs_deg))))
+                errorMessage = nc_strerror(retval);
     
-    /* Store relevent info in handle */
-    (*hrir_fs) = (int)(IR_fs+0.5);
-    hrir_dims[0] = IR_dims[0];
-    hrir_dims[1] = IR_dims[1];
-    hrir_dims[2] = (size_t)(*hrir_len);
-    (*N_hrir_dirs) = (int)hrir_dims[0];
-    for(i=0; i<2; i++)
-        hrir_pos_dims[i] = SourcePosition_dims[i];
-    for(i=0; i<hrir_dims[0]; i++){
-        for(j=0; j<hrir_dims[1]; j++){
-            for(k=0; k<hrir_dims[2]; k++){
-                /* trunctate IRs and store in floating point precision */
-                (*hrirs)[i*hrir_dims[1]*hrir_dims[2] + j*hrir_dims[2] + k] = (float)IR[i*IR_dims[1]*IR_dims[2] + j*IR_dims[2] + k];
-            }
+            /* Close the file, freeing all resources. */
+            if ((retval = nc_close(ncid)))
+                errorMessage = nc_strerror(retval);
+            convertAzimuthsTo180((*hrir_dirs_deg), (*N_hrir_dirs));
+            return;
         }
     }
+#endif /* SAF_ENABLE_SOFA_READER */
     
-    /* store in floating point precision */
-    is0_360 = 0;
-    for(i=0; i<SourcePosition_dims[0]; i++){
-        (*hrir_dirs_deg)[2*i+0] = (float)SourcePosition[i*SourcePosition_dims[1]+0];
-        (*hrir_dirs_deg)[2*i+1] = (float)SourcePosition[i*SourcePosition_dims[1]+1];
-        if((*hrir_dirs_deg)[2*i+0]>=181.0f)
-            is0_360 = 1;
-    }
+    /* if the file could not be read (or sofa_filepath==NULL): return default HRIR data */
+    (*N_hrir_dirs) = __default_N_hrir_dirs;
+    (*hrir_len) = __default_hrir_len;
+    (*hrir_fs) = __default_hrir_fs;
+    (*hrirs) = malloc1d((*N_hrir_dirs) * 2 * (*hrir_len)*sizeof(float));
+    for(i=0; i<(*N_hrir_dirs); i++)
+        for(j=0; j<2; j++)
+            for(k=0; k< (*hrir_len); k++)
+                (*hrirs)[i*2*(*hrir_len) + j*(*hrir_len) + k] = (float)__default_hrirs[i][j][k];
+    (*hrir_dirs_deg) = malloc1d((*N_hrir_dirs) * 2 * sizeof(float));
+    for(i=0; i<(*N_hrir_dirs); i++)
+        for(j=0; j<2; j++)
+            (*hrir_dirs_deg)[i*2+j] = (float)__default_hrir_dirs_deg[i][j];
+    convertAzimuthsTo180((*hrir_dirs_deg), (*N_hrir_dirs));
     
-    /* convert to -180..180, if azi is 0..360 */
-    if(is0_360)
-        for(i=0; i<SourcePosition_dims[0]; i++)
-            (*hrir_dirs_deg)[2*i+0] = (*hrir_dirs_deg)[2*i+0]>180.0f ? (*hrir_dirs_deg)[2*i+0] -360.0f : (*hrir_dirs_deg)[2*i+0];
-            
-    free(IR);
-    free(SourcePosition);
+#ifndef NDEBUG
+    /* also output warning message, if encountering this error value was
+     * unintentional (i.e. sofa_filepath!=NULL) */
+    if(sofa_filepath!=NULL)
+        saf_error_print(SAF_WARNING__SOFA_FILE_NOT_FOUND);
+#endif
+}
+
+#ifdef SAF_ENABLE_SOFA_READER
+int convertSofaToHRIRfile
+(
+    char* sofa_filepath,
+    const char* hrir_filepath
+)
+{
+    int ncid, N_hrir_dirs, hrir_len, hrir_fs, ok;
+    float* hrirs, *hrir_dirs_deg;
+    
+    /* loadSofaFile() would silently return the default HRIR data instead, so
+     * first check that the SOFA file can actually be opened */
+    if(sofa_filepath==NULL || nc_open(sofa_filepath, NC_NOWRITE, &ncid)!=NC_NOERR)
+        return 0;
+    nc_close(ncid);
+    
+    hrirs = hrir_dirs_deg = NULL;
+    loadSofaFile(sofa_filepath, &hrirs, &hrir_dirs_deg, &N_hrir_dirs, &hrir_len, &hrir_fs);
+    ok = hrirFile_save(hrir_filepath, hrirs, hrir_dirs_deg, N_hrir_dirs, hrir_len, hrir_fs);
+    free(hrirs);
+    free(hrir_dirs_deg);
+    return ok;
 }
 #endif /* SAF_ENABLE_SOFA_READER */
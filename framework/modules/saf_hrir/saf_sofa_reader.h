@@ -20,7 +20,7 @@
  * A simple sofa reader, which returns only the bare minimum.
  *
  * Dependencies:
- *     netcdf
+ *     netcdf (only if SAF_ENABLE_SOFA_READER is defined)
  * Author, date created:
  *     Leo McCormack, 21.11.2017
  */
@@ -44,6 +44,10 @@
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
+
+#ifndef MAX_SOFA_HRIR_LENGTH
+# define MAX_SOFA_HRIR_LENGTH 1024 /* truncates HRIRs to this length */
+#endif
     
 /* ========================================================================== */
 /*                               Main Functions                               */
@@ -55,8 +59,15 @@ extern "C" {
  * Allocates memory and copies the values of the essential data contained in a
  * SOFA file to the output arguments.
  * Note: This function is not suitable for binaural room impulse responses
- * (BRIRs), as the IRs are truncated to "MAX_HRIR_LENGTH"
+ * (BRIRs), as the IRs are truncated to "MAX_HRIR_LENGTH" (only these taps are
+ * read from the file, a block of measurements at a time)
  * Further note: The hrirs are returned as NULL if the file does not exist.
+ * Also note: .safhrir files (see "hrirFile_open" and "convertSofaToHRIRfile")
+ * are also accepted, and are read directly without going through netcdf. This
+ * also holds if SAF_ENABLE_SOFA_READER is not defined, in which case any other
+ * file is treated as not found (i.e. the default HRIR data are returned).
+ * To use the HRIRs of a .safhrir file without copying them, see
+ * "hrirFile_open" and "hrirFile_getData" instead (which do not truncate them).
  *
  * Input Arguments:
  *     sofa_filepath - directory/file_name of the SOFA file you wish to load
@@ -77,6 +88,61 @@ void loadSofaFile(/* Input Arguments */
                   int* N_hrir_dirs,
                   int* hrir_len,
                   int* hrir_fs );
+
+/*
+ * Function: loadSofaFileSubset
+ * ----------------------------
+ * The same as "loadSofaFile", except that only the measurements
+ * firstMeasurement..firstMeasurement+nMeasurements-1 are read from the file
+ * (e.g. a single distance of a large near-field HRIR set).
+ * Note: only "measurements x 2 receivers x samples" data are supported;
+ * otherwise (e.g. multi-emitter "MultiSpeakerBRIR" data), the default HRIR data
+ * are returned instead.
+ *
+ * Input Arguments:
+ *     sofa_filepath    - directory/file_name of the SOFA file you wish to load
+ *                        Optionally, you may set this as NULL, and the function
+ *                        will return the default HRIR data.
+ *     firstMeasurement - index of the first measurement to read
+ *     nMeasurements    - number of measurements to read; <=0: all measurements
+ *                        from firstMeasurement onwards
+ * Output Arguments:
+ *     hrirs            - & of the HRIR data; FLAT:  N_hrir_dirs x 2 x hrir_len
+ *     hrir_dirs_deg    - & of the HRIR positions; FLAT: N_hrir_dirs x 2
+ *     N_hrir_dirs      - & number of HRIR positions that were read
+ *     hrir_len         - & length of the HRIRs in samples
+ *     hrir_fs          - & sampling rate used to record HRIRs
+ */
+void loadSofaFileSubset(/* Input Arguments */
+                        char* sofa_filepath,
+                        int firstMeasurement,
+                        int nMeasurements,
+                        /* Output Arguments */
+                        float** hrirs,
+                        float** hrir_dirs_deg,
+                        int* N_hrir_dirs,
+                        int* hrir_len,
+                        int* hrir_fs );
+
+/*
+ * Function: convertSofaToHRIRfile
+ * -------------------------------
+ * Converts a SOFA file to the compact .safhrir format (see "hrirFile_open"),
+ * which may then be memory mapped and used without netcdf, or passed to
+ * "loadSofaFile" in place of the SOFA file.
+ * Note: the HRIRs are truncated to "MAX_SOFA_HRIR_LENGTH", as in loadSofaFile
+ *
+ * Input Arguments:
+ *     sofa_filepath - directory/file_name of the SOFA file to convert
+ *     hrir_filepath - directory/file_name of the .safhrir file to write
+ * Returns:
+ *     1: success, 0: the SOFA file could not be read, or the .safhrir file
+ *     could not be written
+ */
+#ifdef SAF_ENABLE_SOFA_READER
+int convertSofaToHRIRfile(char* sofa_filepath,
+                          const char* hrir_filepath);
+#endif
     
     
 #ifdef __cplusplus
@@ -37,6 +37,30 @@ const float wxyzCoeffs[4][4] = { {3.544907701811032f, 0.0f, 0.0f, 0.0f},
     {0.0f, 2.046653415892977f, 0.0f, 0.0f},
     {0.0f, 0.0f, 2.046653415892977f, 0.0f} };
 
+/* number of directions processed at a time by getSHreal_recur */
+#define SH_RECUR_BLOCK_SIZE ( 256 )
+
+/* neighbourhood radius, relative to the mean nearest-neighbour angle of a grid */
+#define SPH_PEAK_SEARCH_NBR_SCALE ( 1.5f )
+
+typedef struct _sphPeakSearch_data {
+    int order, nSH, nLevels, maxGrid;
+    int* nGrid;              /* nLevels x 1 */
+    float** grid_xyz;        /* per level: nGrid x 3 */
+    float** Y_grid;          /* per level, direction-major: nGrid x nSH */
+    float* cosNbrRad;        /* cos(neighbourhood radius) per level; nLevels x 1 */
+    int* coarseNbrs;         /* neighbours of the coarse grid points; FLAT: nGrid[0] x maxNbrs */
+    int* nCoarseNbrs;        /* nGrid[0] x 1 */
+    int maxNbrs;
+    
+    /* scratch */
+    float* Q1, *Q2;          /* quadratic forms of the map; nSH x nSH */
+    float* map, *QY;         /* maxGrid x 1, maxGrid x nSH */
+    float* Ycand;            /* maxGrid x nSH */
+    int* candIdx;            /* maxGrid x 1 */
+    
+}sphPeakSearch_data;
+
 static double Jn(int n, double z)
 {
 #ifndef _MSC_VER
@@ -358,58 +382,106 @@ void getSHreal_recur
     float* Y
 )
 {
-    int n, m, i, dir, index_n;
-    float Nn0, Nnm;
-    float* leg_n, *leg_n_1, *leg_n_2, *cos_incl, *factorials_n;
-    
-    factorials_n = malloc1d((2*N+1)*sizeof(float));
-    leg_n = malloc1d((N+1)*nDirs * sizeof(float));
-    leg_n_1 = calloc1d((N+1)*nDirs, sizeof(float));
-    leg_n_2 = calloc1d((N+1)*nDirs, sizeof(float));
-    cos_incl = malloc1d(nDirs * sizeof(float));
-    index_n = 0;
-
-    /* precompute factorials */
-    for (i = 0; i < 2*N+1; i++)
-        factorials_n[i] = (float)factorial(i);
-    
-    /* cos(inclination) = sin(elevation) */
-    for (dir = 0; dir<nDirs; dir++)
-        cos_incl[dir] = cosf(dirs_rad[dir*2+1]);
-    
-    /* compute SHs with the recursive Legendre function */
-    for (n = 0; n<N+1; n++) {
-        if (n==0) {
-            for (dir = 0; dir<nDirs; dir++)
-                Y[n*nDirs+dir] = 1.0f/sqrtf(4.0f*M_PI);
-            index_n = 1;
+    int n, m, d, d0, nb, idx_n;
+    float* a_mm, *a_nm, *b_nm, *buf;
+    float *x, *s, *c1, *pmm, *p, *p_1, *p_2, *cos_m, *cos_m1, *sin_m, *sin_m1, *tmp;
+    float pnorm, sqrt2, ctmp, stmp;
+    
+    /* precompute the normalisation/recursion coefficients of the (fully) normalised Legendre functions:
+     *   P_mm = a_mm * sin(incl) * P_(m-1)(m-1)
+     *   P_(m+1)m = sqrt(2m+3) * cos(incl) * P_mm
+     *   P_nm = a_nm * (cos(incl) * P_(n-1)m - b_nm * P_(n-2)m)
+     * with P_00 = 1/sqrt(4pi). This avoids the (overflowing) factorial terms of the unnormalised functions */
+    a_mm = malloc1d((N+1)*sizeof(float));
+    a_nm = malloc1d((N+1)*(N+1)*sizeof(float));
+    b_nm = malloc1d((N+1)*(N+1)*sizeof(float));
+    a_mm[0] = 1.0f;
+    for(m=1; m<=N; m++)
+        a_mm[m] = (float)sqrt((2.0*(double)m+1.0)/(2.0*(double)m));
+    for(m=0; m<=N; m++){
+        for(n=m+2; n<=N; n++){
+            a_nm[n*(N+1)+m] = (float)sqrt((4.0*(double)(n*n)-1.0)/(double)(n*n-m*m));
+            b_nm[n*(N+1)+m] = (float)sqrt((double)((n-1)*(n-1)-m*m)/(4.0*(double)((n-1)*(n-1))-1.0));
         }
-        else {
-            unnorm_legendreP_recur(n, cos_incl, nDirs, leg_n_1, leg_n_2, leg_n); /* does NOT include Condon-Shortley phase term */
+    }
+    pnorm = 1.0f/sqrtf(4.0f*M_PI);
+    sqrt2 = sqrtf(2.0f);
+    
+    /* scratch for one block of directions */
+    buf = malloc1d(11*SH_RECUR_BLOCK_SIZE*sizeof(float));
+    x = &buf[0*SH_RECUR_BLOCK_SIZE];      s = &buf[1*SH_RECUR_BLOCK_SIZE];
+    c1 = &buf[2*SH_RECUR_BLOCK_SIZE];     pmm = &buf[3*SH_RECUR_BLOCK_SIZE];
+    p = &buf[4*SH_RECUR_BLOCK_SIZE];      p_1 = &buf[5*SH_RECUR_BLOCK_SIZE];
+    p_2 = &buf[6*SH_RECUR_BLOCK_SIZE];    cos_m = &buf[7*SH_RECUR_BLOCK_SIZE];
+    cos_m1 = &buf[8*SH_RECUR_BLOCK_SIZE]; sin_m = &buf[9*SH_RECUR_BLOCK_SIZE];
+    sin_m1 = &buf[10*SH_RECUR_BLOCK_SIZE];
+    
+    /* process the directions in blocks, such that all intermediate vectors remain in cache, and each (n,m) row
+     * of Y is written contiguously */
+    for(d0=0; d0<nDirs; d0+=SH_RECUR_BLOCK_SIZE){
+        nb = MIN(SH_RECUR_BLOCK_SIZE, nDirs-d0);
+        for(d=0; d<nb; d++){
+            x[d] = cosf(dirs_rad[(d0+d)*2+1]); /* cos(inclination) */
+            s[d] = sqrtf(MAX(1.0f-x[d]*x[d], 0.0f));
+            c1[d] = cosf(dirs_rad[(d0+d)*2]);
+            pmm[d] = pnorm;
+            cos_m[d] = 1.0f;                     /* cos(0*azi) */
+            sin_m[d] = 0.0f;                     /* sin(0*azi) */
+            cos_m1[d] = c1[d];                   /* cos(-1*azi) */
+            sin_m1[d] = -sinf(dirs_rad[(d0+d)*2]); /* sin(-1*azi) */
+        }
+        
+        for(m=0; m<=N; m++){
+            if(m>0){
+                /* Chebyshev recursion for cos(m*azi) and sin(m*azi), and the sectoral Legendre functions */
+                for(d=0; d<nb; d++){
+                    ctmp = 2.0f*c1[d]*cos_m[d] - cos_m1[d];
+                    stmp = 2.0f*c1[d]*sin_m[d] - sin_m1[d];
+                    cos_m1[d] = cos_m[d];
+                    sin_m1[d] = sin_m[d];
+                    cos_m[d] = ctmp;
+                    sin_m[d] = stmp;
+                    pmm[d] *= a_mm[m]*s[d];
+                }
+            }
             
-            Nn0 = sqrtf(2.0f*(float)n+1.0f);
-            for (dir = 0; dir<nDirs; dir++){
-                for (m = 0; m<n+1; m++) {
-                    if (m==0)
-                        Y[(index_n+n)*nDirs+dir] = Nn0/sqrtf(4.0f*M_PI)  * leg_n[m*nDirs+dir];
-                    else {
-                        Nnm = Nn0* sqrtf( 2.0f * factorials_n[n-m]/factorials_n[n+m] );
-                        Y[(index_n+n-m)*nDirs+dir] = Nnm/sqrtf(4.0f*M_PI) * leg_n[m*nDirs+dir] * sinf((float)m * (dirs_rad[dir*2]));
-                        Y[(index_n+n+m)*nDirs+dir] = Nnm/sqrtf(4.0f*M_PI) * leg_n[m*nDirs+dir] * cosf((float)m * (dirs_rad[dir*2]));
+            /* n = m, ..., N */
+            for(n=m; n<=N; n++){
+                if(n==m)
+                    utility_svvcopy(pmm, nb, p);
+                else if(n==m+1){
+                    ctmp = sqrtf(2.0f*(float)m+3.0f);
+                    for(d=0; d<nb; d++)
+                        p[d] = ctmp * x[d] * p_1[d];
+                }
+                else{
+                    ctmp = a_nm[n*(N+1)+m];
+                    stmp = b_nm[n*(N+1)+m];
+                    for(d=0; d<nb; d++)
+                        p[d] = ctmp * (x[d] * p_1[d] - stmp * p_2[d]);
+                }
+                
+                /* write the (n,-m) and (n,m) rows */
+                idx_n = n*n+n;
+                if(m==0)
+                    utility_svvcopy(p, nb, &Y[idx_n*nDirs+d0]);
+                else{
+                    for(d=0; d<nb; d++){
+                        Y[(idx_n-m)*nDirs+d0+d] = sqrt2 * p[d] * sin_m[d];
+                        Y[(idx_n+m)*nDirs+d0+d] = sqrt2 * p[d] * cos_m[d];
                     }
                 }
+                
+                /* shift */
+                tmp = p_2; p_2 = p_1; p_1 = p; p = tmp;
             }
-            index_n += 2*n+1;
         }
-        utility_svvcopy(leg_n_1, (N+1)*nDirs, leg_n_2);
-        utility_svvcopy(leg_n,   (N+1)*nDirs, leg_n_1);  
     }
     
-    free(factorials_n);
-    free(leg_n);
-    free(leg_n_1);
-    free(leg_n_2);
-    free(cos_incl);
+    free(a_mm);
+    free(a_nm);
+    free(b_nm);
+    free(buf);
 }
 
 void getSHcomplex
@@ -1342,6 +1414,411 @@ void generateMinNormMap
     free(Un_Y);
 }
 
+/* Prepares the real symmetric matrices Q1 and Q2, such that the map value for a
+ * real steering vector y is a function of q1=y'*Q1*y and q2=y'*Q2*y. (The
+ * imaginary parts do not contribute, since y is real) */
+static void sphPeakSearch_prepare
+(
+    sphPeakSearch_data* pData,
+    float_complex* Cx,
+    SPH_MAP_TYPES mapType,
+    int nSources,
+    float regPar
+)
+{
+    int i, j, nSH, nNoise;
+    float Cx_trace;
+    float_complex* V, *Vn, *Vn1, *Un, *Cx_d, *B, *Cx_B, *M, *eye;
+    float_complex Vn1_Vn1H;
+    const float_complex calpha = cmplxf(1.0f, 0.0f), cbeta = cmplxf(0.0f, 0.0f);
+    
+    nSH = pData->nSH;
+    M = malloc1d(nSH*nSH*sizeof(float_complex));
+    switch(mapType){
+        default:
+        case SPH_MAP_PWD:
+            memcpy(M, Cx, nSH*nSH*sizeof(float_complex));
+            break;
+            
+        case SPH_MAP_MVDR:
+            /* map = (y'*B.'*Cx*B*y) / (y'*B*y)^2, where B = (Cx + diagonal loading)^-1 */
+            Cx_d = malloc1d(nSH*nSH*sizeof(float_complex));
+            B = malloc1d(nSH*nSH*sizeof(float_complex));
+            Cx_B = malloc1d(nSH*nSH*sizeof(float_complex));
+            eye = calloc1d(nSH*nSH, sizeof(float_complex));
+            Cx_trace = 0.0f;
+            for(i=0; i<nSH; i++)
+                Cx_trace += crealf(Cx[i*nSH+i]);
+            Cx_trace /= (float)nSH;
+            memcpy(Cx_d, Cx, nSH*nSH*sizeof(float_complex));
+            for(i=0; i<nSH; i++){
+                Cx_d[i*nSH+i] = craddf(Cx_d[i*nSH+i], regPar*Cx_trace);
+                eye[i*nSH+i] = cmplxf(1.0f, 0.0f);
+            }
+            utility_cslslv(Cx_d, nSH, eye, nSH, B);
+            cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nSH, nSH, nSH, &calpha,
+                        Cx, nSH,
+                        B, nSH, &cbeta,
+                        Cx_B, nSH);
+            cblas_cgemm(CblasRowMajor, CblasTrans, CblasNoTrans, nSH, nSH, nSH, &calpha,
+                        B, nSH,
+                        Cx_B, nSH, &cbeta,
+                        M, nSH);
+            for(i=0; i<nSH; i++)
+                for(j=0; j<nSH; j++)
+                    pData->Q2[i*nSH+j] = 0.5f*(crealf(B[i*nSH+j]) + crealf(B[j*nSH+i]));
+            free(Cx_d);
+            free(B);
+            free(Cx_B);
+            free(eye);
+            break;
+            
+        case SPH_MAP_MUSIC:
+            /* map = 1/(y'*Vn*Vn^H*y) */
+            nSources = MIN(nSources, nSH/2);
+            nNoise = nSH-nSources;
+            V = malloc1d(nSH*nSH*sizeof(float_complex));
+            Vn = malloc1d(nSH*nNoise*sizeof(float_complex));
+            utility_cseig(Cx, nSH, 1, V, NULL, NULL);
+            for(i=0; i<nSH; i++)
+                for(j=0; j<nNoise; j++)
+                    Vn[i*nNoise+j] = V[i*nSH + j + nSources];
+            cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasConjTrans, nSH, nSH, nNoise, &calpha,
+                        Vn, nNoise,
+                        Vn, nNoise, &cbeta,
+                        M, nSH);
+            free(V);
+            free(Vn);
+            break;
+            
+        case SPH_MAP_MINNORM:
+            /* map = 1/(y'*Un*Un^H*y), with Un obtained as in generateMinNormMap */
+            nSources = MIN(nSources, nSH/2);
+            nNoise = nSH-nSources;
+            V = malloc1d(nSH*nSH*sizeof(float_complex));
+            Vn = malloc1d(nSH*nNoise*sizeof(float_complex));
+            Vn1 = malloc1d(nNoise*sizeof(float_complex));
+            Un = malloc1d(nSH*sizeof(float_complex));
+            utility_cseig(Cx, nSH, 1, V, NULL, NULL); /* Cx is Hermitian */
+            for(i=0; i<nSH; i++)
+                for(j=0; j<nNoise; j++)
+                    Vn[i*nNoise+j] = V[i*nSH + j + nSources];
+            for(j=0; j<nNoise; j++)
+                Vn1[j] = V[j + nSources];
+            utility_cvvdot(Vn1, Vn1, nNoise, NO_CONJ, &Vn1_Vn1H);
+            cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasConjTrans, nSH, 1, nNoise, &calpha,
+                        Vn, nNoise,
+                        Vn1, nNoise, &cbeta,
+                        Un, 1);
+            for(i=0; i<nSH; i++)
+                Un[i] = ccdivf(Un[i], craddf(Vn1_Vn1H, 2.23e-9f));
+            cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasConjTrans, nSH, nSH, 1, &calpha,
+                        Un, 1,
+                        Un, 1, &cbeta,
+                        M, nSH);
+            free(V);
+            free(Vn);
+            free(Vn1);
+            free(Un);
+            break;
+    }
+    
+    /* only the symmetric part of the real component contributes */
+    for(i=0; i<nSH; i++)
+        for(j=0; j<nSH; j++)
+            pData->Q1[i*nSH+j] = 0.5f*(crealf(M[i*nSH+j]) + crealf(M[j*nSH+i]));
+    free(M);
+}
+
+/* Evaluates the map for nDirs direction-major steering vectors */
+static void sphPeakSearch_evalMap
+(
+    sphPeakSearch_data* pData,
+    SPH_MAP_TYPES mapType,
+    float* Y,
+    int nDirs,
+    float* map
+)
+{
+    int i, nSH;
+    float q1, q2;
+    
+    nSH = pData->nSH;
+    if(nDirs<1)
+        return;
+    cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nDirs, nSH, nSH, 1.0f,
+                Y, nSH,
+                pData->Q1, nSH, 0.0f,
+                pData->QY, nSH);
+    for(i=0; i<nDirs; i++){
+        q1 = cblas_sdot(nSH, &Y[i*nSH], 1, &(pData->QY[i*nSH]), 1);
+        switch(mapType){
+            default:
+            case SPH_MAP_PWD:     map[i] = q1; break;
+            case SPH_MAP_MUSIC:   map[i] = 1.0f/(q1+2.23e-10f); break;
+            case SPH_MAP_MINNORM: map[i] = 1.0f/(q1+2.23e-9f); break;
+            case SPH_MAP_MVDR:    map[i] = q1; break;
+        }
+    }
+    if(mapType==SPH_MAP_MVDR){
+        cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nDirs, nSH, nSH, 1.0f,
+                    Y, nSH,
+                    pData->Q2, nSH, 0.0f,
+                    pData->QY, nSH);
+        for(i=0; i<nDirs; i++){
+            q2 = cblas_sdot(nSH, &Y[i*nSH], 1, &(pData->QY[i*nSH]), 1);
+            map[i] /= (q2*q2 + 2.23e-20f);
+        }
+    }
+}
+
+void sphPeakSearch_create
+(
+    void** const phPS,
+    int order,
+    int* gridIdx,
+    int nLevels
+)
+{
+    sphPeakSearch_data* pData = (sphPeakSearch_data*)malloc1d(sizeof(sphPeakSearch_data));
+    *phPS = (void*)pData;
+    int i, j, l, k, nGrid, nSH;
+    float dot, maxDot, sumNN, cosRad;
+    float* dirs_rad, *Y_tmp;
+    const float* dirs_deg;
+    
+    nSH = (order+1)*(order+1);
+    pData->order = order;
+    pData->nSH = nSH;
+    pData->nLevels = nLevels;
+    pData->nGrid = malloc1d(nLevels*sizeof(int));
+    pData->grid_xyz = malloc1d(nLevels*sizeof(float*));
+    pData->Y_grid = malloc1d(nLevels*sizeof(float*));
+    pData->cosNbrRad = malloc1d(nLevels*sizeof(float));
+    pData->maxGrid = 0;
+    for(l=0; l<nLevels; l++){
+        nGrid = __geosphere_ico_nPoints[gridIdx[l]];
+        dirs_deg = __HANDLES_geosphere_ico_dirs_deg[gridIdx[l]];
+        pData->nGrid[l] = nGrid;
+        pData->maxGrid = MAX(pData->maxGrid, nGrid);
+        
+        /* unit vectors and [azi, inclination] directions */
+        pData->grid_xyz[l] = malloc1d(nGrid*3*sizeof(float));
+        dirs_rad = malloc1d(nGrid*2*sizeof(float));
+        for(i=0; i<nGrid; i++){
+            unitSph2Cart(dirs_deg[i*2]*M_PI/180.0f, dirs_deg[i*2+1]*M_PI/180.0f, &(pData->grid_xyz[l][i*3]));
+            dirs_rad[i*2+0] = dirs_deg[i*2]*M_PI/180.0f;
+            dirs_rad[i*2+1] = M_PI/2.0f - dirs_deg[i*2+1]*M_PI/180.0f;
+        }
+        
+        /* steering vectors, stored direction-major so that candidates are contiguous */
+        Y_tmp = malloc1d(nSH*nGrid*sizeof(float));
+        getSHreal_recur(order, dirs_rad, nGrid, Y_tmp);
+        pData->Y_grid[l] = malloc1d(nGrid*nSH*sizeof(float));
+        for(i=0; i<nSH; i++)
+            for(j=0; j<nGrid; j++)
+                pData->Y_grid[l][j*nSH+i] = Y_tmp[i*nGrid+j];
+        free(Y_tmp);
+        free(dirs_rad);
+        
+        /* mean nearest-neighbour angle determines the neighbourhood radius */
+        sumNN = 0.0f;
+        for(i=0; i<nGrid; i++){
+            maxDot = -1.0f;
+            for(j=0; j<nGrid; j++){
+                if(i==j)
+                    continue;
+                dot = cblas_sdot(3, &(pData->grid_xyz[l][i*3]), 1, &(pData->grid_xyz[l][j*3]), 1);
+                maxDot = MAX(maxDot, dot);
+            }
+            sumNN += acosf(MIN(MAX(maxDot, -1.0f), 1.0f));
+        }
+        pData->cosNbrRad[l] = cosf(MIN(SPH_PEAK_SEARCH_NBR_SCALE*sumNN/(float)nGrid, M_PI));
+    }
+    
+    /* neighbours of each coarse grid point, for finding the local maxima */
+    nGrid = pData->nGrid[0];
+    cosRad = pData->cosNbrRad[0];
+    pData->nCoarseNbrs = calloc1d(nGrid, sizeof(int));
+    pData->maxNbrs = 0;
+    for(i=0; i<nGrid; i++){
+        for(j=0; j<nGrid; j++)
+            if(i!=j && cblas_sdot(3, &(pData->grid_xyz[0][i*3]), 1, &(pData->grid_xyz[0][j*3]), 1) >= cosRad)
+                pData->nCoarseNbrs[i]++;
+        pData->maxNbrs = MAX(pData->maxNbrs, pData->nCoarseNbrs[i]);
+    }
+    pData->coarseNbrs = malloc1d(nGrid*MAX(pData->maxNbrs,1)*sizeof(int));
+    for(i=0; i<nGrid; i++){
+        for(j=0, k=0; j<nGrid; j++)
+            if(i!=j && cblas_sdot(3, &(pData->grid_xyz[0][i*3]), 1, &(pData->grid_xyz[0][j*3]), 1) >= cosRad)
+                pData->coarseNbrs[i*pData->maxNbrs + k++] = j;
+    }
+    
+    /* scratch */
+    pData->Q1 = malloc1d(nSH*nSH*sizeof(float));
+    pData->Q2 = malloc1d(nSH*nSH*sizeof(float));
+    pData->map = malloc1d(pData->maxGrid*sizeof(float));
+    pData->QY = malloc1d(pData->maxGrid*nSH*sizeof(float));
+    pData->Ycand = malloc1d(pData->maxGrid*nSH*sizeof(float));
+    pData->candIdx = malloc1d(pData->maxGrid*sizeof(int));
+}
+
+void sphPeakSearch_destroy
+(
+    void** const phPS
+)
+{
+    sphPeakSearch_data *pData = (sphPeakSearch_data*)(*phPS);
+    int l;
+    
+    if (pData != NULL) {
+        for(l=0; l<pData->nLevels; l++){
+            free(pData->grid_xyz[l]);
+            free(pData->Y_grid[l]);
+        }
+        free(pData->nGrid);
+        free(pData->grid_xyz);
+        free(pData->Y_grid);
+        free(pData->cosNbrRad);
+        free(pData->coarseNbrs);
+        free(pData->nCoarseNbrs);
+        free(pData->Q1);
+        free(pData->Q2);
+        free(pData->map);
+        free(pData->QY);
+        free(pData->Ycand);
+        free(pData->candIdx);
+        free(pData);
+        pData = NULL;
+    }
+}
+
+void sphPeakSearch_find
+(
+    void* const hPS,
+    float_complex* Cx,
+    SPH_MAP_TYPES mapType,
+    int nSources,
+    float regPar,
+    int nPeaks,
+    float* peak_dirs_deg,
+    float* peak_vals,
+    int* nPeaksFound
+)
+{
+    sphPeakSearch_data *pData = (sphPeakSearch_data*)(hPS);
+    int i, j, l, p, nSH, nGrid0, nMaxima, nCand, best, isMax;
+    int* maxima_idx, *sort_idx;
+    float bestVal, minVal, w, norm;
+    float u[3], centroid[3], aziElev_rad[2];
+    float* map0, *maxima_vals, *refined_dirs, *xyz;
+    
+    nSH = pData->nSH;
+    nGrid0 = pData->nGrid[0];
+    sphPeakSearch_prepare(pData, Cx, mapType, nSources, regPar);
+    
+    /* evaluate the map over the coarse grid */
+    map0 = malloc1d(nGrid0*sizeof(float));
+    sphPeakSearch_evalMap(pData, mapType, pData->Y_grid[0], nGrid0, map0);
+    
+    /* find the local maxima and sort them from largest to smallest */
+    maxima_idx = malloc1d(nGrid0*sizeof(int));
+    maxima_vals = malloc1d(nGrid0*sizeof(float));
+    sort_idx = malloc1d(nGrid0*sizeof(int));
+    nMaxima = 0;
+    for(i=0; i<nGrid0; i++){
+        isMax = 1;
+        for(j=0; j<pData->nCoarseNbrs[i] && isMax; j++){
+            p = pData->coarseNbrs[i*pData->maxNbrs+j];
+            /* ties are resolved by grid index, so plateaus yield a single peak */
+            if(map0[p] > map0[i] || (map0[p] == map0[i] && p < i))
+                isMax = 0;
+        }
+        if(isMax){
+            maxima_idx[nMaxima] = i;
+            maxima_vals[nMaxima] = map0[i];
+            nMaxima++;
+        }
+    }
+    sortf(maxima_vals, NULL, sort_idx, nMaxima, 1);
+    nPeaks = MIN(nPeaks, nMaxima);
+    refined_dirs = malloc1d(MAX(nPeaks,1)*2*sizeof(float));
+    
+    /* refine each peak over the finer grids */
+    for(p=0; p<nPeaks; p++){
+        best = maxima_idx[sort_idx[p]];
+        bestVal = maxima_vals[p];
+        memcpy(u, &(pData->grid_xyz[0][best*3]), 3*sizeof(float));
+        
+        /* only the points of the next grid inside the neighbourhood of the current estimate are evaluated */
+        for(l=1; l<pData->nLevels; l++){
+            xyz = pData->grid_xyz[l];
+            for(i=0, nCand=0; i<pData->nGrid[l]; i++){
+                if(u[0]*xyz[i*3] + u[1]*xyz[i*3+1] + u[2]*xyz[i*3+2] >= pData->cosNbrRad[l-1]){
+                    pData->candIdx[nCand] = i;
+                    memcpy(&(pData->Ycand[nCand*nSH]), &(pData->Y_grid[l][i*nSH]), nSH*sizeof(float));
+                    nCand++;
+                }
+            }
+            sphPeakSearch_evalMap(pData, mapType, pData->Ycand, nCand, pData->map);
+            for(i=0, j=0; i<nCand; i++)
+                if(pData->map[i] > pData->map[j])
+                    j = i;
+            if(nCand>0){
+                best = pData->candIdx[j];
+                bestVal = pData->map[j];
+                memcpy(u, &(xyz[best*3]), 3*sizeof(float));
+            }
+        }
+        
+        /* sub-grid accuracy: weighted centroid of the neighbourhood around the finest grid peak */
+        l = pData->nLevels-1;
+        xyz = pData->grid_xyz[l];
+        for(i=0, nCand=0; i<pData->nGrid[l]; i++){
+            if(u[0]*xyz[i*3] + u[1]*xyz[i*3+1] + u[2]*xyz[i*3+2] >= pData->cosNbrRad[l]){
+                pData->candIdx[nCand] = i;
+                memcpy(&(pData->Ycand[nCand*nSH]), &(pData->Y_grid[l][i*nSH]), nSH*sizeof(float));
+                nCand++;
+            }
+        }
+        sphPeakSearch_evalMap(pData, mapType, pData->Ycand, nCand, pData->map);
+        minVal = bestVal;
+        for(i=0; i<nCand; i++)
+            minVal = MIN(minVal, pData->map[i]);
+        memset(centroid, 0, 3*sizeof(float));
+        for(i=0; i<nCand; i++){
+            w = pData->map[i] - minVal;
+            for(j=0; j<3; j++)
+                centroid[j] += w * xyz[pData->candIdx[i]*3+j];
+        }
+        norm = sqrtf(centroid[0]*centroid[0] + centroid[1]*centroid[1] + centroid[2]*centroid[2]);
+        if(norm > 2.23e-9f)
+            for(j=0; j<3; j++)
+                u[j] = centroid[j]/norm;
+        
+        unitCart2Sph(u, aziElev_rad);
+        refined_dirs[p*2+0] = aziElev_rad[0]*180.0f/M_PI;
+        refined_dirs[p*2+1] = aziElev_rad[1]*180.0f/M_PI;
+        maxima_vals[p] = bestVal;
+    }
+    
+    /* refinement may change the order of the peaks */
+    sortf(maxima_vals, NULL, sort_idx, nPeaks, 1);
+    for(p=0; p<nPeaks; p++){
+        peak_dirs_deg[p*2+0] = refined_dirs[sort_idx[p]*2+0];
+        peak_dirs_deg[p*2+1] = refined_dirs[sort_idx[p]*2+1];
+        if(peak_vals!=NULL)
+            peak_vals[p] = maxima_vals[p];
+    }
+    (*nPeaksFound) = nPeaks;
+    
+    free(map0);
+    free(maxima_idx);
+    free(maxima_vals);
+    free(refined_dirs);
+    free(sort_idx);
+}
+
 void bessel_Jn /* untested */
 (
     int N,
@@ -86,6 +86,28 @@ typedef enum _SECTOR_PATTERNS{
     SECTOR_PATTERN_CARDIOID
 }SECTOR_PATTERNS;
 
+/*
+ * Enum: SPH_MAP_TYPES
+ * -------------------
+ * Activity-map types supported by the hierarchical peak search (see
+ * "sphPeakSearch_create"). Each option matches the corresponding full-grid
+ * function, e.g. SPH_MAP_MUSIC gives the same values as "generateMUSICmap".
+ *
+ * Options:
+ *     SPH_MAP_PWD     - energy of plane-wave decomposition beamformers
+ *     SPH_MAP_MVDR    - energy of minimum-variance distortionless response
+ *                       beamformers
+ *     SPH_MAP_MUSIC   - multiple signal classification (MUSIC)
+ *                       pseudo-spectrum
+ *     SPH_MAP_MINNORM - minimum-norm (MinNorm) pseudo-spectrum
+ */
+typedef enum _SPH_MAP_TYPES{
+    SPH_MAP_PWD,
+    SPH_MAP_MVDR,
+    SPH_MAP_MUSIC,
+    SPH_MAP_MINNORM
+}SPH_MAP_TYPES;
+
 
 /* ========================================================================== */
 /*                               Misc. Functions                              */
@@ -267,8 +289,10 @@ void getSHreal(/* Input Arguments */
  * -------------------------
  * This function returns REAL spherical harmonics [1] for each direction on the
  * sphere. WITH the 1/sqrt(4*pi) term.  i.e. max(omni) = 1/sqrt(4*pi)
- * Note: Compared to 'getSHreal', this function employs 'unnorm_legendreP_recur'
- * and single precision, which is faster but less precise.
+ * Note: Compared to 'getSHreal', this function employs a recursion over the
+ * normalised associated Legendre functions (with precomputed coefficients),
+ * a Chebyshev recursion for sin/cos(m*azi), and single precision, which is
+ * faster but less precise. The directions are processed in cache-sized blocks.
  *
  * Input Arguments:
  *     order    - order of spherical harmonic expansion
@@ -880,6 +904,82 @@ void generateMinNormMap(/* Input arguments */
                         float* pmap);
 
 
+/*
+ * Function: sphPeakSearch_create
+ * ------------------------------
+ * Creates an instance of the hierarchical (coarse-to-fine) peak search, which
+ * finds the directions of the largest peaks in an activity-map without
+ * evaluating the map over a dense grid. The map is first evaluated over a
+ * coarse geodesic grid. Each of its local maxima is then refined by evaluating
+ * only the points of the next (finer) grid that lie inside a small cone around
+ * the current estimate, and so on, until the finest grid is reached. A weighted
+ * centroid of the finest-grid neighbourhood then provides sub-grid accuracy.
+ * Note: the geodesic grids are taken from "__HANDLES_geosphere_ico_dirs_deg",
+ * e.g. gridIdx = {3, 8, 16} uses 92, 642 and 2562 point grids, but needs only
+ * ~170 map evaluations per peak, rather than 2562.
+ *
+ * Input Arguments:
+ *     phPS    - & address of peak search handle
+ *     order   - analysis order
+ *     gridIdx - indices into "__HANDLES_geosphere_ico_dirs_deg" (0..16) for
+ *               each level, in ascending order (coarse to fine); nLevels x 1
+ *     nLevels - number of grid levels
+ */
+void sphPeakSearch_create(/* Input arguments */
+                          void** const phPS,
+                          int order,
+                          int* gridIdx,
+                          int nLevels);
+
+/*
+ * Function: sphPeakSearch_destroy
+ * -------------------------------
+ * Destroys an instance of the hierarchical peak search
+ *
+ * Input Arguments:
+ *     phPS - & address of peak search handle
+ */
+void sphPeakSearch_destroy(/* Input arguments */
+                           void** const phPS);
+
+/*
+ * Function: sphPeakSearch_find
+ * ----------------------------
+ * Finds the 'nPeaks' largest peaks of an activity-map, using the hierarchical
+ * grid search. The map values are scaled in the same way as the full-grid
+ * functions, if their steering vectors were generated with "getSHreal_recur".
+ *
+ * Input Arguments:
+ *     hPS           - peak search handle
+ *     Cx            - correlation/covarience matrix;
+ *                     FLAT: (order+1)^2 x (order+1)^2
+ *     mapType       - activity-map type (see "SPH_MAP_TYPES" enum)
+ *     nSources      - number of sources present in sound scene (only used by
+ *                     SPH_MAP_MUSIC and SPH_MAP_MINNORM)
+ *     regPar        - regularisation parameter, for diagonal loading of Cx
+ *                     (only used by SPH_MAP_MVDR)
+ *     nPeaks        - maximum number of peaks to find
+ * Output Arguments:
+ *     peak_dirs_deg - peak directions, [azi elev] convention, in DEGREES,
+ *                     sorted from largest to smallest; FLAT: nPeaks x 2
+ *     peak_vals     - map values at each peak (set to NULL if not needed);
+ *                     nPeaks x 1
+ *     nPeaksFound   - & number of peaks found (can be less than 'nPeaks' if
+ *                     the map has fewer local maxima)
+ */
+void sphPeakSearch_find(/* Input arguments */
+                        void* const hPS,
+                        float_complex* Cx,
+                        SPH_MAP_TYPES mapType,
+                        int nSources,
+                        float regPar,
+                        int nPeaks,
+                        /* Output arguments */
+                        float* peak_dirs_deg,
+                        float* peak_vals,
+                        int* nPeaksFound);
+
+
 /* ========================================================================== */
 /*                   Cylindrical/Spherical Bessel Functions                   */
 /* ========================================================================== */
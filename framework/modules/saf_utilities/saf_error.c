@@ -53,6 +53,9 @@ SAF_ERRORS saf_error_print(SAF_ERRORS err)
         case SAF_WARNING__SOFA_FILE_NOT_FOUND:
             fprintf(stdout, "%s", "SAF Warning: Could not open SOFA file. Loading default HRIR data. \n");
             break;
+        case SAF_WARNING__SOFA_FILE_NOT_SUPPORTED:
+            fprintf(stdout, "%s", "SAF Warning: SOFA file does not contain 2-receiver IRs. Loading default HRIR data. \n");
+            break;
             
         /* saf_sh warnings */
         case SAF_WARNING__UNABLE_TO_COMPUTE_BESSEL_FUNCTION_AT_SPECIFIED_ORDER:
@@ -59,6 +59,10 @@ extern "C" {
  *         loadSofaFile - sofa file was not found at the specified directory.
  *         remember to include the ".sofa" suffix. In this case, the default
  *         HRIR set is loaded instead.
+ *     SAF_WARNING__SOFA_FILE_NOT_SUPPORTED
+ *         loadSofaFile - the Data.IR of the sofa file is not measurements x 2
+ *         receivers x samples (e.g. multi-emitter "MultiSpeakerBRIR" data). In
+ *         this case, the default HRIR set is loaded instead.
  *     SAF_WARNING__UNABLE_TO_COMPUTE_BESSEL_FUNCTION_AT_SPECIFIED_ORDER
  *         bessel_jn/bessel_in/bessel_yn/bessel_kn/hankel_hn1/hankel_hn2 -
  *         Unable to compute the spherical Bessel/Hankel function at the
@@ -97,6 +101,7 @@ typedef enum _SAF_ERRORS {
     
     /* saf_hrir warnings */
     SAF_WARNING__SOFA_FILE_NOT_FOUND,
+    SAF_WARNING__SOFA_FILE_NOT_SUPPORTED,
     
     /* saf_sh warnings */
     SAF_WARNING__UNABLE_TO_COMPUTE_BESSEL_FUNCTION_AT_SPECIFIED_ORDER,
@@ -36,6 +36,72 @@
 #define SAVE_PATH3 "../vbapGains_table.txt"
 #endif
 
+/* Returns a copy of the loudspeaker directions, with dummies appended at +/-90 elevation if enabled and
+ * required. i.e. (*L_d) > L if dummies were added */
+static void getLsDirsWithDummies
+(
+    float* ls_dirs_deg,
+    int L,
+    int enableDummies,
+    float** ls_dirs_d_deg,
+    int* L_d
+)
+{
+    int i;
+    int needDummy[2] = {1, 1};
+    
+    /* scan the loudspeaker directions to see if dummies need to be added */
+    if(enableDummies){
+        for(i=0; i<L; i++){
+            if(ls_dirs_deg[i*2+1] <= -ADD_DUMMY_LIMIT)
+                needDummy[0] = 0;
+            if(ls_dirs_deg[i*2+1] >=  ADD_DUMMY_LIMIT)
+                needDummy[1] = 0;
+        }
+    }
+    else
+        needDummy[0] = needDummy[1] = 0;
+    
+    /* add dummies to the extreme top/bottom as required */
+    (*L_d) = L+needDummy[0]+needDummy[1];
+    (*ls_dirs_d_deg) = malloc1d((*L_d)*2*sizeof(float));
+    memcpy((*ls_dirs_d_deg), ls_dirs_deg, L*2*sizeof(float));
+    i = L;
+    if (needDummy[0]){
+        (*ls_dirs_d_deg)[i*2+0] = 0.0f;
+        (*ls_dirs_d_deg)[i*2+1] = -90.0f;
+        i++;
+    }
+    if (needDummy[1]){
+        (*ls_dirs_d_deg)[i*2+0] = 0.0f;
+        (*ls_dirs_d_deg)[i*2+1] = 90.0f;
+    }
+}
+
+/* Triangulates the loudspeaker directions, adding dummies at +/-90 elevation if
+ * enabled and required. The dummies (if any) are the last loudspeakers in
+ * out_vertices, i.e. (*numOutVertices) > L if dummies were added */
+static void getLsTriangulation3D
+(
+    float* ls_dirs_deg,
+    int L,
+    int omitLargeTriangles,
+    int enableDummies,
+    float** out_vertices,
+    int* numOutVertices,
+    int** out_faces,
+    int* numOutFaces
+)
+{
+    int L_d;
+    float* ls_dirs_d_deg;
+    
+    /* triangulate while including any dummy loudspeaker directions */
+    getLsDirsWithDummies(ls_dirs_deg, L, enableDummies, &ls_dirs_d_deg, &L_d);
+    findLsTriplets(ls_dirs_d_deg, L_d, omitLargeTriangles, out_vertices, numOutVertices, out_faces, numOutFaces);
+    free(ls_dirs_d_deg);
+}
+
 void generateVBAPgainTable3D_srcs
 (
     float* src_dirs_deg,
@@ -53,45 +119,13 @@ void generateVBAPgainTable3D_srcs
     int N_points, numOutVertices, numOutFaces;
     int* out_faces;
     float *out_vertices, *layoutInvMtx;
-    int i, L_d;
-    int needDummy[2] = {1, 1};
-    float* ls_dirs_d_deg;
+    int i;
+    void* hFaceIdx;
     
     /* find loudspeaker triangles */
     out_vertices = NULL;
     out_faces = NULL;
-    if(enableDummies){
-        /* scan the loudspeaker directions to see if dummies need to be added */
-        for(i=0; i<L; i++){
-            if(ls_dirs_deg[i*2+1] <= -ADD_DUMMY_LIMIT)
-                needDummy[0] = 0;
-            if(ls_dirs_deg[i*2+1] >=  ADD_DUMMY_LIMIT)
-                needDummy[1] = 0;
-        }
-        if(needDummy[0] || needDummy[1]){
-            /* add dummies to the extreme top/bottom as required */
-            L_d = L+needDummy[0]+needDummy[1];
-            ls_dirs_d_deg = malloc1d(L_d*2*sizeof(float));
-            memcpy(ls_dirs_d_deg, ls_dirs_deg, L*2*sizeof(float));
-            if (needDummy[0]){
-                ls_dirs_d_deg[i*2+0] = 0.0f;
-                ls_dirs_d_deg[i*2+1] = -90.0f;
-                i++;
-            }
-            if (needDummy[1]){
-                ls_dirs_d_deg[i*2+0] = 0.0f;
-                ls_dirs_d_deg[i*2+1] = 90.0f;
-            }
-            
-            /* triangulate while including the dummy loudspeaker directions */
-            findLsTriplets(ls_dirs_d_deg, L_d, omitLargeTriangles, &out_vertices, &numOutVertices, &out_faces, &numOutFaces);
-            free(ls_dirs_d_deg);
-        }
-        else /* triangulate as normal */
-            findLsTriplets(ls_dirs_deg, L, omitLargeTriangles, &out_vertices, &numOutVertices, &out_faces, &numOutFaces);
-    }
-    else
-        findLsTriplets(ls_dirs_deg, L, omitLargeTriangles, &out_vertices, &numOutVertices, &out_faces, &numOutFaces);
+    getLsTriangulation3D(ls_dirs_deg, L, omitLargeTriangles, enableDummies, &out_vertices, &numOutVertices, &out_faces, &numOutFaces);
 #if ENABLE_VBAP_DEBUGGING_CODE
     /* save faces and vertices for verification in matlab: */
     FILE* objfile = fopen(SAVE_PATH, "wt");
@@ -120,14 +154,14 @@ void generateVBAPgainTable3D_srcs
     
     /* Calculate VBAP gains for each source position */
     N_points = S;
-    vbap3D(src_dirs_deg, N_points, numOutVertices, out_faces, numOutFaces, spread, layoutInvMtx, gtable);
-    if(enableDummies){
-        if(needDummy[0] || needDummy[1]){
-            /* remove the gains for the dummy loudspeakers, they have served their purpose and can now be laid to rest */
-            for(i=0; i<N_points; i++)
-                memcpy(&(*gtable)[i*L], &(*gtable)[i*numOutVertices], L*sizeof(float));
-            (*gtable) = realloc((*gtable), N_points*L*sizeof(float));
-        }
+    faceIndex3D_create(&hFaceIdx, out_vertices, out_faces, numOutFaces);
+    vbap3D(src_dirs_deg, N_points, numOutVertices, out_faces, numOutFaces, spread, layoutInvMtx, hFaceIdx, gtable);
+    faceIndex3D_destroy(&hFaceIdx);
+    if(numOutVertices > L){
+        /* remove the gains for the dummy loudspeakers, they have served their purpose and can now be laid to rest */
+        for(i=0; i<N_points; i++)
+            memcpy(&(*gtable)[i*L], &(*gtable)[i*numOutVertices], L*sizeof(float));
+        (*gtable) = realloc((*gtable), N_points*L*sizeof(float));
     }
     
     /* output */
@@ -173,9 +207,7 @@ void generateVBAPgainTable3D
     int* out_faces;
     float fi;
     float* azi, *ele, *src_dirs, *out_vertices, *layoutInvMtx;
-    int L_d;
-    int needDummy[2] = {1, 1};
-    float* ls_dirs_d_deg;
+    void* hFaceIdx;
     
     /* compute source directions for the grid */
     N_azi = (int)((360.0f/(float)az_res_deg) + 1.5f);
@@ -197,38 +229,7 @@ void generateVBAPgainTable3D
     /* find loudspeaker triangles */
     out_vertices = NULL;
     out_faces = NULL;
-    if(enableDummies){
-        /* scan the loudspeaker directions to see if dummies need to be added */
-        for(i=0; i<L; i++){
-            if(ls_dirs_deg[i*2+1] <= -ADD_DUMMY_LIMIT)
-                needDummy[0] = 0;
-            if(ls_dirs_deg[i*2+1] >=  ADD_DUMMY_LIMIT)
-                needDummy[1] = 0;
-        }
-        if(needDummy[0] || needDummy[1]){
-            /* add dummies to the extreme top/bottom as required */
-            L_d = L+needDummy[0]+needDummy[1];
-            ls_dirs_d_deg = malloc1d(L_d*2*sizeof(float));
-            memcpy(ls_dirs_d_deg, ls_dirs_deg, L*2*sizeof(float));
-            if (needDummy[0]){
-                ls_dirs_d_deg[i*2+0] = 0.0f;
-                ls_dirs_d_deg[i*2+1] = -90.0f;
-                i++;
-            }
-            if (needDummy[1]){
-                ls_dirs_d_deg[i*2+0] = 0.0f;
-                ls_dirs_d_deg[i*2+1] = 90.0f;
-            }
-            
-            /* triangulate while including the dummy loudspeakers */
-            findLsTriplets(ls_dirs_d_deg, L_d, omitLargeTriangles, &out_vertices, &numOutVertices, &out_faces, &numOutFaces);
-            free(ls_dirs_d_deg);
-        }
-        else /* triangulate as normal */
-            findLsTriplets(ls_dirs_deg, L, omitLargeTriangles, &out_vertices, &numOutVertices, &out_faces, &numOutFaces);
-    }
-    else /* triangulate as normal */
-        findLsTriplets(ls_dirs_deg, L, omitLargeTriangles, &out_vertices, &numOutVertices, &out_faces, &numOutFaces);
+    getLsTriangulation3D(ls_dirs_deg, L, omitLargeTriangles, enableDummies, &out_vertices, &numOutVertices, &out_faces, &numOutFaces);
 #if ENABLE_VBAP_DEBUGGING_CODE
     /* save faces and vertices for verification in matlab: */
     FILE* objfile = fopen(SAVE_PATH, "wt");
@@ -257,15 +258,15 @@ void generateVBAPgainTable3D
     
     /* Calculate VBAP gains for each source position */
     N_points = N_azi*N_ele;
-    vbap3D(src_dirs, N_points, numOutVertices, out_faces, numOutFaces, spread, layoutInvMtx,  gtable);
+    faceIndex3D_create(&hFaceIdx, out_vertices, out_faces, numOutFaces);
+    vbap3D(src_dirs, N_points, numOutVertices, out_faces, numOutFaces, spread, layoutInvMtx, hFaceIdx, gtable);
+    faceIndex3D_destroy(&hFaceIdx);
     
     /* remove the gains for the dummy loudspeakers, they have served their purpose and can now be laid to rest */
-    if(enableDummies){
-        if(needDummy[0] || needDummy[1]){
-            for(i=0; i<N_points; i++)
-                memcpy(&(*gtable)[i*L], &(*gtable)[i*numOutVertices], L*sizeof(float));
-            (*gtable) = realloc((*gtable), N_points*L*sizeof(float));
-        }
+    if(numOutVertices > L){
+        for(i=0; i<N_points; i++)
+            memcpy(&(*gtable)[i*L], &(*gtable)[i*numOutVertices], L*sizeof(float));
+        (*gtable) = realloc((*gtable), N_points*L*sizeof(float));
     }
     
     /* output */
@@ -295,6 +296,538 @@ void generateVBAPgainTable3D
     free(ele);
 }
 
+typedef struct _vbapGains_data {
+    int L, nVertices, nFaces;
+    float spread;
+    int* faces;              /* loudspeaker triangles; FLAT: nFaces x 3 */
+    float* layoutInvMtx;     /* inverted loudspeaker matrices; FLAT: nFaces x 9 */
+    void* hFaceIdx;          /* triangle look-up structure */
+    float* gains;            /* scratch, including any dummies; nVertices x 1 */
+    float* U_spread;         /* scratch, MDAP spread directions; (VBAP_GAINS_NUM_SPREAD_SRCS+1) x 3 */
+    
+}vbapGains_data;
+
+void vbapGains_create
+(
+    void** const phVBAP,
+    float* ls_dirs_deg,
+    int L,
+    int omitLargeTriangles,
+    int enableDummies,
+    float spread
+)
+{
+    vbapGains_data* h;
+    float* out_vertices;
+    
+    h = (vbapGains_data*)malloc1d(sizeof(vbapGains_data));
+    *phVBAP = (void*)h;
+    h->L = L;
+    h->spread = spread;
+    
+    /* find loudspeaker triangles and invert their matrices */
+    out_vertices = NULL;
+    h->faces = NULL;
+    getLsTriangulation3D(ls_dirs_deg, L, omitLargeTriangles, enableDummies, &out_vertices, &(h->nVertices), &(h->faces), &(h->nFaces));
+    h->layoutInvMtx = NULL;
+    invertLsMtx3D(out_vertices, h->faces, h->nFaces, &(h->layoutInvMtx));
+    faceIndex3D_create(&(h->hFaceIdx), out_vertices, h->faces, h->nFaces);
+    h->gains = malloc1d(h->nVertices*sizeof(float));
+    h->U_spread = malloc1d((VBAP_GAINS_NUM_SPREAD_SRCS+1)*3*sizeof(float));
+    
+    free1d((void**)&(out_vertices));
+}
+
+void vbapGains_destroy
+(
+    void** const phVBAP
+)
+{
+    vbapGains_data *h = (vbapGains_data*)(*phVBAP);
+    
+    if (h != NULL) {
+        free1d((void**)&(h->faces));
+        free1d((void**)&(h->layoutInvMtx));
+        faceIndex3D_destroy(&(h->hFaceIdx));
+        free(h->gains);
+        free(h->U_spread);
+        free(h);
+        h = NULL;
+        *phVBAP = NULL;
+    }
+}
+
+void vbapGains_get
+(
+    void* const hVBAP,
+    float src_azi_deg,
+    float src_elev_deg,
+    float* gains
+)
+{
+    vbapGains_data *h = (vbapGains_data*)(hVBAP);
+    int i;
+    float azi_rad, elev_rad, gains_rms;
+    float u[3];
+    
+    azi_rad  = src_azi_deg*M_PI/180.0f;
+    elev_rad = src_elev_deg*M_PI/180.0f;
+    memset(h->gains, 0, h->nVertices*sizeof(float));
+    if (h->spread > 0.1f) { /* MDAP */
+        getSpreadSrcDirs3D(azi_rad, elev_rad, h->spread, VBAP_GAINS_NUM_SPREAD_SRCS, 1, h->U_spread);
+        vbap3D_gainsForDirs(h->U_spread, VBAP_GAINS_NUM_SPREAD_SRCS+1, h->faces, h->nFaces, h->layoutInvMtx, h->hFaceIdx, h->gains);
+    }
+    else{ /* VBAP */
+        u[0] = cosf(azi_rad)*cosf(elev_rad);
+        u[1] = sinf(azi_rad)*cosf(elev_rad);
+        u[2] = sinf(elev_rad);
+        vbap3D_gainsForDir(u, h->faces, h->nFaces, h->layoutInvMtx, h->hFaceIdx, 0, h->gains);
+    }
+    
+    /* energy normalise (including any dummies, as with the gain tables), and discard the dummies */
+    gains_rms = 0.0f;
+    for(i=0; i<h->nVertices; i++)
+        gains_rms += h->gains[i]*h->gains[i];
+    gains_rms = sqrtf(gains_rms);
+    for(i=0; i<h->L; i++)
+        gains[i] = MAX(h->gains[i]/gains_rms, 0.0f);
+}
+
+void vbapGains_getBatch
+(
+    void* const hVBAP,
+    float* src_dirs_deg,
+    int nSrcs,
+    float* gains
+)
+{
+    vbapGains_data *h = (vbapGains_data*)(hVBAP);
+    int i;
+    
+    for(i=0; i<nSrcs; i++)
+        vbapGains_get(hVBAP, src_dirs_deg[i*2], src_dirs_deg[i*2+1], &gains[i*(h->L)]);
+}
+
+typedef struct _vbapGainTable3D_data {
+    int L, nVertices, nFaces, N_points;
+    int omitLargeTriangles, enableDummies;
+    float spread;
+    float* ls_dirs_deg;      /* loudspeaker directions, including any dummies; FLAT: nVertices x 2 */
+    float* vertices;         /* loudspeaker unit vectors, including any dummies; FLAT: nVertices x 3 */
+    void* hConvHull;         /* convex hull of the loudspeaker unit vectors */
+    int* faces;              /* loudspeaker triangles; FLAT: nFaces x 3 */
+    float* layoutInvMtx;     /* inverted loudspeaker matrices; FLAT: nFaces x 9 */
+    void* hFaceIdx;          /* triangle look-up structure */
+    float* src_dirs;         /* directions of the gain table points; FLAT: N_points x 2 */
+    int* rowNnz;             /* number of non-zero gains of each gain table point; N_points x 1 */
+    
+}vbapGainTable3D_data;
+
+/* converts loudspeaker direction "i" to a unit vector, in the same manner as findLsTriplets */
+static void vbapGainTable3D_setVertex(vbapGainTable3D_data* h, int i)
+{
+    double rcoselev;
+    
+    h->vertices[i*3+2] = (float)sin((double)h->ls_dirs_deg[i*2+1]*M_PI/180.0);
+    rcoselev = cos((double)h->ls_dirs_deg[i*2+1]*M_PI/180.0);
+    h->vertices[i*3+0] = (float)(rcoselev * cos((double)h->ls_dirs_deg[i*2+0]*M_PI/180.0));
+    h->vertices[i*3+1] = (float)(rcoselev * sin((double)h->ls_dirs_deg[i*2+0]*M_PI/180.0));
+}
+
+/* computes the VBAP gains for the table points "rows" (dummies removed), and writes them into the compressed table.
+ * As in compressVBAPgainTable, the number of entries per point (nnz) is the maximum number of non-zero gains of any
+ * point (and at least 1), so the table is re-packed if this has grown or shrunk */
+static void vbapGainTable3D_computeRows
+(
+    vbapGainTable3D_data* h,
+    int* rows,
+    int nRows,
+    float** vbap_gtableComp,
+    int** vbap_gtableIdx,
+    int* nnz
+)
+{
+    int i, j, n, nt, nnz_new, nCopy;
+    float* src_dirs, *gtable, *comp_new;
+    int* idx_new;
+    
+    if(nRows==0)
+        return;
+    src_dirs = malloc1d(nRows*2*sizeof(float));
+    for(n=0; n<nRows; n++)
+        memcpy(&src_dirs[n*2], &(h->src_dirs[rows[n]*2]), 2*sizeof(float));
+    gtable = NULL;
+    vbap3D(src_dirs, nRows, h->nVertices, h->faces, h->nFaces, h->spread, h->layoutInvMtx, h->hFaceIdx, &gtable);
+    
+    /* re-pack the compressed table, if the maximum number of non-zero gains per point has changed. The points that
+     * are not re-computed have at most nnz_new non-zero gains, which come first in their rows */
+    for(n=0; n<nRows; n++){
+        for(i=0, j=0; i<h->L; i++)
+            if(gtable[n*h->nVertices+i]>0.0000001f)
+                j++;
+        h->rowNnz[rows[n]] = j;
+    }
+    nnz_new = 1;
+    for(nt=0; nt<h->N_points; nt++)
+        nnz_new = MAX(nnz_new, h->rowNnz[nt]);
+    if(nnz_new != (*nnz)){
+        comp_new = calloc1d(h->N_points*nnz_new, sizeof(float));
+        idx_new = calloc1d(h->N_points*nnz_new, sizeof(int));
+        nCopy = MIN(nnz_new, (*nnz));
+        for(nt=0; nt<h->N_points; nt++){
+            memcpy(&comp_new[nt*nnz_new], &(*vbap_gtableComp)[nt*(*nnz)], nCopy*sizeof(float));
+            memcpy(&idx_new[nt*nnz_new], &(*vbap_gtableIdx)[nt*(*nnz)], nCopy*sizeof(int));
+        }
+        free1d((void**)vbap_gtableComp);
+        free1d((void**)vbap_gtableIdx);
+        (*vbap_gtableComp) = comp_new;
+        (*vbap_gtableIdx) = idx_new;
+        (*nnz) = nnz_new;
+    }
+    
+    /* keep only the non-zero gains (and their indices), as in compressVBAPgainTable */
+    for(n=0; n<nRows; n++){
+        nt = rows[n];
+        memset(&(*vbap_gtableComp)[nt*(*nnz)], 0, (*nnz)*sizeof(float));
+        memset(&(*vbap_gtableIdx)[nt*(*nnz)], 0, (*nnz)*sizeof(int));
+        for(i=0, j=0; i<h->L; i++){
+            if(gtable[n*h->nVertices+i]>0.0000001f){
+                (*vbap_gtableComp)[nt*(*nnz)+j] = gtable[n*h->nVertices+i];
+                (*vbap_gtableIdx)[nt*(*nnz)+j] = i;
+                j++;
+            }
+        }
+    }
+    
+    free(src_dirs);
+    free(gtable);
+}
+
+/* (re)computes everything: the triangulation, the inverted matrices, and the whole gain table */
+static void vbapGainTable3D_init
+(
+    vbapGainTable3D_data* h,
+    float* ls_dirs_deg,
+    float** vbap_gtableComp,
+    int** vbap_gtableIdx,
+    int* nnz
+)
+{
+    int i, j, nHullFaces;
+    int* hullFaces, *rows;
+    ch_vertex* vertices;
+    
+    free1d((void**)&(h->ls_dirs_deg));
+    free1d((void**)&(h->vertices));
+    free1d((void**)&(h->faces));
+    free1d((void**)&(h->layoutInvMtx));
+    faceIndex3D_destroy(&(h->hFaceIdx));
+    convhull_3d_destroy(&(h->hConvHull));
+    free1d((void**)vbap_gtableComp);
+    free1d((void**)vbap_gtableIdx);
+    
+    /* build the convex hull, including any dummies */
+    getLsDirsWithDummies(ls_dirs_deg, h->L, h->enableDummies, &(h->ls_dirs_deg), &(h->nVertices));
+    h->vertices = malloc1d(h->nVertices*3*sizeof(float));
+    vertices = malloc1d(h->nVertices*sizeof(ch_vertex));
+    for(i=0; i<h->nVertices; i++){
+        vbapGainTable3D_setVertex(h, i);
+        for(j=0; j<3; j++)
+            vertices[i].v[j] = h->vertices[i*3+j];
+    }
+    convhull_3d_create(&(h->hConvHull), vertices, h->nVertices);
+    free(vertices);
+    
+    /* loudspeaker triangles, and their inverted matrices */
+    convhull_3d_getFaces(h->hConvHull, &hullFaces, &nHullFaces);
+    filterLsTriplets(h->vertices, h->nVertices, hullFaces, nHullFaces, h->omitLargeTriangles, &(h->faces), &(h->nFaces));
+    free(hullFaces);
+    invertLsMtx3D(h->vertices, h->faces, h->nFaces, &(h->layoutInvMtx));
+    faceIndex3D_create(&(h->hFaceIdx), h->vertices, h->faces, h->nFaces);
+    if(h->nFaces==0){
+        (*nnz) = 0;
+        return; /* triangulation failed; the tables remain NULL */
+    }
+    
+    /* gain table */
+    (*nnz) = 1;
+    (*vbap_gtableComp) = calloc1d(h->N_points, sizeof(float));
+    (*vbap_gtableIdx) = calloc1d(h->N_points, sizeof(int));
+    memset(h->rowNnz, 0, h->N_points*sizeof(int));
+    rows = malloc1d(h->N_points*sizeof(int));
+    for(i=0; i<h->N_points; i++)
+        rows[i] = i;
+    vbapGainTable3D_computeRows(h, rows, h->N_points, vbap_gtableComp, vbap_gtableIdx, nnz);
+    free(rows);
+}
+
+void vbapGainTable3D_create
+(
+    void** const phVBAP,
+    float* ls_dirs_deg,
+    int L,
+    int az_res_deg,
+    int el_res_deg,
+    int omitLargeTriangles,
+    int enableDummies,
+    float spread,
+    float** vbap_gtableComp,
+    int** vbap_gtableIdx,
+    int* nnz,
+    int* N_gtable,
+    int* nTriangles
+)
+{
+    vbapGainTable3D_data* h;
+    int i, j, N_azi, N_ele;
+    
+    h = (vbapGainTable3D_data*)malloc1d(sizeof(vbapGainTable3D_data));
+    *phVBAP = (void*)h;
+    h->L = L;
+    h->omitLargeTriangles = omitLargeTriangles;
+    h->enableDummies = enableDummies;
+    h->spread = spread;
+    h->ls_dirs_deg = NULL;
+    h->vertices = NULL;
+    h->hConvHull = NULL;
+    h->faces = NULL;
+    h->layoutInvMtx = NULL;
+    h->hFaceIdx = NULL;
+    
+    /* directions of the table points (the same grid as generateVBAPgainTable3D) */
+    N_azi = (int)((360.0f/(float)az_res_deg) + 1.5f);
+    N_ele = (int)((180.0f/(float)el_res_deg) + 1.5f);
+    h->N_points = N_azi*N_ele;
+    h->src_dirs = malloc1d(h->N_points*2*sizeof(float));
+    h->rowNnz = calloc1d(h->N_points, sizeof(int));
+    for(i = 0; i<N_ele; i++){
+        for(j=0; j<N_azi; j++){
+            h->src_dirs[(i*N_azi + j)*2]   = -180.0f + (float)(j*az_res_deg);
+            h->src_dirs[(i*N_azi + j)*2+1] = -90.0f + (float)(i*el_res_deg);
+        }
+    }
+    
+    (*vbap_gtableComp) = NULL;
+    (*vbap_gtableIdx) = NULL;
+    vbapGainTable3D_init(h, ls_dirs_deg, vbap_gtableComp, vbap_gtableIdx, nnz);
+    (*N_gtable) = h->N_points;
+    (*nTriangles) = h->nFaces;
+}
+
+void vbapGainTable3D_destroy
+(
+    void** const phVBAP
+)
+{
+    vbapGainTable3D_data *h = (vbapGainTable3D_data*)(*phVBAP);
+    
+    if (h != NULL) {
+        free1d((void**)&(h->ls_dirs_deg));
+        free1d((void**)&(h->vertices));
+        free1d((void**)&(h->faces));
+        free1d((void**)&(h->layoutInvMtx));
+        faceIndex3D_destroy(&(h->hFaceIdx));
+        convhull_3d_destroy(&(h->hConvHull));
+        free(h->src_dirs);
+        free(h->rowNnz);
+        free(h);
+        h = NULL;
+        *phVBAP = NULL;
+    }
+}
+
+int vbapGainTable3D_update
+(
+    void* const hVBAP,
+    float* ls_dirs_deg,
+    int L,
+    float spread,
+    float** vbap_gtableComp,
+    int** vbap_gtableIdx,
+    int* nnz,
+    int* N_gtable,
+    int* nTriangles
+)
+{
+    vbapGainTable3D_data *h = (vbapGainTable3D_data*)(hVBAP);
+    int i, j, k, n, nt, ls, nMoved, nVertices, nHullFaces, nFaces, nChanged, nCaps, nRows, cmp, allRows, dummiesChanged;
+    int* hullFaces, *faces, *changed, *changedOld, *changedFaces, *rows;
+    float spread_rad, norm, cosR, rad, azi_rad, elev_rad;
+    float *ls_dirs_d_deg, *layoutInvMtx, *changedInvMtx, *oldVertices, *capVerts, *capCentre, *capCosRad, u[3];
+    ch_vertex vertex;
+    
+    (*N_gtable) = h->N_points;
+    
+    /* find which loudspeakers have moved */
+    nMoved = 0;
+    ls = -1;
+    if(L==h->L && spread==h->spread){
+        for(i=0; i<L; i++){
+            if(ls_dirs_deg[i*2]!=h->ls_dirs_deg[i*2] || ls_dirs_deg[i*2+1]!=h->ls_dirs_deg[i*2+1]){
+                nMoved++;
+                ls = i;
+            }
+        }
+        if(nMoved==0 && (*vbap_gtableComp)!=NULL){
+            (*nTriangles) = h->nFaces;
+            return 0;
+        }
+    }
+    
+    /* everything is re-computed if the number of loudspeakers, the spread, or the dummies (their number or their
+     * directions) have changed, or if more than one loudspeaker has moved */
+    getLsDirsWithDummies(ls_dirs_deg, L, h->enableDummies, &ls_dirs_d_deg, &nVertices);
+    dummiesChanged = L!=h->L || nVertices!=h->nVertices;
+    for(i=L; i<nVertices && !dummiesChanged; i++)
+        if(ls_dirs_d_deg[i*2]!=h->ls_dirs_deg[i*2] || ls_dirs_d_deg[i*2+1]!=h->ls_dirs_deg[i*2+1])
+            dummiesChanged = 1;
+    free(ls_dirs_d_deg);
+    if(L!=h->L || spread!=h->spread || dummiesChanged || nMoved!=1 || (*vbap_gtableComp)==NULL){
+        h->L = L;
+        h->spread = spread;
+        vbapGainTable3D_init(h, ls_dirs_deg, vbap_gtableComp, vbap_gtableIdx, nnz);
+        (*nTriangles) = h->nFaces;
+        return h->N_points;
+    }
+    
+    /* move the loudspeaker, and update the convex hull (only the triangles around it are replaced) */
+    oldVertices = malloc1d(h->nVertices*3*sizeof(float));
+    memcpy(oldVertices, h->vertices, h->nVertices*3*sizeof(float));
+    memcpy(&(h->ls_dirs_deg[ls*2]), &ls_dirs_deg[ls*2], 2*sizeof(float));
+    vbapGainTable3D_setVertex(h, ls);
+    for(j=0; j<3; j++)
+        vertex.v[j] = h->vertices[ls*3+j];
+    convhull_3d_moveVertex(h->hConvHull, ls, vertex);
+    convhull_3d_getFaces(h->hConvHull, &hullFaces, &nHullFaces);
+    filterLsTriplets(h->vertices, h->nVertices, hullFaces, nHullFaces, h->omitLargeTriangles, &faces, &nFaces);
+    free(hullFaces);
+    if(nFaces==0){
+        free(faces);
+        free(oldVertices);
+        vbapGainTable3D_init(h, ls_dirs_deg, vbap_gtableComp, vbap_gtableIdx, nnz);
+        (*nTriangles) = h->nFaces;
+        return h->N_points;
+    }
+    
+    /* compare the old and new triangles (both are sorted by their first, and then second, vertex index). A triangle has
+     * changed if it is not in both sets, or if it includes the moved loudspeaker */
+    changed = calloc1d(nFaces, sizeof(int));
+    changedOld = calloc1d(h->nFaces, sizeof(int));
+    layoutInvMtx = malloc1d(nFaces*9*sizeof(float));
+    for(i=0, j=0; i<nFaces || j<h->nFaces;){
+        if(i==nFaces)
+            cmp = 1;
+        else if(j==h->nFaces)
+            cmp = -1;
+        else{
+            for(k=0, cmp=0; k<3 && cmp==0; k++)
+                cmp = faces[i*3+k] < h->faces[j*3+k] ? -1 : (faces[i*3+k] > h->faces[j*3+k] ? 1 : 0);
+        }
+        if(cmp<0)
+            changed[i++] = 1;
+        else if(cmp>0)
+            changedOld[j++] = 1;
+        else{
+            if(faces[i*3+0]==ls || faces[i*3+1]==ls || faces[i*3+2]==ls)
+                changed[i] = changedOld[j] = 1;
+            else
+                memcpy(&layoutInvMtx[i*9], &(h->layoutInvMtx[j*9]), 9*sizeof(float));
+            i++;
+            j++;
+        }
+    }
+    
+    /* invert the loudspeaker matrices of only the new triangles */
+    for(i=0, nChanged=0; i<nFaces; i++)
+        nChanged += changed[i];
+    changedFaces = malloc1d(MAX(nChanged,1)*3*sizeof(int));
+    for(i=0, n=0; i<nFaces; i++)
+        if(changed[i])
+            memcpy(&changedFaces[(n++)*3], &faces[i*3], 3*sizeof(int));
+    changedInvMtx = NULL;
+    invertLsMtx3D(h->vertices, changedFaces, nChanged, &changedInvMtx);
+    for(i=0, n=0; i<nFaces; i++)
+        if(changed[i])
+            memcpy(&layoutInvMtx[i*9], &changedInvMtx[(n++)*9], 9*sizeof(float));
+    
+    /* the vertices of the new triangles, followed by those of the removed triangles (at their old positions) */
+    for(j=0, nCaps=nChanged; j<h->nFaces; j++)
+        nCaps += changedOld[j];
+    capVerts = malloc1d(MAX(nCaps,1)*9*sizeof(float));
+    for(n=0; n<nChanged; n++)
+        for(k=0; k<3; k++)
+            memcpy(&capVerts[n*9+k*3], &(h->vertices[changedFaces[n*3+k]*3]), 3*sizeof(float));
+    for(j=0; j<h->nFaces; j++){
+        if(changedOld[j]){
+            for(k=0; k<3; k++)
+                memcpy(&capVerts[n*9+k*3], &oldVertices[h->faces[j*3+k]*3], 3*sizeof(float));
+            n++;
+        }
+    }
+    
+    /* bounding caps of these triangles, enlarged by the spread (the MDAP auxiliary sources lie at spread/2 from the
+     * source direction). Triangles which are too large to be bounded in this way may affect any point */
+    capCentre = malloc1d(MAX(nCaps,1)*3*sizeof(float));
+    capCosRad = malloc1d(MAX(nCaps,1)*sizeof(float));
+    spread_rad = spread > 0.1f ? (spread/2.0f)*M_PI/180.0f : 0.0f;
+    allRows = 0;
+    for(n=0; n<nCaps; n++){
+        for(j=0; j<3; j++)
+            capCentre[n*3+j] = capVerts[n*9+j] + capVerts[n*9+3+j] + capVerts[n*9+6+j];
+        norm = sqrtf(capCentre[n*3+0]*capCentre[n*3+0] + capCentre[n*3+1]*capCentre[n*3+1] + capCentre[n*3+2]*capCentre[n*3+2]);
+        for(j=0; j<3; j++)
+            capCentre[n*3+j] = norm > 2.23e-7f ? capCentre[n*3+j]/norm : 0.0f;
+        cosR = 1.0f;
+        for(k=0; k<3; k++)
+            cosR = MIN(cosR, capCentre[n*3+0]*capVerts[n*9+k*3+0] + capCentre[n*3+1]*capVerts[n*9+k*3+1] + capCentre[n*3+2]*capVerts[n*9+k*3+2]);
+        rad = acosf(MIN(MAX(cosR, -1.0f), 1.0f)) + spread_rad + VBAP_FACE_INDEX_MARGIN_RAD;
+        if(cosR <= 0.0f || rad >= M_PI)
+            allRows = 1;
+        else
+            capCosRad[n] = cosf(rad);
+    }
+    
+    /* only the points within these caps need to be re-computed */
+    rows = malloc1d(h->N_points*sizeof(int));
+    for(nt=0, nRows=0; nt<h->N_points; nt++){
+        if(!allRows){
+            azi_rad  = h->src_dirs[nt*2+0]*M_PI/180.0f;
+            elev_rad = h->src_dirs[nt*2+1]*M_PI/180.0f;
+            u[0] = cosf(azi_rad)*cosf(elev_rad);
+            u[1] = sinf(azi_rad)*cosf(elev_rad);
+            u[2] = sinf(elev_rad);
+            for(n=0; n<nCaps; n++)
+                if(u[0]*capCentre[n*3+0] + u[1]*capCentre[n*3+1] + u[2]*capCentre[n*3+2] >= capCosRad[n])
+                    break;
+            if(n==nCaps)
+                continue;
+        }
+        rows[nRows++] = nt;
+    }
+    
+    /* replace the triangulation, and re-compute the affected points */
+    free1d((void**)&(h->faces));
+    free1d((void**)&(h->layoutInvMtx));
+    h->faces = faces;
+    h->nFaces = nFaces;
+    h->layoutInvMtx = layoutInvMtx;
+    faceIndex3D_destroy(&(h->hFaceIdx));
+    faceIndex3D_create(&(h->hFaceIdx), h->vertices, h->faces, h->nFaces);
+    vbapGainTable3D_computeRows(h, rows, nRows, vbap_gtableComp, vbap_gtableIdx, nnz);
+    (*nTriangles) = h->nFaces;
+    
+    free(oldVertices);
+    free(changed);
+    free(changedOld);
+    free(changedFaces);
+    free1d((void**)&(changedInvMtx));
+    free(capVerts);
+    free(capCentre);
+    free(capCosRad);
+    free(rows);
+    return nRows;
+}
+
 void compressVBAPgainTable3D
 (
     float* vbap_gtable,
@@ -352,6 +885,41 @@ void compressVBAPgainTable3D
 #endif
 }
 
+void compressVBAPgainTable
+(
+    float* vbap_gtable,
+    int nTable,
+    int nDirs,
+    int* nnz,
+    float** vbap_gtableComp, /* & nTable x nnz  */
+    int** vbap_gtableIdx     /* & nTable x nnz  */
+)
+{
+    int i, j, nt;
+    
+    /* find the largest number of non-zero gains per point (3 for VBAP, 2 for 2-D VBAP, more for MDAP) */
+    (*nnz) = 1;
+    for(nt=0; nt<nTable; nt++){
+        for(i=0, j=0; i<nDirs; i++)
+            if(vbap_gtable[nt*nDirs+i]>0.0000001f)
+                j++;
+        (*nnz) = MAX((*nnz), j);
+    }
+    
+    /* compress table by keeping only the non-zero gains and their indices (zero-padded to nnz per point) */
+    (*vbap_gtableComp) = calloc1d(nTable*(*nnz), sizeof(float));
+    (*vbap_gtableIdx) = calloc1d(nTable*(*nnz), sizeof(int));
+    for(nt=0; nt<nTable; nt++){
+        for(i=0, j=0; i<nDirs; i++){
+            if(vbap_gtable[nt*nDirs+i]>0.0000001f){
+                (*vbap_gtableComp)[nt*(*nnz)+j] = vbap_gtable[nt*nDirs+i];
+                (*vbap_gtableIdx)[nt*(*nnz)+j] = i;
+                j++;
+            }
+        }
+    }
+}
+
 void VBAPgainTable2InterpTable
 (
     float* vbap_gtable,
@@ -118,6 +118,176 @@ void generateVBAPgainTable3D(/* Input arguments */
                              int* N_gtable,
                              int* nTriangles);
 
+/*
+ * Function: vbapGains_create
+ * --------------------------
+ * Creates a handle for the direct (table-free) computation of 3-D VBAP gains.
+ * The loudspeaker triangulation, the inverted loudspeaker matrices, and a
+ * triangle look-up structure are computed once, after which the gains for any
+ * direction may be computed on demand with "vbapGains_get".
+ * Note: the gains are identical to those of "generateVBAPgainTable3D_srcs"
+ * (ENERGY normalised; i.e. sum(gains^2) = 1), but without the quantisation of
+ * the source directions that occurs when using a gain table.
+ * Further Note: the handle holds scratch memory, so it should not be used by
+ * more than one thread at a time.
+ *
+ * Input Arguments:
+ *     phVBAP             - & address of the vbapGains handle
+ *     ls_dirs_deg        - Loudspeaker directions in DEGREES; FLAT: L x 2
+ *     L                  - number of loudspeakers
+ *     omitLargeTriangles - 0: normal triangulation, 1: remove large triangles
+ *     enableDummies      - 0: disabled, 1: enabled. Dummies are placed at +/-90
+ *                          elevation if required
+ *     spread             - spreading factor in DEGREES, 0: VBAP, >0: MDAP
+ */
+void vbapGains_create(void** const phVBAP,
+                      float* ls_dirs_deg,
+                      int L,
+                      int omitLargeTriangles,
+                      int enableDummies,
+                      float spread);
+
+/*
+ * Function: vbapGains_destroy
+ * ---------------------------
+ * Destroys an instance of vbapGains
+ *
+ * Input Arguments:
+ *     phVBAP - & address of the vbapGains handle
+ */
+void vbapGains_destroy(void** const phVBAP);
+
+/*
+ * Function: vbapGains_get
+ * -----------------------
+ * Computes the 3-D VBAP gains for one source direction
+ *
+ * Input Arguments:
+ *     hVBAP        - vbapGains handle
+ *     src_azi_deg  - source azimuth in DEGREES
+ *     src_elev_deg - source elevation in DEGREES
+ * Output Arguments:
+ *     gains        - The VBAP gains ENERGY NORMALISED; L x 1
+ */
+void vbapGains_get(/* Input arguments */
+                   void* const hVBAP,
+                   float src_azi_deg,
+                   float src_elev_deg,
+                   /* Output arguments */
+                   float* gains);
+
+/*
+ * Function: vbapGains_getBatch
+ * ----------------------------
+ * Computes the 3-D VBAP gains for multiple source directions
+ *
+ * Input Arguments:
+ *     hVBAP        - vbapGains handle
+ *     src_dirs_deg - Source directions in DEGREES; FLAT: nSrcs x 2
+ *     nSrcs        - number of sources
+ * Output Arguments:
+ *     gains        - The VBAP gains ENERGY NORMALISED; FLAT: nSrcs x L
+ */
+void vbapGains_getBatch(/* Input arguments */
+                        void* const hVBAP,
+                        float* src_dirs_deg,
+                        int nSrcs,
+                        /* Output arguments */
+                        float* gains);
+
+/*
+ * Function: vbapGainTable3D_create
+ * --------------------------------
+ * Creates an instance of a 3-D VBAP gain table, which is generated for the
+ * same grid as generateVBAPgainTable3D, and returned in the compressed form of
+ * compressVBAPgainTable (ENERGY normalised, "nnz" entries per point). The
+ * instance retains the triangulation, so that the table may later be updated
+ * with vbapGainTable3D_update.
+ * Note: if the triangulation fails, the tables are NULL and nnz=0
+ *
+ * Input Arguments:
+ *     phVBAP             - & address of the vbapGainTable3D handle
+ *     ls_dirs_deg        - Loudspeaker directions in DEGREES; FLAT: L x 2
+ *     L                  - number of loudspeakers
+ *     az_res_deg         - azimuthal resolution in DEGREES
+ *     el_res_deg         - elevation resolution in DEGREES
+ *     omitLargeTriangles - 0: normal triangulation, 1: remove large triangles
+ *     enableDummies      - 0: disabled, 1: enabled. Dummies are placed at
+ *                          +/-90 elevation if required
+ *     spread             - spreading in degrees, 0: VBAP, >0: MDAP
+ * Output Arguments:
+ *     vbap_gtableComp    - & The compressed VBAP gain table; FLAT: N_gtable x
+ *                          nnz
+ *     vbap_gtableIdx     - & The loudspeaker indices for the compressed VBAP
+ *                          gain table; FLAT: N_gtable x nnz
+ *     nnz                - & number of entries per point
+ *     N_gtable           - & number of points in the gain table
+ *     nTriangles         - & number of loudspeaker triangles
+ */
+void vbapGainTable3D_create(/* Input arguments */
+                            void** const phVBAP,
+                            float* ls_dirs_deg,
+                            int L,
+                            int az_res_deg,
+                            int el_res_deg,
+                            int omitLargeTriangles,
+                            int enableDummies,
+                            float spread,
+                            /* Output arguments */
+                            float** vbap_gtableComp,
+                            int** vbap_gtableIdx,
+                            int* nnz,
+                            int* N_gtable,
+                            int* nTriangles);
+
+/*
+ * Function: vbapGainTable3D_destroy
+ * ---------------------------------
+ * Destroys an instance of a 3-D VBAP gain table (the tables themselves belong
+ * to the caller, and are not freed)
+ *
+ * Input Arguments:
+ *     phVBAP - & address of the vbapGainTable3D handle
+ */
+void vbapGainTable3D_destroy(void** const phVBAP);
+
+/*
+ * Function: vbapGainTable3D_update
+ * --------------------------------
+ * Updates the tables returned by vbapGainTable3D_create for new loudspeaker
+ * directions. If only one loudspeaker has moved, then only the triangles
+ * around it are replaced (and inverted), and only the points lying near the
+ * replaced triangles are re-computed; otherwise, the whole table is
+ * re-computed. "nnz" remains the maximum number of non-zero gains of any point
+ * (i.e. the same as for a newly created table), and the tables are re-allocated
+ * whenever it changes.
+ *
+ * Input Arguments:
+ *     hVBAP           - vbapGainTable3D handle
+ *     ls_dirs_deg     - Loudspeaker directions in DEGREES; FLAT: L x 2
+ *     L               - number of loudspeakers
+ *     spread          - spreading in degrees, 0: VBAP, >0: MDAP
+ *     vbap_gtableComp - & The compressed VBAP gain table (updated in-place)
+ *     vbap_gtableIdx  - & The loudspeaker indices (updated in-place)
+ *     nnz             - & number of entries per point (updated in-place)
+ * Output Arguments:
+ *     N_gtable        - & number of points in the gain table
+ *     nTriangles      - & number of loudspeaker triangles
+ * Returns:
+ *     the number of points that were re-computed
+ */
+int vbapGainTable3D_update(/* Input arguments */
+                           void* const hVBAP,
+                           float* ls_dirs_deg,
+                           int L,
+                           float spread,
+                           float** vbap_gtableComp,
+                           int** vbap_gtableIdx,
+                           int* nnz,
+                           /* Output arguments */
+                           int* N_gtable,
+                           int* nTriangles);
+
 /*
  * Function: compressVBAPgainTable3D
  * ---------------------------------
@@ -157,6 +327,42 @@ void compressVBAPgainTable3D(/* Input arguments */
                              float* vbap_gtableComp,
                              int* vbap_gtableIdx);
 
+/*
+ * Function: compressVBAPgainTable
+ * -------------------------------
+ * Compresses a VBAP gain table (3-D, 2-D, or MDAP) by keeping only the
+ * non-zero gains of each point and the indices of their loudspeakers. Unlike
+ * compressVBAPgainTable3D, the gains are NOT re-normalised, i.e. ENERGY
+ * normalised tables remain ENERGY normalised. Each point is given "nnz"
+ * entries (3 for VBAP, 2 for 2-D VBAP, more with MDAP spreading); unused
+ * entries have a gain of 0 and an index of 0, so the gains should be
+ * accumulated (or the zero entries skipped) when expanding a point.
+ * If 'vbap_gtable' is generated by generateVBAPgainTable3D, then the compressed
+ * tables should be accessed as:
+ *      idx3d = elevIndex * N_azi + aziIndex;
+ *      memset(gains3D, 0, L*sizeof(float));
+ *      for (i = 0; i < nnz; i++)
+ *          gains3D[vbap_gtableIdx[idx3d*nnz+i]] += vbap_gtableComp[idx3d*nnz+i];
+ *
+ * Input Arguments:
+ *     vbap_gtable     - The VBAP gain table; FLAT: nTable x nDirs
+ *     nTable          - number of points in the gain table
+ *     nDirs           - number of loudspeakers
+ * Output Arguments:
+ *     nnz             - & number of entries per point
+ *     vbap_gtableComp - & The compressed VBAP gain table; FLAT: nTable x nnz
+ *     vbap_gtableIdx  - & The loudspeaker indices for the compressed VBAP gain
+ *                       table; FLAT: nTable x nnz
+ */
+void compressVBAPgainTable(/* Input arguments */
+                           float* vbap_gtable,
+                           int nTable,
+                           int nDirs,
+                           /* Output arguments */
+                           int* nnz,
+                           float** vbap_gtableComp,
+                           int** vbap_gtableIdx);
+
 /*
  * Function: VBAPgainTable2InterpTable
  * -----------------------------------
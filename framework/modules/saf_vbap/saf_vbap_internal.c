@@ -34,6 +34,21 @@ static void ccross(float a[3], float b[3], float c[3]){
     c[2] = a[0]*b[1]-a[1]*b[0];
 }
 
+typedef struct _vbap_sort_face {
+    int v[3];
+    int idx;
+}vbap_sort_face;
+
+/* orders faces by their first, and then their second, vertex index. Ties are broken by the original position of
+ * the faces, so that the result is the same as that of a stable sort */
+static int cmp_asc_face(const void *a, const void *b) {
+    vbap_sort_face *f1 = (vbap_sort_face*)a;
+    vbap_sort_face *f2 = (vbap_sort_face*)b;
+    if((*f1).v[0]!=(*f2).v[0]) return (*f1).v[0]<(*f2).v[0] ? -1 : 1;
+    if((*f1).v[1]!=(*f2).v[1]) return (*f1).v[1]<(*f2).v[1] ? -1 : 1;
+    return (*f1).idx<(*f2).idx ? -1 : ((*f1).idx>(*f2).idx ? 1 : 0);
+}
+
 void findLsTriplets
 (
     float* ls_dirs_deg,
@@ -45,11 +60,8 @@ void findLsTriplets
     int* numOutFaces
 )
 {
-    int i, j, k, numValidFaces, minIntVal, minIdx, nFaces;
-    int tmp3[3], circface[3];
-    int* validFacesID, *valid_faces, *valid_faces2, *faces;
-    float dotcc, aperture_lim;
-    float vecs[3][3], cvec[3], centroid[3], a[3], b[3], abc[3];
+    int i, nFaces;
+    int* faces;
     CH_FLOAT  rcoselev;
     ch_vertex* vertices;
     
@@ -74,7 +86,33 @@ void findLsTriplets
         saf_error_print(SAF_ERROR__FAILED_TO_BUILD_CONVEX_HULL);
 #endif
     
+    /* sort and validate the triangles */
+    filterLsTriplets(*out_vertices, L, faces, nFaces, omitLargeTriangles, out_faces, numOutFaces);
+    
+    /* clean-up */
+    free1d((void**)&(faces));
+    free(vertices);
+}
+
+void filterLsTriplets
+(
+    float* vertices,
+    int L,
+    int* faces,
+    int nFaces,
+    int omitLargeTriangles,
+    int** out_faces,
+    int* numOutFaces
+)
+{
+    int i, j, k, numValidFaces, minIntVal, minIdx;
+    int circface[3];
+    float dotcc, cos_aperture_lim;
+    float vecs[3][3], cvec[3], centroid[3], a[3], b[3];
+    vbap_sort_face* sfaces;
+    
     /* circularily shift the indices to start from lowest value */
+    sfaces = malloc1d(MAX(nFaces,1)*sizeof(vbap_sort_face));
     for(i=0; i<nFaces; i++){
         minIntVal = L;
         minIdx = 0;
@@ -87,57 +125,23 @@ void findLsTriplets
         for(j=minIdx, k=0; j<minIdx+3; j++, k++)
             circface[k] = faces[i*3+(j % 3)];
         for(j=0; j<3; j++)
-            faces[i*3+j] = circface[j];
-    }
-    
-    /* sort indices in accending order for the first dimension */
-    for (j=0; j<nFaces - 1; j++)  {
-        for (i=0; i<nFaces - 1; i++) {
-            if (faces[(i+1)*3+0] < faces[i*3+0])  {
-                for(k=0; k<3; k++){
-                    tmp3[k] = faces[i*3+k];
-                    faces[i*3+k] = faces[(i+1)*3+k];
-                    faces[(i+1)*3+k] = tmp3[k];
-                }
-            }
-        }
+            sfaces[i].v[j] = circface[j];
+        sfaces[i].idx = i;
     }
     
-    /* sort indices in accending order for the second dimension */
-    for (j=0; j<nFaces - 1; j++)  {
-        for (i=0; i<nFaces - 1; i++) {
-            if ( (faces[(i+1)*3+1] < faces[i*3+1]) && (faces[(i+1)*3+0] == faces[i*3+0]) ) {
-                for(k=0; k<3; k++){
-                    tmp3[k] = faces[i*3+k];
-                    faces[i*3+k] = faces[(i+1)*3+k];
-                    faces[(i+1)*3+k] = tmp3[k];
-                }
-            }
-        }
-    }
-#if 0
-    /* sort indices in accending order for the third dimension */
-    for (j=0; j<nFaces - 1; j++)  {
-        for (i=0; i<nFaces - 1; i++) {
-            if ( (faces[(i+1)*3+2] < faces[i*3+2]) && (faces[(i+1)*3+0] == faces[i*3+0]) && (faces[(i+1)*3+1] == faces[i*3+1])) {
-                for(k=0; k<3; k++){
-                    tmp3[k] = faces[i*3+k];
-                    faces[i*3+k] = faces[(i+1)*3+k];
-                    faces[(i+1)*3+k] = tmp3[k];
-                }
-            }
-        }
-    }
-#endif
+    /* sort indices in accending order for the first dimension, and then the second dimension */
+    qsort(sfaces, nFaces, sizeof(vbap_sort_face), cmp_asc_face);
     
-    /* Omit triplets if their normals and the centroid to the triplets have an angle larger than pi/2 */
+    /* Omit triplets if their normals and the centroid to the triplets have an angle larger than pi/2, and (if
+     * omitLargeTriangles) triangles that have an aperture larger than APERTURE_LIMIT_DEG. Both checks are done
+     * in a single pass, with the valid faces compacted in-place */
+    cos_aperture_lim = cosf(APERTURE_LIMIT_DEG * M_PI/180.0f);
     numValidFaces = 0;
-    validFacesID = malloc1d(nFaces*sizeof(int));
     for(i=0; i<nFaces; i++){
         for(j=0; j<3; j++){
-            vecs[0][j] = (*out_vertices)[faces[i*3+0]*3+j];
-            vecs[1][j] = (*out_vertices)[faces[i*3+1]*3+j];
-            vecs[2][j] = (*out_vertices)[faces[i*3+2]*3+j];
+            vecs[0][j] = vertices[sfaces[i].v[0]*3+j];
+            vecs[1][j] = vertices[sfaces[i].v[1]*3+j];
+            vecs[2][j] = vertices[sfaces[i].v[2]*3+j];
         }
         for(j=0; j<3; j++){
             a[j] = vecs[1][j]-vecs[0][j];
@@ -147,78 +151,26 @@ void findLsTriplets
         for(j=0; j<3; j++)
             centroid[j] = (vecs[0][j] + vecs[1][j] + vecs[2][j])/3.0f;
         dotcc = cvec[0] * centroid[0] + cvec[1] * centroid[1] + cvec[2] * centroid[2];
-        if(acosf(MAX(MIN(dotcc,0.99999999f),-0.99999999f)/* avoids complex numbers */)<(M_PI/2.0f)){
-            validFacesID[i] = 1;
-            numValidFaces++;
-        }
-        else{
-            validFacesID[i] = 0;
-        }
-    }
-    valid_faces = malloc1d(numValidFaces*3*sizeof(int));
-    for(i=0, j=0; i<nFaces; i++){
-        if(validFacesID[i]==1){
-            valid_faces[j*3+0] = faces[i*3+0];
-            valid_faces[j*3+1] = faces[i*3+1];
-            valid_faces[j*3+2] = faces[i*3+2];
-            j++;
-        }
-    }
-    free(validFacesID);
-    
-    /* Omit Triangules that have an aperture larger than APERTURE_LIMIT_DEG */
-    valid_faces2 = NULL;
-    if(omitLargeTriangles) {
-        aperture_lim = APERTURE_LIMIT_DEG * M_PI/180.0f;
-        nFaces = numValidFaces;
-        numValidFaces = 0;
-        validFacesID = malloc1d(nFaces*sizeof(int));
-        for(i=0; i<nFaces; i++){
-            for(j=0; j<3; j++){
-                vecs[0][j] = (*out_vertices)[valid_faces[i*3+0]*3+j];
-                vecs[1][j] = (*out_vertices)[valid_faces[i*3+1]*3+j];
-                vecs[2][j] = (*out_vertices)[valid_faces[i*3+2]*3+j];
-            }
-            dotcc = vecs[0][0] * vecs[1][0] + vecs[0][1] * vecs[1][1] + vecs[0][2] * vecs[1][2];
-            abc[0] = acosf(dotcc);
-            dotcc = vecs[1][0] * vecs[2][0] + vecs[1][1] * vecs[2][1] + vecs[1][2] * vecs[2][2];
-            abc[1] = acosf(dotcc);
-            dotcc = vecs[2][0] * vecs[0][0] + vecs[2][1] * vecs[0][1] + vecs[2][2] * vecs[0][2];
-            abc[2] = acosf(dotcc);
-            if(abc[0]<aperture_lim && abc[1]<aperture_lim && abc[2]<aperture_lim){
-                validFacesID[i] = 1;
-                numValidFaces++;
-            }
-            else{
-                validFacesID[i] = 0;
-            }
+        if(!(dotcc > 0.0f)) /* i.e. acos(dotcc) >= pi/2 */
+            continue;
+        if(omitLargeTriangles){
+            /* i.e. acos(dot) >= APERTURE_LIMIT_DEG, for any of the three edges */
+            if(!(vecs[0][0]*vecs[1][0] + vecs[0][1]*vecs[1][1] + vecs[0][2]*vecs[1][2] > cos_aperture_lim) ||
+               !(vecs[1][0]*vecs[2][0] + vecs[1][1]*vecs[2][1] + vecs[1][2]*vecs[2][2] > cos_aperture_lim) ||
+               !(vecs[2][0]*vecs[0][0] + vecs[2][1]*vecs[0][1] + vecs[2][2]*vecs[0][2] > cos_aperture_lim))
+                continue;
         }
-        valid_faces2 = malloc1d(numValidFaces*3*sizeof(int));
-        for(i=0, j=0; i<nFaces; i++){
-            if(validFacesID[i]==1){
-                valid_faces2[j*3+0] = valid_faces[i*3+0];
-                valid_faces2[j*3+1] = valid_faces[i*3+1];
-                valid_faces2[j*3+2] = valid_faces[i*3+2];
-                j++;
-            }
-        }
-        free(validFacesID);
+        sfaces[numValidFaces++] = sfaces[i];
     }
     
     /* output valid faces */
     (*numOutFaces) = numValidFaces;
     (*out_faces) = (int*)malloc1d(numValidFaces*3*sizeof(int));
-    if(omitLargeTriangles)
-        memcpy((*out_faces), valid_faces2, numValidFaces*3*sizeof(int));
-    else
-        memcpy((*out_faces), valid_faces, numValidFaces*3*sizeof(int));
+    for(i=0; i<numValidFaces; i++)
+        for(j=0; j<3; j++)
+            (*out_faces)[i*3+j] = sfaces[i].v[j];
     
-    /* clean-up */
-    free1d((void**)&(faces));
-    free(vertices);
-    free(valid_faces);
-    if(omitLargeTriangles)
-        free(valid_faces2);
+    free(sfaces);
 }
 
 void invertLsMtx3D
@@ -273,8 +225,7 @@ void getSpreadSrcDirs3D
 {
     int i, j, ns, nr;
     float theta, sin_theta, cos_theta, scale, spread_rad, ring_rad, U_spread_norm;
-    float u[3], u_x_u[3][3], u_x[3][3], R_theta[3][3], uu2[3], spreadbase_ns[3];
-    float* spreadbase;
+    float u[3], u_x_u[3][3], u_x[3][3], R_theta[3][3], uu2[3], tan_ring;
     
     /* rotation matrix using the axis of rotation-angle definition (around source direction) */
     u[0] = cosf(src_elev_rad) * cosf(src_azi_rad);
@@ -293,10 +244,11 @@ void getSpreadSrcDirs3D
         for(j=0; j<3; j++)
             R_theta[i][j] = sin_theta*u_x[i][j] + (1.0f-cos_theta)*u_x_u[i][j] + (i==j ? cos_theta : 0.0f);
 
-    /*  create a ring of sources on the plane that is purpendicular to the source directions */
-    spreadbase = calloc1d(num_src*3, sizeof(float));
+    /*  create a ring of sources on the plane that is purpendicular to the source directions (these are kept in
+     * the first ring of U_spread, so that no additional memory is required) */
+    memset(U_spread, 0, 3*sizeof(float));
     if ((src_elev_rad > M_PI/2.0f-0.01f ) || (src_elev_rad<-(M_PI/2.0f-0.01f)))
-        spreadbase[0] = 1.0f;
+        U_spread[0] = 1.0f;
     else{
         const float u2[3] = {0.0f, 0.0f, 1.0f};
         ccross(u, (float*)u2, uu2);
@@ -305,27 +257,24 @@ void getSpreadSrcDirs3D
             scale += powf(uu2[i],2.0f);
         scale = sqrtf(scale);
         for(i=0; i<3; i++)
-            spreadbase[i] = uu2[i]/scale;
+            U_spread[i] = uu2[i]/scale;
     }
 
     /* get ring of directions by rotating the first vector around the source */
-    for (ns = 1; ns<num_src; ns++){
+    for (ns = 1; ns<num_src; ns++)
         for(i=0; i<3; i++)
-            spreadbase_ns[i] = spreadbase[(ns-1)*3+i];
-        cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, 3, 1, 3, 1.0f,
-                    (const float*)R_theta, 3,
-                    spreadbase_ns, 1, 0.0f,
-                    &spreadbase[ns*3], 1);
-    }
+            U_spread[ns*3+i] = R_theta[i][0]*U_spread[(ns-1)*3+0] + R_theta[i][1]*U_spread[(ns-1)*3+1] + R_theta[i][2]*U_spread[(ns-1)*3+2];
     
-    /* squeeze the perpendicular ring to the desired spread */
+    /* squeeze the perpendicular ring to the desired spread (the outer rings first, as the inner-most ring is
+     * over-written by the last iteration) */
     spread_rad = (spread/2.0f)*M_PI/180.0f;
     ring_rad = spread_rad/(float)num_rings_3d;
-    memset(U_spread, 0, num_rings_3d*num_src*3*sizeof(float));
-    for(nr=0; nr<num_rings_3d; nr++)
+    for(nr=num_rings_3d-1; nr>=0; nr--){
+        tan_ring = tanf(ring_rad*(float)(nr+1));
         for (ns = 0; ns<num_src; ns++)
             for(i=0; i<3; i++)
-                U_spread[(nr*num_src + ns)*3 + i] = u[i] + spreadbase[ns*3+i]*tanf(ring_rad*(float)(nr+1));
+                U_spread[(nr*num_src + ns)*3 + i] = u[i] + U_spread[ns*3+i]*tan_ring;
+    }
  
     /* normalise vectors to unity (based on first vector) */
     U_spread_norm = sqrtf(powf(U_spread[0],2.0f) + powf(U_spread[1],2.0f) + powf(U_spread[2],2.0f));
@@ -335,29 +284,294 @@ void getSpreadSrcDirs3D
     /* append the original source direction at the end */
     for(i=0; i<3; i++)
         U_spread[(num_rings_3d*num_src)*3 + i] = u[i];
+}
 
-    free(spreadbase);
+
+typedef struct _faceIndex3D_data {
+    int nCells;
+    int* cellStart;          /* first candidate of each cell; (nCells+1) x 1 */
+    int* cellFaces;          /* candidate faces, in ascending order per cell; cellStart[nCells] x 1 */
+    
+}faceIndex3D_data;
+
+/* returns the index of the cube-map cell which contains the direction "u" */
+static int faceIndex3D_getCell(float u[3])
+{
+    int k, k1, k2, ia, ib;
+    float absu;
+    
+    /* major axis -> cube face */
+    k = fabsf(u[0]) >= fabsf(u[1]) ? (fabsf(u[0]) >= fabsf(u[2]) ? 0 : 2) : (fabsf(u[1]) >= fabsf(u[2]) ? 1 : 2);
+    k1 = (k+1)%3;
+    k2 = (k+2)%3;
+    absu = MAX(fabsf(u[k]), 2.23e-13f);
+    
+    /* gnomonic coordinates on the cube face -> cell */
+    ia = (int)((u[k1]/absu + 1.0f) * 0.5f * (float)VBAP_FACE_INDEX_RES);
+    ib = (int)((u[k2]/absu + 1.0f) * 0.5f * (float)VBAP_FACE_INDEX_RES);
+    ia = MIN(MAX(ia, 0), VBAP_FACE_INDEX_RES-1);
+    ib = MIN(MAX(ib, 0), VBAP_FACE_INDEX_RES-1);
+    return ((k*2 + (u[k] >= 0.0f ? 1 : 0))*VBAP_FACE_INDEX_RES + ia)*VBAP_FACE_INDEX_RES + ib;
 }
 
+void faceIndex3D_create
+(
+    void** const phFI,
+    float* U_spkr,
+    int* ls_groups,
+    int nFaces
+)
+{
+    faceIndex3D_data* h;
+    int i, j, k, k1, k2, ia, ib, cell, nCand, maxCand;
+    float norm, cosRc, faceRad, cellRad;
+    float *faceCentre, *faceCosR, *cellCentre, *cellCosR, corner[3], ab[2];
+    
+    h = (faceIndex3D_data*)malloc1d(sizeof(faceIndex3D_data));
+    *phFI = (void*)h;
+    h->nCells = 6*VBAP_FACE_INDEX_RES*VBAP_FACE_INDEX_RES;
+    
+    /* bounding cap of each loudspeaker triangle: centred on the normalised sum of its vertices, with a radius equal
+     * to the largest angle to a vertex. Triangles too large to be bounded this way are candidates for every cell */
+    faceCentre = malloc1d(nFaces*3*sizeof(float));
+    faceCosR = malloc1d(nFaces*sizeof(float));
+    for(i=0; i<nFaces; i++){
+        for(j=0; j<3; j++)
+            faceCentre[i*3+j] = U_spkr[ls_groups[i*3+0]*3+j] + U_spkr[ls_groups[i*3+1]*3+j] + U_spkr[ls_groups[i*3+2]*3+j];
+        norm = sqrtf(faceCentre[i*3+0]*faceCentre[i*3+0] + faceCentre[i*3+1]*faceCentre[i*3+1] + faceCentre[i*3+2]*faceCentre[i*3+2]);
+        faceCosR[i] = 1.0f;
+        for(j=0; j<3; j++)
+            faceCentre[i*3+j] = norm > 2.23e-7f ? faceCentre[i*3+j]/norm : 0.0f;
+        for(k=0; k<3; k++)
+            faceCosR[i] = MIN(faceCosR[i], faceCentre[i*3+0]*U_spkr[ls_groups[i*3+k]*3+0] +
+                                           faceCentre[i*3+1]*U_spkr[ls_groups[i*3+k]*3+1] +
+                                           faceCentre[i*3+2]*U_spkr[ls_groups[i*3+k]*3+2]);
+    }
+    
+    /* bounding cap of each cube-map cell (the cell is a spherical quadrilateral, bounded by its corners) */
+    cellCentre = malloc1d(h->nCells*3*sizeof(float));
+    cellCosR = malloc1d(h->nCells*sizeof(float));
+    for(k=0; k<3; k++){
+        k1 = (k+1)%3;
+        k2 = (k+2)%3;
+        for(j=0; j<2; j++){
+            for(ia=0; ia<VBAP_FACE_INDEX_RES; ia++){
+                for(ib=0; ib<VBAP_FACE_INDEX_RES; ib++){
+                    cell = ((k*2 + j)*VBAP_FACE_INDEX_RES + ia)*VBAP_FACE_INDEX_RES + ib;
+                    cellCentre[cell*3+k] = j==1 ? 1.0f : -1.0f;
+                    cellCentre[cell*3+k1] = 2.0f*((float)ia+0.5f)/(float)VBAP_FACE_INDEX_RES - 1.0f;
+                    cellCentre[cell*3+k2] = 2.0f*((float)ib+0.5f)/(float)VBAP_FACE_INDEX_RES - 1.0f;
+                    norm = sqrtf(cellCentre[cell*3+0]*cellCentre[cell*3+0] + cellCentre[cell*3+1]*cellCentre[cell*3+1] + cellCentre[cell*3+2]*cellCentre[cell*3+2]);
+                    for(i=0; i<3; i++)
+                        cellCentre[cell*3+i] /= norm;
+                    cellCosR[cell] = 1.0f;
+                    for(i=0; i<4; i++){
+                        ab[0] = 2.0f*(float)(ia + i%2)/(float)VBAP_FACE_INDEX_RES - 1.0f;
+                        ab[1] = 2.0f*(float)(ib + i/2)/(float)VBAP_FACE_INDEX_RES - 1.0f;
+                        corner[k] = j==1 ? 1.0f : -1.0f;
+                        corner[k1] = ab[0];
+                        corner[k2] = ab[1];
+                        norm = sqrtf(corner[0]*corner[0] + corner[1]*corner[1] + corner[2]*corner[2]);
+                        cellCosR[cell] = MIN(cellCosR[cell], (cellCentre[cell*3+0]*corner[0] + cellCentre[cell*3+1]*corner[1] +
+                                                             cellCentre[cell*3+2]*corner[2])/norm);
+                    }
+                }
+            }
+        }
+    }
+    
+    /* a triangle is a candidate for a cell if their (slightly enlarged) bounding caps overlap */
+    maxCand = h->nCells*8;
+    h->cellStart = malloc1d((h->nCells+1)*sizeof(int));
+    h->cellFaces = malloc1d(maxCand*sizeof(int));
+    nCand = 0;
+    for(cell=0; cell<h->nCells; cell++){
+        h->cellStart[cell] = nCand;
+        cellRad = acosf(MIN(MAX(cellCosR[cell], -1.0f), 1.0f));
+        for(i=0; i<nFaces; i++){
+            if(faceCosR[i] > 0.0f){
+                faceRad = acosf(MIN(faceCosR[i], 1.0f));
+                cosRc = faceCentre[i*3+0]*cellCentre[cell*3+0] + faceCentre[i*3+1]*cellCentre[cell*3+1] + faceCentre[i*3+2]*cellCentre[cell*3+2];
+                if(acosf(MIN(MAX(cosRc, -1.0f), 1.0f)) > faceRad + cellRad + VBAP_FACE_INDEX_MARGIN_RAD)
+                    continue;
+            }
+            if(nCand == maxCand){
+                maxCand *= 2;
+                h->cellFaces = realloc1d(h->cellFaces, maxCand*sizeof(int));
+            }
+            h->cellFaces[nCand++] = i;
+        }
+    }
+    h->cellStart[h->nCells] = nCand;
+    
+    free(faceCentre);
+    free(faceCosR);
+    free(cellCentre);
+    free(cellCosR);
+}
 
-void vbap3D
+void faceIndex3D_destroy
+(
+    void** const phFI
+)
+{
+    faceIndex3D_data *h = (faceIndex3D_data*)(*phFI);
+    
+    if (h != NULL) {
+        free(h->cellStart);
+        free(h->cellFaces);
+        free(h);
+        h = NULL;
+        *phFI = NULL;
+    }
+}
+
+int faceIndex3D_getCandidates
+(
+    void* const hFI,
+    float u[3],
+    int** candidates
+)
+{
+    faceIndex3D_data *h = (faceIndex3D_data*)(hFI);
+    int cell;
+    
+    cell = faceIndex3D_getCell(u);
+    (*candidates) = &(h->cellFaces[h->cellStart[cell]]);
+    return h->cellStart[cell+1] - h->cellStart[cell];
+}
+
+void vbap3D_gainsForDir
+(
+    float u[3],
+    int* ls_groups,
+    int nFaces,
+    float* layoutInvMtx,
+    void* const hFaceIdx,
+    int accumulate,
+    float* gains
+)
+{
+    int i, j, n, nCand;
+    int* cand;
+    float min_val, g_tmp_rms;
+    float g_tmp[3];
+    
+    /* only test the triangles that may contain "u" (or all of them, if there is no face index) */
+    nCand = hFaceIdx != NULL ? faceIndex3D_getCandidates(hFaceIdx, u, &cand) : nFaces;
+    for(n=0; n<nCand; n++){
+        i = hFaceIdx != NULL ? cand[n] : n;
+        for(j=0; j<3; j++)
+            g_tmp[j] = layoutInvMtx[i*9+j*3+0]*u[0] + layoutInvMtx[i*9+j*3+1]*u[1] + layoutInvMtx[i*9+j*3+2]*u[2];
+        min_val = MIN(MIN(g_tmp[0], g_tmp[1]), g_tmp[2]);
+        if(min_val>-0.001){
+            g_tmp_rms = sqrtf(g_tmp[0]*g_tmp[0] + g_tmp[1]*g_tmp[1] + g_tmp[2]*g_tmp[2]);
+            if(accumulate){
+                for(j=0; j<3; j++)
+                    gains[ls_groups[i*3+j]] += g_tmp[j]/g_tmp_rms;
+            }
+            else{
+                for(j=0; j<3; j++)
+                    gains[ls_groups[i*3+j]] = g_tmp[j]/g_tmp_rms;
+                break;
+            }
+        }
+    }
+}
+
+void vbap3D_gainsForDirs
+(
+    float* U,
+    int nDirs,
+    int* ls_groups,
+    int nFaces,
+    float* layoutInvMtx,
+    void* const hFaceIdx,
+    float* gains
+)
+{
+    int i, k, m, n, nb, nBlock, nGroup, nCand, cell;
+    int* cand;
+    float g_tmp_rms;
+    int cells[VBAP3D_DIRS_BLOCK_SIZE], done[VBAP3D_DIRS_BLOCK_SIZE];
+    float ux[VBAP3D_DIRS_BLOCK_SIZE], uy[VBAP3D_DIRS_BLOCK_SIZE], uz[VBAP3D_DIRS_BLOCK_SIZE];
+    float g0[VBAP3D_DIRS_BLOCK_SIZE], g1[VBAP3D_DIRS_BLOCK_SIZE], g2[VBAP3D_DIRS_BLOCK_SIZE];
+    float* inv;
+    
+    for(nb=0; nb<nDirs; nb+=VBAP3D_DIRS_BLOCK_SIZE){
+        nBlock = MIN(VBAP3D_DIRS_BLOCK_SIZE, nDirs-nb);
+        for(k=0; k<nBlock; k++){
+            cells[k] = hFaceIdx != NULL ? faceIndex3D_getCell(&U[(nb+k)*3]) : 0;
+            done[k] = 0;
+        }
+        
+        /* the directions which share the same candidate triangles (usually all of them) are grouped together */
+        for(k=0; k<nBlock; k++){
+            if(done[k])
+                continue;
+            cell = cells[k];
+            for(m=k, nGroup=0; m<nBlock; m++){
+                if(!done[m] && cells[m]==cell){
+                    ux[nGroup] = U[(nb+m)*3+0];
+                    uy[nGroup] = U[(nb+m)*3+1];
+                    uz[nGroup] = U[(nb+m)*3+2];
+                    done[m] = 1;
+                    nGroup++;
+                }
+            }
+            
+            /* each candidate 3x3 matrix is applied to all directions of the group at once (vectorisable), and the
+             * gains of the triangles enclosing the directions are accumulated */
+            if(hFaceIdx != NULL){
+                cand = &(((faceIndex3D_data*)hFaceIdx)->cellFaces[((faceIndex3D_data*)hFaceIdx)->cellStart[cell]]);
+                nCand = ((faceIndex3D_data*)hFaceIdx)->cellStart[cell+1] - ((faceIndex3D_data*)hFaceIdx)->cellStart[cell];
+            }
+            else{
+                cand = NULL;
+                nCand = nFaces;
+            }
+            for(n=0; n<nCand; n++){
+                i = cand != NULL ? cand[n] : n;
+                inv = &layoutInvMtx[i*9];
+                for(m=0; m<nGroup; m++){
+                    g0[m] = inv[0]*ux[m] + inv[1]*uy[m] + inv[2]*uz[m];
+                    g1[m] = inv[3]*ux[m] + inv[4]*uy[m] + inv[5]*uz[m];
+                    g2[m] = inv[6]*ux[m] + inv[7]*uy[m] + inv[8]*uz[m];
+                }
+                for(m=0; m<nGroup; m++){
+                    if(MIN(MIN(g0[m], g1[m]), g2[m])>-0.001){
+                        g_tmp_rms = sqrtf(g0[m]*g0[m] + g1[m]*g1[m] + g2[m]*g2[m]);
+                        gains[ls_groups[i*3+0]] += g0[m]/g_tmp_rms;
+                        gains[ls_groups[i*3+1]] += g1[m]/g_tmp_rms;
+                        gains[ls_groups[i*3+2]] += g2[m]/g_tmp_rms;
+                    }
+                }
+            }
+        }
+    }
+}
+
+/* computes the VBAP gains for sources "first" to "last"-1. Each source is independent of the others, and the
+ * scratch memory is local, so different chunks of sources may be computed concurrently */
+static void vbap3D_chunk
 (
     float* src_dirs,
-    int src_num,
+    int first,
+    int last,
     int ls_num,
     int* ls_groups,
     int nFaces,
     float spread,
     float* layoutInvMtx,
-    float** GainMtx
+    void* const hFaceIdx,
+    float* GainMtx
 )
 {
-    int i, j, ns, nspr;
-    float azi_rad, elev_rad, min_val, g_tmp_rms, gains_rms;
-    float u[3], g_tmp[3], ls_invMtx_s[3];
+    int i, ns;
+    float azi_rad, elev_rad, gains_rms;
+    float u[3];
     float* gains;
-     
-    (*GainMtx) = malloc1d(src_num*ls_num*sizeof(float));
+    
     gains = malloc1d(ls_num*sizeof(float));
     
     /* MDAP (with spread) */
@@ -366,92 +580,73 @@ void vbap3D
         const int nRings = 1;
         float* U_spread;
         U_spread = malloc1d((nRings*nSpreadSrcs+1)*3*sizeof(float));
-        for(ns=0; ns<src_num; ns++){
+        for(ns=first; ns<last; ns++){
             azi_rad  = src_dirs[ns*2+0]*M_PI/180.0f;
             elev_rad = src_dirs[ns*2+1]*M_PI/180.0f;
             getSpreadSrcDirs3D(azi_rad, elev_rad, spread, nSpreadSrcs, nRings, U_spread);
             memset(gains, 0, ls_num*sizeof(float));
-            for(nspr=0; nspr<(nRings*nSpreadSrcs+1); nspr++){
-                u[0] = U_spread[nspr*3+0];
-                u[1] = U_spread[nspr*3+1];
-                u[2] = U_spread[nspr*3+2];
-                for(i=0; i<nFaces; i++){
-                    for(j=0; j<3; j++)
-                        ls_invMtx_s[j] = layoutInvMtx[i*9+j];
-                    utility_svvdot(ls_invMtx_s, u, 3, &g_tmp[0]);
-                    for(j=0; j<3; j++)
-                        ls_invMtx_s[j] = layoutInvMtx[i*9+j+3];
-                    utility_svvdot(ls_invMtx_s, u, 3, &g_tmp[1]);
-                    for(j=0; j<3; j++)
-                        ls_invMtx_s[j] = layoutInvMtx[i*9+j+6];
-                    utility_svvdot(ls_invMtx_s, u, 3, &g_tmp[2]);
-                    min_val = 2.23e13f;
-                    g_tmp_rms = 0.0;
-                    for(j=0; j<3; j++){
-                        min_val = MIN(min_val, g_tmp[j]);
-                        g_tmp_rms +=  powf(g_tmp[j], 2.0f);
-                    }
-                    g_tmp_rms = sqrtf(g_tmp_rms);
-                    if(min_val>-0.001){
-                        for(j=0; j<3; j++)
-                            gains[ls_groups[i*3+j]] += g_tmp[j]/g_tmp_rms;
-                    }
-                }
-            }
+            vbap3D_gainsForDirs(U_spread, nRings*nSpreadSrcs+1, ls_groups, nFaces, layoutInvMtx, hFaceIdx, gains);
             gains_rms = 0.0;
             for(i=0; i<ls_num; i++)
-                gains_rms += powf(gains[i], 2.0f);
+                gains_rms += gains[i]*gains[i];
             gains_rms = sqrtf(gains_rms);
             for(i=0; i<ls_num; i++)
-                (*GainMtx)[ns*ls_num+i] = MAX(gains[i]/gains_rms, 0.0f);
+                GainMtx[ns*ls_num+i] = MAX(gains[i]/gains_rms, 0.0f);
         }
         
         free(U_spread);
     }
     /* VBAP (no spread) */
     else{
-        for(ns=0; ns<src_num; ns++){
+        for(ns=first; ns<last; ns++){
             azi_rad  = src_dirs[ns*2+0]*M_PI/180.0f;
             elev_rad = src_dirs[ns*2+1]*M_PI/180.0f;
             u[0] = cosf(azi_rad)*cosf(elev_rad);
             u[1] = sinf(azi_rad)*cosf(elev_rad);
             u[2] = sinf(elev_rad);
             memset(gains, 0, ls_num*sizeof(float));
-            for(i=0; i<nFaces; i++){
-                for(j=0; j<3; j++)
-                    ls_invMtx_s[j] = layoutInvMtx[i*9+j];
-                utility_svvdot(ls_invMtx_s, u, 3, &g_tmp[0]);
-                for(j=0; j<3; j++)
-                    ls_invMtx_s[j] = layoutInvMtx[i*9+j+3];
-                utility_svvdot(ls_invMtx_s, u, 3, &g_tmp[1]);
-                for(j=0; j<3; j++)
-                    ls_invMtx_s[j] = layoutInvMtx[i*9+j+6];
-                utility_svvdot(ls_invMtx_s, u, 3, &g_tmp[2]);
-                min_val = 2.23e13f;
-                g_tmp_rms = 0.0;
-                for(j=0; j<3; j++){
-                    min_val = MIN(min_val, g_tmp[j]);
-                    g_tmp_rms +=  powf(g_tmp[j], 2.0f);
-                }
-                g_tmp_rms = sqrtf(g_tmp_rms);
-                if(min_val>-0.001){
-                    for(j=0; j<3; j++)
-                        gains[ls_groups[i*3+j]] = g_tmp[j]/g_tmp_rms;
-                    break;
-                }
-            }
+            vbap3D_gainsForDir(u, ls_groups, nFaces, layoutInvMtx, hFaceIdx, 0, gains);
             gains_rms = 0.0;
             for(i=0; i<ls_num; i++)
-                gains_rms += powf(gains[i], 2.0f);
+                gains_rms += gains[i]*gains[i];
             gains_rms = sqrtf(gains_rms);
             for(i=0; i<ls_num; i++)
-                (*GainMtx)[ns*ls_num+i] = MAX(gains[i]/gains_rms, 0.0f);
+                GainMtx[ns*ls_num+i] = MAX(gains[i]/gains_rms, 0.0f);
         }
     }
     
     free(gains);
 }
 
+void vbap3D
+(
+    float* src_dirs,
+    int src_num,
+    int ls_num,
+    int* ls_groups,
+    int nFaces,
+    float spread,
+    float* layoutInvMtx,
+    void* const hFaceIdx,
+    float** GainMtx
+)
+{
+    int n, nChunks;
+     
+    (*GainMtx) = malloc1d(src_num*ls_num*sizeof(float));
+    
+    /* the sources are split into chunks (roughly one elevation row of a 1 degree gain table each), which are
+     * computed in parallel if OpenMP is enabled. Every gain is computed in the same way regardless of the thread
+     * it is computed on, so the table does not depend on the number of threads used */
+    nChunks = (src_num + VBAP3D_CHUNK_SIZE - 1)/VBAP3D_CHUNK_SIZE;
+#ifdef _OPENMP
+#   pragma omp parallel for schedule(dynamic) if(nChunks > 1)
+#endif
+    for(n=0; n<nChunks; n++)
+        vbap3D_chunk(src_dirs, n*VBAP3D_CHUNK_SIZE, MIN((n+1)*VBAP3D_CHUNK_SIZE, src_num), ls_num, ls_groups,
+                     nFaces, spread, layoutInvMtx, hFaceIdx, (*GainMtx));
+}
+
 void findLsPairs
 (
     float* ls_dirs_deg,
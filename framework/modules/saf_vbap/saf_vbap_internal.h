@@ -45,6 +45,19 @@ extern "C" {
 /* if omitLargeTriangles==1, triangles with an aperture larger than this are
  * discarded */
 #define APERTURE_LIMIT_DEG ( 180.0f )
+/* number of cells along each side of each cube face, used by the triangle
+ * look-up structure (6*VBAP_FACE_INDEX_RES^2 cells in total) */
+#define VBAP_FACE_INDEX_RES ( 8 )
+/* in radians, added to the bounding caps of the triangles and cells, so that
+ * directions lying (just) on the edges of triangles are not missed */
+#define VBAP_FACE_INDEX_MARGIN_RAD ( 0.02f )
+/* number of auxiliary sources used for spreading, by the vbapGains handle */
+#define VBAP_GAINS_NUM_SPREAD_SRCS ( 8 )
+/* number of source directions processed per chunk by vbap3D (chunks may be
+ * processed in parallel, if the framework is compiled with OpenMP) */
+#define VBAP3D_CHUNK_SIZE ( 360 )
+/* number of directions evaluated together by vbap3D_gainsForDirs */
+#define VBAP3D_DIRS_BLOCK_SIZE ( 16 )
     
     
 /* ========================================================================== */
@@ -77,6 +90,35 @@ void findLsTriplets(/* Input Arguments */
                     int* numOutVertices,
                     int** out_faces,
                     int* numOutFaces);
+
+/*
+ * Function: filterLsTriplets
+ * --------------------------
+ * Sorts the triangles of a loudspeaker convex-hull, and discards those that
+ * are invalid (i.e. facing inwards, or too large if omitLargeTriangles==1).
+ * Used by findLsTriplets, and when updating a convex-hull incrementally.
+ *
+ * Input Arguments:
+ *     vertices           - loudspeaker directions in cartesian coordinates;
+ *                          FLAT: L x 3
+ *     L                  - number of loudspeakers
+ *     faces              - convex-hull triangle indices; FLAT: nFaces x 3
+ *     nFaces             - number of convex-hull triangles
+ *     omitLargeTriangles - 0: normal triangulation, 1: remove large triangles
+ * Output Arguments:
+ *     out_faces          - & true loudspeaker triangle indices;
+ *                          FLAT: numOutFaces x 3
+ *     numOutFaces        - & number of true loudspeaker triangles
+ */
+void filterLsTriplets(/* Input Arguments */
+                      float* vertices,
+                      int L,
+                      int* faces,
+                      int nFaces,
+                      int omitLargeTriangles,
+                      /* Output Arguments */
+                      int** out_faces,
+                      int* numOutFaces);
     
 /*
  * Function: invertLsMtx3D
@@ -125,11 +167,124 @@ void getSpreadSrcDirs3D(/* Input Arguments */
                         /* Output Arguments */
                         float* U_spread);
     
+/*
+ * Function: faceIndex3D_create
+ * ----------------------------
+ * Creates a look-up structure over the loudspeaker triangles, which returns
+ * the (few) triangles that may contain a given direction. The sphere is
+ * divided into the cells of a cube-map, and each cell lists the triangles
+ * whose bounding caps overlap with that of the cell.
+ *
+ * Input Arguments:
+ *     phFI      - & address of the face index handle
+ *     U_spkr    - loudspeaker directions as cartesian coordinates (unit
+ *                 length); FLAT: L x 3
+ *     ls_groups - true loudspeaker triangle indices; FLAT: nFaces x 3
+ *     nFaces    - number of true loudspeaker triangles
+ */
+void faceIndex3D_create(void** const phFI,
+                        float* U_spkr,
+                        int* ls_groups,
+                        int nFaces);
+
+/*
+ * Function: faceIndex3D_destroy
+ * -----------------------------
+ * Destroys the face index
+ *
+ * Input Arguments:
+ *     phFI - & address of the face index handle
+ */
+void faceIndex3D_destroy(void** const phFI);
+
+/*
+ * Function: faceIndex3D_getCandidates
+ * -----------------------------------
+ * Returns the triangles which may contain a given direction
+ *
+ * Input Arguments:
+ *     hFI        - face index handle
+ *     u          - direction, as a unit-length cartesian vector; 3 x 1
+ * Output Arguments:
+ *     candidates - & candidate triangle indices, in ascending order (points
+ *                  to memory owned by hFI); FLAT: nCandidates x 1
+ * Returns:
+ *     the number of candidate triangles
+ */
+int faceIndex3D_getCandidates(/* Input Arguments */
+                              void* const hFI,
+                              float u[3],
+                              /* Output Arguments */
+                              int** candidates);
+
+/*
+ * Function: vbap3D_gainsForDir
+ * ----------------------------
+ * Calculates the (un-normalised) 3D VBAP gains for a single direction
+ *
+ * Input Arguments:
+ *     u            - direction, as a unit-length cartesian vector; 3 x 1
+ *     ls_groups    - true loudspeaker triangle indices; FLAT: nFaces x 3
+ *     nFaces       - number of true loudspeaker triangles
+ *     layoutInvMtx - inverted 3x3 loudspeaker matrix flattened;
+ *                    FLAT: nFaces x 9
+ *     hFaceIdx     - face index (see "faceIndex3D_create"), or NULL to test
+ *                    all triangles
+ *     accumulate   - 0: the gains of the first enclosing triangle are written,
+ *                    1: the gains of all enclosing triangles are added (MDAP)
+ * Output Arguments:
+ *     gains        - loudspeaker gains; ls_num x 1
+ */
+void vbap3D_gainsForDir(/* Input Arguments */
+                        float u[3],
+                        int* ls_groups,
+                        int nFaces,
+                        float* layoutInvMtx,
+                        void* const hFaceIdx,
+                        int accumulate,
+                        /* Output Arguments */
+                        float* gains);
+
+/*
+ * Function: vbap3D_gainsForDirs
+ * -----------------------------
+ * Accumulates the (un-normalised) 3D VBAP gains of several directions (e.g.
+ * the MDAP spread directions of a source). The directions which fall into
+ * the same cell of the face index are evaluated together, so that each
+ * candidate triangle matrix is applied to all of them in one pass.
+ * The gains are added in a different order than by calling
+ * vbap3D_gainsForDir for each direction, and may therefore differ slightly
+ *
+ * Input Arguments:
+ *     U            - directions, as unit-length cartesian vectors;
+ *                    FLAT: nDirs x 3
+ *     nDirs        - number of directions
+ *     ls_groups    - true loudspeaker triangle indices; FLAT: nFaces x 3
+ *     nFaces       - number of true loudspeaker triangles
+ *     layoutInvMtx - inverted 3x3 loudspeaker matrix flattened;
+ *                    FLAT: nFaces x 9
+ *     hFaceIdx     - face index (see "faceIndex3D_create"), or NULL to test
+ *                    all triangles
+ * Output Arguments:
+ *     gains        - loudspeaker gains (added to); ls_num x 1
+ */
+void vbap3D_gainsForDirs(/* Input Arguments */
+                         float* U,
+                         int nDirs,
+                         int* ls_groups,
+                         int nFaces,
+                         float* layoutInvMtx,
+                         void* const hFaceIdx,
+                         /* Output Arguments */
+                         float* gains);
+
 /*
  * Function: vbap3D
  * ----------------
  * Calculates 3D VBAP gains for pre-calculated loudspeaker triangles and
- * predefined source directions
+ * predefined source directions. The sources are processed in chunks of
+ * VBAP3D_CHUNK_SIZE, in parallel if compiled with OpenMP; the output is the
+ * same regardless of the number of threads.
  *
  * Input Arguments:
  *     src_dirs     - source directions; FLAT: src_num x 2
@@ -140,6 +295,8 @@ void getSpreadSrcDirs3D(/* Input Arguments */
  *     spread       - spreading in degrees, 0: VBAP, >0: MDAP
  *     layoutInvMtx - inverted 3x3 loudspeaker matrix flattened;
  *                    FLAT: nFaces x 9
+ *     hFaceIdx     - face index (see "faceIndex3D_create"), or NULL to test
+ *                    all triangles for each direction
  * Output Arguments:
  *     GainMtx      - & Loudspeaker VBAP gain table; FLAT: src_num x ls_num
  */
@@ -151,6 +308,7 @@ void vbap3D(/* Input Arguments */
             int nFaces,
             float spread,
             float* layoutInvMtx,
+            void* const hFaceIdx,
             /* Output Arguments */
             float** GainMtx);
     
@@ -79,22 +79,12 @@ typedef struct float_w_idx {
     int idx;
 }float_w_idx;
 
-typedef struct int_w_idx {
-    int val;
-    int idx;
-}int_w_idx;
-
 /* internal functions prototypes: */
 static int cmp_asc_float(const void*, const void*);
 static int cmp_desc_float(const void*, const void*);
-static int cmp_asc_int(const void*, const void*);
-static int cmp_desc_int(const void*, const void*);
 static void sort_float(CH_FLOAT*, CH_FLOAT*, int*, int, int);
-static void sort_int(int*, int*, int*, int, int);
 static ch_vec3 cross(ch_vec3*, ch_vec3*);
-static CH_FLOAT det_4x4(CH_FLOAT*);
 static void plane_3d(CH_FLOAT*, CH_FLOAT*, CH_FLOAT*);
-static void ismember(int*, int*, int*, int, int);
 
 /* internal functions definitions: */
 static int cmp_asc_float(const void *a,const void *b) {
@@ -113,22 +103,6 @@ static int cmp_desc_float(const void *a,const void *b) {
     else return 0;
 }
 
-static int cmp_asc_int(const void *a,const void *b) {
-    struct int_w_idx *a1 = (struct int_w_idx*)a;
-    struct int_w_idx *a2 = (struct int_w_idx*)b;
-    if((*a1).val<(*a2).val)return -1;
-    else if((*a1).val>(*a2).val)return 1;
-    else return 0;
-}
-
-static int cmp_desc_int(const void *a,const void *b) {
-    struct int_w_idx *a1 = (struct int_w_idx*)a;
-    struct int_w_idx *a2 = (struct int_w_idx*)b;
-    if((*a1).val>(*a2).val)return -1;
-    else if((*a1).val<(*a2).val)return 1;
-    else return 0;
-}
-
 static void sort_float
 (
     CH_FLOAT* in_vec,  /* vector[len] to be sorted */
@@ -161,38 +135,6 @@ static void sort_float
     free(data);
 }
 
-static void sort_int
-(
-    int* in_vec,     /* vector[len] to be sorted */
-    int* out_vec,    /* if NULL, then in_vec is sorted "in-place" */
-    int* new_idices, /* set to NULL if you don't need them */
-    int len,         /* number of elements in vectors, must be consistent with the input data */
-    int descendFLAG  /* !1:ascending, 1:descending */
-)
-{
-    int i;
-    struct int_w_idx *data;
-    
-    data = (int_w_idx*)malloc(len*sizeof(int_w_idx));
-    for(i=0;i<len;i++) {
-        data[i].val=in_vec[i];
-        data[i].idx=i;
-    }
-    if(descendFLAG)
-        qsort(data,len,sizeof(data[0]),cmp_desc_int);
-    else
-        qsort(data,len,sizeof(data[0]),cmp_asc_int);
-    for(i=0;i<len;i++){
-        if (out_vec!=NULL)
-            out_vec[i] = data[i].val;
-        else
-            in_vec[i] = data[i].val; /* overwrite input vector */
-        if(new_idices!=NULL)
-            new_idices[i] = data[i].idx;
-    }
-    free(data);
-}
-
 static ch_vec3 cross(ch_vec3* v1, ch_vec3* v2)
 {
     ch_vec3 cross;
@@ -202,23 +144,6 @@ static ch_vec3 cross(ch_vec3* v1, ch_vec3* v2)
     return cross;
 }
 
-/* calculates the determinent of a 4x4 matrix */
-static CH_FLOAT det_4x4(CH_FLOAT* m) {
-    return
-    m[3] * m[6] * m[9] * m[12] - m[2] * m[7] * m[9] * m[12] -
-    m[3] * m[5] * m[10] * m[12] + m[1] * m[7] * m[10] * m[12] +
-    m[2] * m[5] * m[11] * m[12] - m[1] * m[6] * m[11] * m[12] -
-    m[3] * m[6] * m[8] * m[13] + m[2] * m[7] * m[8] * m[13] +
-    m[3] * m[4] * m[10] * m[13] - m[0] * m[7] * m[10] * m[13] -
-    m[2] * m[4] * m[11] * m[13] + m[0] * m[6] * m[11] * m[13] +
-    m[3] * m[5] * m[8] * m[14] - m[1] * m[7] * m[8] * m[14] -
-    m[3] * m[4] * m[9] * m[14] + m[0] * m[7] * m[9] * m[14] +
-    m[1] * m[4] * m[11] * m[14] - m[0] * m[5] * m[11] * m[14] -
-    m[2] * m[5] * m[8] * m[15] + m[1] * m[6] * m[8] * m[15] +
-    m[2] * m[4] * m[9] * m[15] - m[0] * m[6] * m[9] * m[15] -
-    m[1] * m[4] * m[10] * m[15] + m[0] * m[5] * m[10] * m[15];
-}
-
 /* Calculates the coefficients of the equation of a PLANE in 3D.
  * Original Copyright (c) 2014, George Papazafeiropoulos
  * Distributed under the BSD (2-clause) license
@@ -266,54 +191,231 @@ static void plane_3d
         (*d) += -p[i] * c[i];
 }
 
-static void ismember
-(
-    int* pLeft,          /* left vector; nLeftElements x 1 */
-    int* pRight,         /* right vector; nRightElements x 1 */
-    int* pOut,           /* 0, unless pRight elements are present in pLeft then 1; nLeftElements x 1 */
-    int nLeftElements,   /* number of elements in pLeft */
-    int nRightElements   /* number of elements in pRight */
-)
+/* The current state of a hull: its faces and their (outward facing) plane coefficients. Memory is grown in pools,
+ * rather than reallocated for every added/removed face */
+typedef struct _ch_hull {
+    CH_FLOAT* points;        /* vertex coordinates (not owned by the hull); FLAT: nPoints x 3 */
+    CH_FLOAT interior[3];    /* a point strictly inside the hull, used to orient the faces */
+    int nFaces, maxFaces;
+    int* faces;              /* face indices; FLAT: maxFaces x 3 */
+    CH_FLOAT* cf;            /* plane normals of the faces; FLAT: maxFaces x 3 */
+    CH_FLOAT* df;            /* plane offsets of the faces; maxFaces x 1 */
+    int* visible;            /* scratch, indices of the faces visible from a point; maxFaces x 1 */
+    int* isVisible;          /* scratch, 1: face is visible from a point; maxFaces x 1 */
+    CH_FLOAT* points_cf;     /* scratch, dot products of a point with the plane normals; maxFaces x 1 */
+    int maxHorizon;
+    int* horizon;            /* scratch, horizon edges; FLAT: maxHorizon x 2 */
+
+}ch_hull;
+
+static void ch_hull_init(ch_hull* h, CH_FLOAT* points)
 {
-    int i, j;
-    memset(pOut, 0, nLeftElements*sizeof(int));
-    for(i=0; i< nLeftElements; i++)
-        for(j=0; j< nRightElements; j++)
-            if(pLeft[i] == pRight[j] )
-                pOut[i] = 1;
+    memset(h, 0, sizeof(ch_hull));
+    h->points = points;
 }
 
-/* A C version of the 3D quickhull matlab implementation from here:
- * https://www.mathworks.com/matlabcentral/fileexchange/48509-computational-geometry-toolbox?focused=3851550&tab=example
- * (*out_faces) is returned as NULL, if triangulation fails *
- * Original Copyright (c) 2014, George Papazafeiropoulos
- * Distributed under the BSD (2-clause) license
- * Reference: "The Quickhull Algorithm for Convex Hull, C. Bradford Barber, David P. Dobkin
- *             and Hannu Huhdanpaa, Geometry Center Technical Report GCG53, July 30, 1993"
- */
-void convhull_3d_build
+static void ch_hull_free(ch_hull* h)
+{
+    free(h->faces);
+    free(h->cf);
+    free(h->df);
+    free(h->visible);
+    free(h->isVisible);
+    free(h->points_cf);
+    free(h->horizon);
+    memset(h, 0, sizeof(ch_hull));
+}
+
+/* appends the face "a,b,c", oriented such that the interior point is behind it. Returns 1 if the maximum number of
+ * faces is exceeded, 0 otherwise */
+static int ch_hull_addFace(ch_hull* h, int a, int b, int c)
+{
+    int j, tmp;
+    CH_FLOAT p_s[9], cfi[3], dfi;
+
+    if(h->nFaces == h->maxFaces){
+        h->maxFaces = MAX(2*h->maxFaces, 64);
+        h->faces = (int*)realloc(h->faces, h->maxFaces*3*sizeof(int));
+        h->cf = (CH_FLOAT*)realloc(h->cf, h->maxFaces*3*sizeof(CH_FLOAT));
+        h->df = (CH_FLOAT*)realloc(h->df, h->maxFaces*sizeof(CH_FLOAT));
+        h->visible = (int*)realloc(h->visible, h->maxFaces*sizeof(int));
+        h->isVisible = (int*)realloc(h->isVisible, h->maxFaces*sizeof(int));
+        h->points_cf = (CH_FLOAT*)realloc(h->points_cf, h->maxFaces*sizeof(CH_FLOAT));
+    }
+    h->faces[h->nFaces*3+0] = a;
+    h->faces[h->nFaces*3+1] = b;
+    h->faces[h->nFaces*3+2] = c;
+
+    /* Calculate and store the plane coefficients of the face */
+    for(j=0; j<3; j++){
+        p_s[0*3+j] = h->points[a*3+j];
+        p_s[1*3+j] = h->points[b*3+j];
+        p_s[2*3+j] = h->points[c*3+j];
+    }
+    plane_3d(p_s, cfi, &dfi);
+
+    /* Orient the face so that the interior point can't see it */
+    if(cfi[0]*h->interior[0] + cfi[1]*h->interior[1] + cfi[2]*h->interior[2] + dfi > 0.0){
+        /* Reverse the order of the last two vertices to change the volume */
+        tmp = h->faces[h->nFaces*3+1];
+        h->faces[h->nFaces*3+1] = h->faces[h->nFaces*3+2];
+        h->faces[h->nFaces*3+2] = tmp;
+        for(j=0; j<3; j++)
+            cfi[j] = -cfi[j];
+        dfi = -dfi;
+    }
+    for(j=0; j<3; j++)
+        h->cf[h->nFaces*3+j] = cfi[j];
+    h->df[h->nFaces] = dfi;
+    h->nFaces++;
+
+    return h->nFaces > CH_MAX_NUM_FACES ? 1 : 0;
+}
+
+/* finds the faces that are visible from point "i" (returns how many) */
+static int ch_hull_findVisible(ch_hull* h, int i)
+{
+    int j, num_visible;
+    CH_FLOAT* points_s;
+
+    if(h->nFaces==0)
+        return 0;
+    points_s = &(h->points[i*3]);
+#ifdef CONVHULL_3D_USE_CBLAS
+  #ifdef CONVHULL_3D_USE_FLOAT_PRECISION
+    cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasTrans, 1, h->nFaces, 3, 1.0f,
+                points_s, 3,
+                h->cf, 3, 0.0f,
+                h->points_cf, h->nFaces);
+  #else
+    cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasTrans, 1, h->nFaces, 3, 1.0,
+                points_s, 3,
+                h->cf, 3, 0.0,
+                h->points_cf, h->nFaces);
+  #endif
+#else
+    for (j = 0; j < h->nFaces; j++)
+        h->points_cf[j] = points_s[0]*h->cf[j*3+0] + points_s[1]*h->cf[j*3+1] + points_s[2]*h->cf[j*3+2];
+#endif
+    num_visible = 0;
+    for(j=0; j<h->nFaces; j++){
+        if(h->points_cf[j] + h->df[j] > 0.0){
+            h->isVisible[j] = 1;
+            h->visible[num_visible++] = j;
+        }
+        else
+            h->isVisible[j] = 0;
+    }
+    return num_visible;
+}
+
+/* adds point "i" to the hull: the faces visible from the point are deleted, and the resulting hole is filled with
+ * faces connecting its boundary (the horizon) to the point. Returns the number of deleted faces (0 if the point is
+ * inside the hull, and is therefore not added), or -1 if the maximum number of faces is exceeded */
+static int ch_hull_addPoint(ch_hull* h, int i)
+{
+    int j, k, l, e, a, b, num_visible, num_horizon, shared;
+    int* fk;
+
+    num_visible = ch_hull_findVisible(h, i);
+    if(num_visible==0)
+        return 0;
+
+    /* Create horizon: the edges of the visible faces, which are not shared with another visible face. The edges keep
+     * the orientation of their visible face, so the new faces are oriented in the same way */
+    num_horizon = 0;
+    for(j=0; j<num_visible; j++){
+        for(e=0; e<3; e++){
+            a = h->faces[h->visible[j]*3+e];
+            b = h->faces[h->visible[j]*3+(e+1)%3];
+            shared = 0;
+            for(k=0; k<num_visible && !shared; k++){
+                if(k==j)
+                    continue;
+                fk = &(h->faces[h->visible[k]*3]);
+                shared = (fk[0]==a || fk[1]==a || fk[2]==a) && (fk[0]==b || fk[1]==b || fk[2]==b);
+            }
+            if(!shared){
+                if(num_horizon == h->maxHorizon){
+                    h->maxHorizon = MAX(2*h->maxHorizon, 64);
+                    h->horizon = (int*)realloc(h->horizon, h->maxHorizon*2*sizeof(int));
+                }
+                h->horizon[num_horizon*2+0] = a;
+                h->horizon[num_horizon*2+1] = b;
+                num_horizon++;
+            }
+        }
+    }
+
+    /* Delete visible faces, and their plane coefficients */
+    for(j=0, l=0; j<h->nFaces; j++){
+        if(!h->isVisible[j]){
+            if(l!=j){
+                for(k=0; k<3; k++){
+                    h->faces[l*3+k] = h->faces[j*3+k];
+                    h->cf[l*3+k] = h->cf[j*3+k];
+                }
+                h->df[l] = h->df[j];
+            }
+            l++;
+        }
+    }
+    h->nFaces = l;
+
+    /* Add faces connecting horizon to the new point */
+    for(j=0; j<num_horizon; j++)
+        if(ch_hull_addFace(h, h->horizon[j*2+0], h->horizon[j*2+1], i))
+            return -1;
+
+    return num_visible;
+}
+
+/* builds the hull of the points "idx"; the first 4 form the initial simplex, and the rest are added in the order
+ * given. Returns 0 if successful */
+static int ch_hull_build(ch_hull* h, int* idx, int n)
+{
+    int i, j, k, f[3];
+
+    /* The initial convex hull is a simplex with 4 facets. The interior point is its centroid */
+    h->nFaces = 0;
+    for(j=0; j<3; j++){
+        h->interior[j] = 0.0;
+        for(i=0; i<4; i++)
+            h->interior[j] += h->points[idx[i]*3+j]/4.0;
+    }
+    for(i=0; i<4; i++){
+        /* Set the indices of the points defining the face */
+        for(j=0, k=0; j<4; j++)
+            if(j!=i)
+                f[k++] = idx[j];
+        ch_hull_addFace(h, f[0], f[1], f[2]);
+    }
+
+    /* The main loop for the quickhull algorithm */
+    for(i=4; i<n; i++)
+        if(ch_hull_addPoint(h, idx[i])<0)
+            return 1;
+    return 0;
+}
+
+/* adds noise to the vertices (which mitigates duplicates), and builds their hull. The first 4 vertices form the
+ * initial simplex, and the remaining vertices are added in order of their distance from the center of the point set.
+ * Returns 0 if successful */
+static int ch_hull_buildFromVertices
 (
+    ch_hull* h,
     ch_vertex* const in_vertices,
-    const int nVert,
-    int** out_faces,
-    int* nOut_faces
+    const int nVert
 )
 {
-    int i, j, k, l, h;
-    int nFaces, p, d;
-    int* aVec, *faces;
-    CH_FLOAT dfi, v, max_p, min_p;
-    CH_FLOAT* points, *cf, *cfi, *df, *p_s, *span;
-    
-    if(nVert<3 || in_vertices==NULL){
-        (*out_faces) = NULL;
-        (*nOut_faces) = 0;
-        return;
-    }
-    
-    /* 3 dimensions. The code should theoretically work for >=2 dimensions, but "plane_3d" and "det_4x4" are hardcoded for 3,
-     * so would need to be rewritten */
+    int i, j, k, d, failed;
+    int* ind, *order;
+    CH_FLOAT max_p, min_p;
+    CH_FLOAT* points, *span, *meanp, *absdist, *reldist, *desReldist;
+
+    /* 3 dimensions. "plane_3d" is hardcoded for 3 */
     d = 3;
+    points = h->points;
     span = (CH_FLOAT*)malloc(d*sizeof(CH_FLOAT));
     for(j=0; j<d; j++){
         max_p = 2.23e-13; min_p = 2.23e+13;
@@ -323,424 +425,412 @@ void convhull_3d_build
         }
         span[j] = max_p - min_p;
     }
-    points = (CH_FLOAT*)malloc(nVert*(d+1)*sizeof(CH_FLOAT));
-    for(i=0; i<nVert; i++){
-        for(j=0; j<d; j++)
-            points[i*(d+1)+j] = in_vertices[i].v[j] + CH_NOISE_VAL*rand()/(float)RAND_MAX; /* noise mitigates duplicates */
-        points[i*(d+1)+d] = 1.0f; /* add a last column of ones. Used only for determinant calculation */
-    }
-    
-    /* The initial convex hull is a simplex with (d+1) facets, where d is the number of dimensions */
-    nFaces = (d+1);
-    faces = (int*)calloc(nFaces*d, sizeof(int));
-    aVec = (int*)malloc(nFaces*sizeof(int));
-    for(i=0; i<nFaces; i++)
-        aVec[i] = i;
-    
-    /* Each column of cf contains the coefficients of a plane */
-    cf = (CH_FLOAT*)malloc(nFaces*d*sizeof(CH_FLOAT));
-    cfi = (CH_FLOAT*)malloc(d*sizeof(CH_FLOAT));
-    df = (CH_FLOAT*)malloc(nFaces*sizeof(CH_FLOAT));
-    p_s = (CH_FLOAT*)malloc(d*d*sizeof(CH_FLOAT));
-    for(i=0; i<nFaces; i++){
-        /* Set the indices of the points defining the face  */
-        for(j=0, k=0; j<(d+1); j++){
-            if(aVec[j]!=i){
-                faces[i*d+k] = aVec[j];
-                k++;
-            }
-        }
-        
-        /* Calculate and store the plane coefficients of the face */
-        for(j=0; j<d; j++)
-            for(k=0; k<d; k++)
-                p_s[j*d+k] = points[(faces[i*d+j])*(d+1) + k];
-        
-        /* Calculate and store the plane coefficients of the face */
-        plane_3d(p_s, cfi, &dfi);
+    for(i=0; i<nVert; i++)
         for(j=0; j<d; j++)
-            cf[i*d+j] = cfi[j];
-        df[i] = dfi;
-    }
-    CH_FLOAT *A;
-    int *bVec, *fVec, *asfVec, *face_tmp;
-    
-    /* Check to make sure that faces are correctly oriented */
-    bVec = (int*)malloc(4*sizeof(int));
-    for(i=0; i<d+1; i++)
-        bVec[i] = i;
-    
-    /* A contains the coordinates of the points forming a simplex */
-    A = (CH_FLOAT*)calloc((d+1)*(d+1), sizeof(CH_FLOAT));
-    face_tmp = (int*)malloc((d+1)*sizeof(int));
-    fVec = (int*)malloc((d+1)*sizeof(int));
-    asfVec = (int*)malloc((d+1)*sizeof(int));
-    for(k=0; k<(d+1); k++){
-        /* Get the point that is not on the current face (point p) */
-        for(i=0; i<d; i++)
-            fVec[i] = faces[k*d+i];
-        sort_int(fVec, NULL, NULL, d, 0); /* sort accending */
-        p=k;
-        for(i=0; i<d; i++)
-            for(j=0; j<(d+1); j++)
-                A[i*(d+1)+j] = points[(faces[k*d+i])*(d+1) + j];
-        for(; i<(d+1); i++)
-            for(j=0; j<(d+1); j++)
-                A[i*(d+1)+j] = points[p*(d+1)+j];
-        
-        /* det(A) determines the orientation of the face */
-        v = det_4x4(A);
-        
-        /* Orient so that each point on the original simplex can't see the opposite face */
-        if(v<0){
-            /* Reverse the order of the last two vertices to change the volume */
-            for(j=0; j<d; j++)
-                face_tmp[j] = faces[k*d+j];
-            for(j=0, l=d-2; j<d-1; j++, l++)
-                faces[k*d+l] = face_tmp[d-j-1];
-            
-            /* Modify the plane coefficients of the properly oriented faces */
-            for(j=0; j<d; j++)
-                cf[k*d+j] = -cf[k*d+j];
-            df[k] = -df[k];
-            for(i=0; i<d; i++)
-                for(j=0; j<(d+1); j++)
-                    A[i*(d+1)+j] = points[(faces[k*d+i])*(d+1) + j];
-            for(; i<(d+1); i++)
-                for(j=0; j<(d+1); j++)
-                    A[i*(d+1)+j] = points[p*(d+1)+j];
-        }
-    }
-    
+            points[i*d+j] = in_vertices[i].v[j] + CH_NOISE_VAL*rand()/(float)RAND_MAX; /* noise mitigates duplicates */
+
     /* Coordinates of the center of the point set */
-    CH_FLOAT* meanp, *absdist, *reldist, *desReldist;
     meanp = (CH_FLOAT*)calloc(d, sizeof(CH_FLOAT));
     for(i=d+1; i<nVert; i++)
         for(j=0; j<d; j++)
-            meanp[j] += points[i*(d+1)+j];
+            meanp[j] += points[i*d+j];
     for(j=0; j<d; j++)
         meanp[j] = meanp[j]/(CH_FLOAT)(nVert-d-1);
-    
+
     /* Absolute distance of points from the center */
     absdist = (CH_FLOAT*)malloc((nVert-d-1)*d * sizeof(CH_FLOAT));
     for(i=d+1, k=0; i<nVert; i++, k++)
         for(j=0; j<d; j++)
-            absdist[k*d+j] = (points[i*(d+1)+j] -  meanp[j])/span[j];
-    
+            absdist[k*d+j] = (points[i*d+j] -  meanp[j])/span[j];
+
     /* Relative distance of points from the center */
     reldist = (CH_FLOAT*)calloc((nVert-d-1), sizeof(CH_FLOAT));
     desReldist = (CH_FLOAT*)malloc((nVert-d-1) * sizeof(CH_FLOAT));
     for(i=0; i<(nVert-d-1); i++)
         for(j=0; j<d; j++)
             reldist[i] += pow(absdist[i*d+j], 2.0);
-    
-    /* Sort from maximum to minimum relative distance */
-    int num_pleft, cnt;
-    int* ind, *pleft;
+
+    /* Sort from maximum to minimum relative distance. The points with the larger relative distance from the center
+     * are added first */
     ind = (int*)malloc((nVert-d-1) * sizeof(int));
-    pleft = (int*)malloc((nVert-d-1) * sizeof(int));
+    order = (int*)malloc(nVert * sizeof(int));
     sort_float(reldist, desReldist, ind, (nVert-d-1), 1);
-    
-    /* Initialize the vector of points left. The points with the larger relative
-     distance from the center are scanned first. */
-    num_pleft = (nVert-d-1);
-    for(i=0; i<num_pleft; i++)
-        pleft[i] = ind[i]+d+1;
-    
-    /* Loop over all remaining points that are not deleted. Deletion of points
-     occurs every #iter2del# iterations of this while loop */
-    memset(A, 0, (d+1)*(d+1) * sizeof(CH_FLOAT));
-    
-    /* cnt is equal to the points having been selected without deletion of
-     nonvisible points (i.e. points inside the current convex hull) */
-    cnt=0;
-    
-    /* The main loop for the quickhull algorithm */
-    CH_FLOAT detA;
-    CH_FLOAT* points_cf, *points_s;
-    int* visible_ind, *visible, *nonvisible_faces, *f0, *face_s, *u, *gVec, *horizon, *hVec, *pp, *hVec_mem_face;
-    int num_visible_ind, num_nonvisible_faces, n_newfaces, count, vis;
-    int f0_sum, u_len, start, num_p, index, horizon_size1;
-    int FUCKED;
-    FUCKED = 0;
-    u = horizon = NULL;
-    nFaces = d+1;
-    visible_ind = (int*)malloc(nFaces*sizeof(int));
-    points_cf = (CH_FLOAT*)malloc(nFaces*sizeof(CH_FLOAT));
-    points_s = (CH_FLOAT*)malloc(d*sizeof(CH_FLOAT));
-    face_s = (int*)malloc(d*sizeof(int));
-    gVec = (int*)malloc(d*sizeof(int));
-    while( (num_pleft>0) ){
-        /* i is the first point of the points left */
-        i = pleft[0];
-        
-        /* Delete the point selected */
-        for(j=0; j<num_pleft-1; j++)
-            pleft[j] = pleft[j+1];
-        num_pleft--;
-        if(num_pleft == 0)
-            free(pleft);
-        else
-            pleft = (int*)realloc(pleft, num_pleft*sizeof(int));
-        
-        /* Update point selection counter */
-        cnt++;
-        
-        /* find visible faces */
-        for(j=0; j<d; j++)
-            points_s[j] = points[i*(d+1)+j];
-        points_cf = (CH_FLOAT*)realloc(points_cf, nFaces*sizeof(CH_FLOAT));
-        visible_ind = (int*)realloc(visible_ind, nFaces*sizeof(int));
-#ifdef CONVHULL_3D_USE_CBLAS
-  #ifdef CONVHULL_3D_USE_FLOAT_PRECISION
-        cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasTrans, 1, nFaces, d, 1.0f,
-                    points_s, d,
-                    cf, d, 0.0f,
-                    points_cf, nFaces);
-  #else
-        cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasTrans, 1, nFaces, d, 1.0,
-                    points_s, d,
-                    cf, d, 0.0,
-                    points_cf, nFaces);
-  #endif
-#else
-        for (j = 0; j < nFaces; j++) {
-            points_cf[j] = 0;
-            for (k = 0; k < d; k++)
-                points_cf[j] += points_s[k]*cf[j*d+k];
+    for(i=0; i<d+1; i++)
+        order[i] = i;
+    for(i=0; i<(nVert-d-1); i++)
+        order[i+d+1] = ind[i]+d+1;
+
+    /* build the hull */
+    failed = ch_hull_build(h, order, nVert);
+
+    free(meanp);
+    free(absdist);
+    free(reldist);
+    free(desReldist);
+    free(ind);
+    free(order);
+    free(span);
+    return failed;
+}
+
+/* A C version of the 3D quickhull matlab implementation from here:
+ * https://www.mathworks.com/matlabcentral/fileexchange/48509-computational-geometry-toolbox?focused=3851550&tab=example
+ * (*out_faces) is returned as NULL, if triangulation fails *
+ * Original Copyright (c) 2014, George Papazafeiropoulos
+ * Distributed under the BSD (2-clause) license
+ * Reference: "The Quickhull Algorithm for Convex Hull, C. Bradford Barber, David P. Dobkin
+ *             and Hannu Huhdanpaa, Geometry Center Technical Report GCG53, July 30, 1993"
+ */
+void convhull_3d_build
+(
+    ch_vertex* const in_vertices,
+    const int nVert,
+    int** out_faces,
+    int* nOut_faces
+)
+{
+    CH_FLOAT* points;
+    ch_hull hull;
+
+    if(nVert<4 || in_vertices==NULL){
+        (*out_faces) = NULL;
+        (*nOut_faces) = 0;
+        return;
+    }
+
+    /* build the hull */
+    points = (CH_FLOAT*)malloc(nVert*3*sizeof(CH_FLOAT));
+    ch_hull_init(&hull, points);
+    if(ch_hull_buildFromVertices(&hull, in_vertices, nVert)){
+        (*out_faces) = NULL;
+        (*nOut_faces) = 0;
+    }
+    else{
+        (*out_faces) = (int*)malloc(hull.nFaces*3*sizeof(int));
+        memcpy((*out_faces), hull.faces, hull.nFaces*3*sizeof(int));
+        (*nOut_faces) = hull.nFaces;
+    }
+
+    /* clean-up */
+    ch_hull_free(&hull);
+    free(points);
+}
+
+typedef struct _convhull_3d_data {
+    int nVert, maxVert;
+    CH_FLOAT* points;        /* vertex coordinates (with noise); FLAT: maxVert x 3 */
+    int* removed;            /* 1: vertex has been removed, 0: it is part of the hull, or lies inside it */
+    int* onHull;             /* scratch, 1: vertex is used by a face of the hull; maxVert x 1 */
+    ch_hull hull;
+
+}convhull_3d_data;
+
+/* marks the vertices used by the faces of the hull in "onHull" */
+static void convhull_3d_markHullVertices(convhull_3d_data* h)
+{
+    int i;
+
+    memset(h->onHull, 0, h->nVert*sizeof(int));
+    for(i=0; i<h->hull.nFaces*3; i++)
+        h->onHull[h->hull.faces[i]] = 1;
+}
+
+/* the centroid of the vertices of the faces is strictly inside the hull, also after vertices have been removed */
+static void convhull_3d_updateInterior(convhull_3d_data* h)
+{
+    int i, j;
+
+    memset(h->hull.interior, 0, 3*sizeof(CH_FLOAT));
+    for(i=0; i<h->hull.nFaces*3; i++)
+        for(j=0; j<3; j++)
+            h->hull.interior[j] += h->points[h->hull.faces[i]*3+j];
+    for(j=0; j<3; j++)
+        h->hull.interior[j] /= (CH_FLOAT)MAX(h->hull.nFaces*3, 1);
+}
+
+/* builds the hull of all vertices which have not been removed. The initial simplex is formed by 4 extreme vertices;
+ * if there are fewer than 4 vertices, or they are all (nearly) coplanar, the hull is left empty until more vertices
+ * are inserted */
+static void convhull_3d_rebuild(convhull_3d_data* h)
+{
+    int i, j, k, n, tmp, simplex[4];
+    int* idx;
+    CH_FLOAT d, dmax, scale, vol, a[3], b[3], c[3], e[3];
+    CH_FLOAT* p;
+
+    h->hull.nFaces = 0;
+    idx = (int*)malloc(MAX(h->nVert,1)*sizeof(int));
+    for(i=0, n=0; i<h->nVert; i++)
+        if(!h->removed[i])
+            idx[n++] = i;
+    if(n<4){
+        free(idx);
+        return;
+    }
+    p = h->points;
+
+    /* the vertex furthest from the first, the one furthest from the line through them, and the one furthest from
+     * the plane through all three */
+    simplex[0] = idx[0];
+    for(i=1, dmax=-1.0, simplex[1]=idx[1]; i<n; i++){
+        for(j=0, d=0.0; j<3; j++)
+            d += pow(p[idx[i]*3+j]-p[simplex[0]*3+j], 2.0);
+        if(d>dmax){ dmax = d; simplex[1] = idx[i]; }
+    }
+    scale = sqrt(dmax);
+    for(j=0; j<3; j++)
+        a[j] = p[simplex[1]*3+j]-p[simplex[0]*3+j];
+    for(i=0, dmax=-1.0, simplex[2]=idx[0]; i<n; i++){
+        for(j=0; j<3; j++)
+            b[j] = p[idx[i]*3+j]-p[simplex[0]*3+j];
+        c[0] = a[1]*b[2]-a[2]*b[1]; c[1] = a[2]*b[0]-a[0]*b[2]; c[2] = a[0]*b[1]-a[1]*b[0];
+        d = c[0]*c[0] + c[1]*c[1] + c[2]*c[2];
+        if(d>dmax){ dmax = d; simplex[2] = idx[i]; for(j=0; j<3; j++) e[j] = c[j]; }
+    }
+    for(i=0, dmax=-1.0, simplex[3]=idx[0]; i<n; i++){
+        for(j=0, d=0.0; j<3; j++)
+            d += e[j]*(p[idx[i]*3+j]-p[simplex[0]*3+j]);
+        if(fabs(d)>dmax){ dmax = fabs(d); simplex[3] = idx[i]; }
+    }
+    vol = dmax; /* = 6 x the volume of the simplex */
+    if(vol <= 1e-6*scale*scale*scale){
+        free(idx);
+        return;
+    }
+
+    /* the simplex vertices are moved to the front, and the rest are added in their original order */
+    for(k=0; k<4; k++){
+        for(i=k; i<n && idx[i]!=simplex[k]; i++);
+        tmp = idx[k]; idx[k] = idx[i]; idx[i] = tmp;
+    }
+    if(ch_hull_build(&(h->hull), idx, n))
+        h->hull.nFaces = 0;
+    free(idx);
+}
+
+/* sets the coordinates of vertex "index", and adds it to the hull */
+static void convhull_3d_placeVertex(convhull_3d_data* h, const int index, ch_vertex vertex)
+{
+    int j;
+
+    for(j=0; j<3; j++)
+        h->points[index*3+j] = vertex.v[j] + CH_NOISE_VAL*rand()/(float)RAND_MAX; /* noise mitigates duplicates */
+    h->removed[index] = 0;
+    if(h->hull.nFaces==0)
+        convhull_3d_rebuild(h);
+    else
+        ch_hull_addPoint(&(h->hull), index);
+}
+
+void convhull_3d_create
+(
+    void** const phCH,
+    ch_vertex* const in_vertices,
+    const int nVert
+)
+{
+    convhull_3d_data* h;
+    int i, j;
+
+    h = (convhull_3d_data*)malloc(sizeof(convhull_3d_data));
+    *phCH = (void*)h;
+    h->nVert = nVert;
+    h->maxVert = MAX(nVert, 4);
+    h->points = (CH_FLOAT*)malloc(h->maxVert*3*sizeof(CH_FLOAT));
+    h->removed = (int*)calloc(h->maxVert, sizeof(int));
+    h->onHull = (int*)calloc(h->maxVert, sizeof(int));
+    ch_hull_init(&(h->hull), h->points);
+    if(in_vertices==NULL){
+        h->nVert = 0;
+        return;
+    }
+
+    /* initial hull (with fewer than 4 vertices, it is built once enough vertices have been inserted) */
+    if(nVert<4){
+        for(i=0; i<nVert; i++)
+            for(j=0; j<3; j++)
+                h->points[i*3+j] = in_vertices[i].v[j] + CH_NOISE_VAL*rand()/(float)RAND_MAX;
+    }
+    else if(ch_hull_buildFromVertices(&(h->hull), in_vertices, nVert))
+        h->hull.nFaces = 0;
+}
+
+void convhull_3d_destroy
+(
+    void** const phCH
+)
+{
+    convhull_3d_data *h = (convhull_3d_data*)(*phCH);
+
+    if (h != NULL) {
+        ch_hull_free(&(h->hull));
+        free(h->points);
+        free(h->removed);
+        free(h->onHull);
+        free(h);
+        h = NULL;
+        *phCH = NULL;
+    }
+}
+
+int convhull_3d_insertVertex
+(
+    void* const hCH,
+    ch_vertex vertex
+)
+{
+    convhull_3d_data *h = (convhull_3d_data*)(hCH);
+
+    if(h->nVert == h->maxVert){
+        h->maxVert *= 2;
+        h->points = (CH_FLOAT*)realloc(h->points, h->maxVert*3*sizeof(CH_FLOAT));
+        h->removed = (int*)realloc(h->removed, h->maxVert*sizeof(int));
+        h->onHull = (int*)realloc(h->onHull, h->maxVert*sizeof(int));
+        h->hull.points = h->points;
+    }
+    h->nVert++;
+    convhull_3d_placeVertex(h, h->nVert-1, vertex);
+    return h->nVert-1;
+}
+
+void convhull_3d_removeVertex
+(
+    void* const hCH,
+    const int index
+)
+{
+    convhull_3d_data *h = (convhull_3d_data*)(hCH);
+    ch_hull ring_hull;
+    int i, j, k, l, nStar, nRing, nPatch, nHidden, closed;
+    int* ring, *next, *f, *hidden;
+    CH_FLOAT* p;
+
+    if(index<0 || index>=h->nVert || h->removed[index])
+        return;
+    h->removed[index] = 1;
+
+    /* The faces which share the vertex (its star) are deleted. Each one contributes one edge to the boundary of the
+     * resulting hole (the ring); "next" links each ring vertex to the following one */
+    next = (int*)malloc(h->nVert*sizeof(int));
+    for(j=0, l=0, nStar=0; j<h->hull.nFaces; j++){
+        f = &(h->hull.faces[j*3]);
+        for(k=0; k<3 && f[k]!=index; k++);
+        if(k<3){
+            next[f[(k+1)%3]] = f[(k+2)%3];
+            i = f[(k+1)%3];
+            nStar++;
+            continue;
         }
-#endif
-        num_visible_ind = 0;
-        for(j=0; j<nFaces; j++){
-            if(points_cf[j] + df[j] > 0.0){
-                num_visible_ind++; /* will sum to 0 if none are visible */
-                visible_ind[j] = 1;
+        if(l!=j){
+            for(k=0; k<3; k++){
+                h->hull.faces[l*3+k] = f[k];
+                h->hull.cf[l*3+k] = h->hull.cf[j*3+k];
             }
-            else
-                visible_ind[j] = 0;
+            h->hull.df[l] = h->hull.df[j];
         }
-        num_nonvisible_faces = nFaces - num_visible_ind;
-        
-        /* proceed if there are any visible faces */
-        if(num_visible_ind!=0){
-            /* Find visible face indices */
-            visible = (int*)malloc(num_visible_ind*sizeof(int));
-            for(j=0, k=0; j<nFaces; j++){
-                if(visible_ind[j]==1){
-                    visible[k]=j;
-                    k++;
-                }
-            }
-            
-            /* Find nonvisible faces */
-            nonvisible_faces = (int*)malloc(num_nonvisible_faces*d*sizeof(int));
-            f0 = (int*)malloc(num_nonvisible_faces*d*sizeof(int));
-            for(j=0, k=0; j<nFaces; j++){
-                if(visible_ind[j]==0){
-                    for(l=0; l<d; l++)
-                        nonvisible_faces[k*d+l]= faces[j*d+l];
-                    k++;
-                }
-            }
-            
-            /* Create horizon (count is the number of the edges of the horizon) */
-            count=0;
-            for(j=0; j<num_visible_ind; j++){
-                /* visible face */
-                vis = visible[j];
-                for(k=0; k<d; k++)
-                    face_s[k] = faces[vis*d+k];
-                sort_int(face_s, NULL, NULL, d, 0);
-                ismember(nonvisible_faces, face_s, f0, num_nonvisible_faces*d, d);
-                u_len = 0;
-                
-                /* u are the nonvisible faces connected to the face v, if any */
-                for(k=0; k<num_nonvisible_faces; k++){
-                    f0_sum = 0;
-                    for(l=0; l<d; l++)
-                        f0_sum += f0[k*d + l];
-                    if(f0_sum == d-1){
-                        u_len++;
-                        if(u_len==1)
-                            u = (int*)malloc(u_len*sizeof(int));
-                        else
-                            u = (int*)realloc(u, u_len*sizeof(int));
-                        u[u_len-1] = k;
-                    }
-                }
-                for(k=0; k<u_len; k++){
-                    /* The boundary between the visible face v and the k(th) nonvisible face connected to the face v forms part of the horizon */
-                    count++;
-                    if(count==1)
-                        horizon = (int*)malloc(count*(d-1)*sizeof(int));
-                    else
-                        horizon = (int*)realloc(horizon, count*(d-1)*sizeof(int));
-                    for(l=0; l<d; l++)
-                        gVec[l] = nonvisible_faces[u[k]*d+l];
-                    for(l=0, h=0; l<d; l++){
-                        if(f0[u[k]*d+l]){
-                            horizon[(count-1)*(d-1)+h] = gVec[l];
-                            h++;
-                        }
-                    }
-                }
-                if(u_len!=0)
-                    free(u);
-            }
-            horizon_size1 = count;
-            for(j=0, l=0; j<nFaces; j++){
-                if(!visible_ind[j]){
-                    /* Delete visible faces */
-                    for(k=0; k<d; k++)
-                        faces[l*d+k] = faces[j*d+k];
-                    
-                    /* Delete the corresponding plane coefficients of the faces */
-                    for(k=0; k<d; k++)
-                        cf[l*d+k] = cf[j*d+k];
-                    df[l] = df[j];
-                    l++;
-                }
-            }
-            
-            /* Update the number of faces */
-            nFaces = nFaces-num_visible_ind;
-            faces = (int*)realloc(faces, nFaces*d*sizeof(int));
-            cf = (CH_FLOAT*)realloc(cf, nFaces*d*sizeof(CH_FLOAT));
-            df = (CH_FLOAT*)realloc(df, nFaces*sizeof(CH_FLOAT));
-            
-            /* start is the first row of the new faces */
-            start=nFaces;
-            
-            /* Add faces connecting horizon to the new point */
-            n_newfaces = horizon_size1;
-            for(j=0; j<n_newfaces; j++){
-                nFaces++;
-                faces = (int*)realloc(faces, nFaces*d*sizeof(int));
-                cf = (CH_FLOAT*)realloc(cf, nFaces*d*sizeof(CH_FLOAT));
-                df = (CH_FLOAT*)realloc(df, nFaces*sizeof(CH_FLOAT));
-                for(k=0; k<d-1; k++)
-                    faces[(nFaces-1)*d+k] = horizon[j*(d-1)+k];
-                faces[(nFaces-1)*d+(d-1)] = i;
-                
-                /* Calculate and store appropriately the plane coefficients of the faces */
-                for(k=0; k<d; k++)
-                    for(l=0; l<d; l++)
-                        p_s[k*d+l] = points[(faces[(nFaces-1)*d+k])*(d+1) + l];
-                plane_3d(p_s, cfi, &dfi);
-                for(k=0; k<d; k++)
-                    cf[(nFaces-1)*d+k] = cfi[k];
-                df[(nFaces-1)] = dfi;
-                if(nFaces > CH_MAX_NUM_FACES){
-                    FUCKED = 1;
-                    nFaces = 0;
-                    break;
-                }
-            }
-            
-            /* Orient each new face properly */
-            hVec = (int*)malloc( nFaces*sizeof(int));
-            hVec_mem_face = (int*)malloc( nFaces*sizeof(int));
-            for(j=0; j<nFaces; j++)
-                hVec[j] = j;
-            for(k=start; k<nFaces; k++){
-                for(j=0; j<d; j++)
-                    face_s[j] = faces[k*d+j];
-                sort_int(face_s, NULL, NULL, d, 0);
-                ismember(hVec, face_s, hVec_mem_face, nFaces, d);
-                num_p = 0;
-                for(j=0; j<nFaces; j++)
-                    if(!hVec_mem_face[j])
-                        num_p++;
-                pp = (int*)malloc(num_p*sizeof(int));
-                for(j=0, l=0; j<nFaces; j++){
-                    if(!hVec_mem_face[j]){
-                        pp[l] = hVec[j];
-                        l++;
-                    }
-                }
-                index = 0;
-                detA = 0.0;
-                
-                /* While new point is coplanar, choose another point */
-                while(detA==0.0){
-                    for(j=0;j<d; j++)
-                        for(l=0; l<d+1; l++)
-                            A[j*(d+1)+l] = points[(faces[k*d+j])*(d+1) + l];
-                    for(; j<d+1; j++)
-                        for(l=0; l<d+1; l++)
-                            A[j*(d+1)+l] = points[pp[index]*(d+1)+l];
-                    index++;
-                    detA = det_4x4(A);
-                }
-                
-                /* Orient faces so that each point on the original simplex can't see the opposite face */
-                if (detA<0.0){
-                    /* If orientation is improper, reverse the order to change the volume sign */
-                    for(j=0; j<d; j++)
-                        face_tmp[j] = faces[k*d+j];
-                    for(j=0, l=d-2; j<d-1; j++, l++)
-                        faces[k*d+l] = face_tmp[d-j-1];
-                    
-                    /* Modify the plane coefficients of the properly oriented faces */
-                    for(j=0; j<d; j++)
-                        cf[k*d+j] = -cf[k*d+j];
-                    df[k] = -df[k];
-                    for(l=0; l<d; l++)
-                        for(j=0; j<d+1; j++)
-                            A[l*(d+1)+j] = points[(faces[k*d+l])*(d+1) + j];
-                    for(; l<d+1; l++)
-                        for(j=0; j<d+1; j++)
-                            A[l*(d+1)+j] = points[pp[index]*(d+1)+j];
-                }
-                free(pp);
-            }
-            free(horizon);
-            free(f0);
-            free(nonvisible_faces);
-            free(visible);
-            free(hVec);
-            free(hVec_mem_face);
+        l++;
+    }
+    h->hull.nFaces = l;
+    if(nStar<3){
+        /* the vertex was inside the hull, which is therefore unchanged */
+        free(next);
+        return;
+    }
+    if(h->hull.nFaces<=1){
+        /* the hull was a simplex, so the remaining vertices are rebuilt from scratch */
+        convhull_3d_rebuild(h);
+        free(next);
+        return;
+    }
+    convhull_3d_updateInterior(h);
+
+    /* walk around the ring, starting from any of its vertices. It must close after visiting each star edge once;
+     * otherwise (i.e. the star was not a single consistently oriented fan), the hull is rebuilt from scratch */
+    ring = (int*)malloc(nStar*sizeof(int));
+    closed = 0;
+    for(nRing=0; nRing<nStar && !closed; nRing++){
+        ring[nRing] = i;
+        i = next[i];
+        closed = i==ring[0];
+    }
+    if(!closed || nRing!=nStar){
+        convhull_3d_rebuild(h);
+        free(ring);
+        free(next);
+        return;
+    }
+
+    /* Fill the hole: since the removed vertex could see exactly those faces of the (remaining) hull that lie within
+     * the ring, the hole is covered by the faces of the hull of the ring vertices which are visible from it. As in
+     * convhull_3d_build, ch_hull_addFace orients each of these faces against the interior point (the centroid
+     * updated above), so the direction in which the ring was walked does not matter */
+    nPatch = h->hull.nFaces;
+    if(nRing==3)
+        ch_hull_addFace(&(h->hull), ring[0], ring[1], ring[2]);
+    else{
+        ch_hull_init(&ring_hull, h->points);
+        if(!ch_hull_build(&ring_hull, ring, nRing)){
+            p = &(h->points[index*3]);
+            for(j=0; j<ring_hull.nFaces; j++)
+                if(p[0]*ring_hull.cf[j*3+0] + p[1]*ring_hull.cf[j*3+1] + p[2]*ring_hull.cf[j*3+2] + ring_hull.df[j] > 0.0)
+                    ch_hull_addFace(&(h->hull), ring_hull.faces[j*3+0], ring_hull.faces[j*3+1], ring_hull.faces[j*3+2]);
         }
-        if(FUCKED){
-            break;
+        ch_hull_free(&ring_hull);
+    }
+
+    /* The vertices inside the old hull, which are in front of any of the new faces (i.e. within the cone of the
+     * removed vertex), were hidden by it. These are added back to the hull with the usual visibility pass */
+    convhull_3d_markHullVertices(h);
+    hidden = next; /* no longer needed */
+    for(i=0, nHidden=0; i<h->nVert; i++){
+        if(h->removed[i] || h->onHull[i])
+            continue;
+        p = &(h->points[i*3]);
+        for(j=nPatch; j<h->hull.nFaces; j++){
+            if(p[0]*h->hull.cf[j*3+0] + p[1]*h->hull.cf[j*3+1] + p[2]*h->hull.cf[j*3+2] + h->hull.df[j] > 0.0){
+                hidden[nHidden++] = i;
+                break;
+            }
         }
     }
-    
-    /* output */
-    if(FUCKED){
+    for(i=0; i<nHidden; i++)
+        ch_hull_addPoint(&(h->hull), hidden[i]);
+    free(ring);
+    free(next);
+}
+
+void convhull_3d_moveVertex
+(
+    void* const hCH,
+    const int index,
+    ch_vertex vertex
+)
+{
+    convhull_3d_data *h = (convhull_3d_data*)(hCH);
+
+    if(index<0 || index>=h->nVert)
+        return;
+    convhull_3d_removeVertex(hCH, index);
+    convhull_3d_placeVertex(h, index, vertex);
+}
+
+void convhull_3d_getFaces
+(
+    void* const hCH,
+    int** out_faces,
+    int* nOut_faces
+)
+{
+    convhull_3d_data *h = (convhull_3d_data*)(hCH);
+
+    if(h->hull.nFaces==0){
         (*out_faces) = NULL;
         (*nOut_faces) = 0;
+        return;
     }
-    else{
-        (*out_faces) = (int*)malloc(nFaces*d*sizeof(int));
-        memcpy((*out_faces),faces, nFaces*d*sizeof(int));
-        (*nOut_faces) = nFaces;
-    }
-    
-    /* clean-up */
-    free(visible_ind);
-    free(points_cf);
-    free(points_s);
-    free(face_s);
-    free(gVec);
-    free(meanp);
-    free(absdist);
-    free(reldist);
-    free(desReldist);
-    free(ind);
-    free(span);
-    free(points);
-    free(faces);
-    free(aVec);
-    free(cf);
-    free(cfi);
-    free(df);
-    free(p_s);
-    free(face_tmp);
-    free(fVec);
-    free(asfVec);
-    free(bVec);
-    free(A);
+    (*out_faces) = (int*)malloc(h->hull.nFaces*3*sizeof(int));
+    memcpy((*out_faces), h->hull.faces, h->hull.nFaces*3*sizeof(int));
+    (*nOut_faces) = h->hull.nFaces;
 }
 
 void convhull_3d_export_obj
@@ -61,13 +61,49 @@ typedef struct _ch_vertex {
 } ch_vertex;
 typedef ch_vertex ch_vec3;
    
-/* builds the convexhull, returning the face indices corresponding to "in_vertices" */
+/* builds the convexhull, returning the face indices corresponding to "in_vertices". With fewer than 4 vertices, no
+ * faces are returned ((*out_faces)=NULL, (*nOut_faces)=0); previously only fewer than 3 were rejected, and 3 vertices
+ * read past the end of the vertex array while forming the initial simplex */
 void convhull_3d_build(/* input arguments */
                        ch_vertex* const in_vertices,            /* vector of input vertices; nVert x 1 */
                        const int nVert,                         /* number of vertices */
                        /* output arguments */
                        int** out_faces,                         /* & of empty int*, output face indices; flat: nOut_faces x 3 */
                        int* nOut_faces);                        /* & of int, number of output face indices */
+
+/* creates a convexhull object, which supports the insertion, removal and moving of vertices without rebuilding the
+ * hull. The vertex indices of the faces remain those of "in_vertices" (followed by any inserted vertices). With fewer
+ * than 4 (non-coplanar) vertices, the hull has no faces until enough vertices have been inserted */
+void convhull_3d_create(/* input arguments */
+                        void** const phCH,                      /* & address of the convexhull object */
+                        ch_vertex* const in_vertices,           /* vector of input vertices; nVert x 1 */
+                        const int nVert);                       /* number of vertices */
+
+/* destroys the convexhull object */
+void convhull_3d_destroy(void** const phCH);                    /* & address of the convexhull object */
+
+/* adds a vertex to the hull, returning its index. Only the faces visible from the vertex are replaced */
+int convhull_3d_insertVertex(/* input arguments */
+                             void* const hCH,                   /* convexhull object */
+                             ch_vertex vertex);                 /* vertex to add */
+
+/* removes a vertex from the hull (its index remains reserved). Only the faces sharing the vertex are replaced */
+void convhull_3d_removeVertex(/* input arguments */
+                              void* const hCH,                  /* convexhull object */
+                              const int index);                 /* index of the vertex to remove */
+
+/* moves a vertex, i.e. removes it and then re-inserts it (with the same index) at its new position */
+void convhull_3d_moveVertex(/* input arguments */
+                            void* const hCH,                    /* convexhull object */
+                            const int index,                    /* index of the vertex to move */
+                            ch_vertex vertex);                  /* new position of the vertex */
+
+/* returns the current face indices of the hull */
+void convhull_3d_getFaces(/* input arguments */
+                          void* const hCH,                      /* convexhull object */
+                          /* output arguments */
+                          int** out_faces,                      /* & of empty int*, output face indices; flat: nOut_faces x 3 */
+                          int* nOut_faces);                     /* & of int, number of output face indices */
     
 /* exports the vertices, face indices, and face normals, as an 'obj' file, ready for GPU */
 void convhull_3d_export_obj(/* input arguments */
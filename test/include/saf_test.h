@@ -0,0 +1,74 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Filename: saf_test.h (include header)
+ * -------------------------------------
+ * Unit tests for the spatial audio framework. The tests are compiled together
+ * with the framework sources (test/src/saf_test.c provides "main"), and the
+ * program returns the number of failed tests.
+ *
+ * Dependencies:
+ *     saf_utilities, saf_vbap, convhull_3d
+ * Author, date created:
+ *     agent, 18.10.2026
+ */
+
+#ifndef __SAF_TEST_H_INCLUDED__
+#define __SAF_TEST_H_INCLUDED__
+
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* reports the failed condition, and returns 1 from the calling test */
+#define SAF_TEST_ASSERT(cond) \
+    do { if(!(cond)){ fprintf(stderr, "%s:%d: assertion failed: %s\n", __FILE__, __LINE__, #cond); return 1; } } while(0)
+    
+/* ========================================================================== */
+/*                                    Tests                                   */
+/* ========================================================================== */
+
+/*
+ * Function: test__convhull_3d_incremental
+ * ---------------------------------------
+ * Inserts, removes and moves vertices of a convexhull object, and compares
+ * its faces with those of a hull built from scratch after every change
+ *
+ * Output Arguments:
+ *     0: test passed, 1: test failed
+ */
+int test__convhull_3d_incremental(void);
+
+/*
+ * Function: test__vbapGainTable3D_update
+ * --------------------------------------
+ * Moves loudspeakers one at a time, and compares the incrementally updated
+ * VBAP gain table with one created from scratch after every move
+ *
+ * Output Arguments:
+ *     0: test passed, 1: test failed
+ */
+int test__vbapGainTable3D_update(void);
+
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __SAF_TEST_H_INCLUDED__ */
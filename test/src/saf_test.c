@@ -0,0 +1,56 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Filename: saf_test.c
+ * --------------------
+ * Runs all of the unit tests, and returns the number of failed tests.
+ *
+ * Dependencies:
+ *     saf_utilities, saf_vbap, convhull_3d
+ * Author, date created:
+ *     agent, 18.10.2026
+ */
+
+#include "../include/saf_test.h"
+
+typedef struct _saf_test {
+    const char* name;
+    int (*func)(void);
+}saf_test;
+
+static const saf_test tests[] = {
+    { "convhull_3d_incremental", test__convhull_3d_incremental },
+    { "vbapGainTable3D_update", test__vbapGainTable3D_update },
+};
+
+int main(void)
+{
+    int i, nTests, nFailed;
+    
+    nTests = (int)(sizeof(tests)/sizeof(saf_test));
+    nFailed = 0;
+    for(i=0; i<nTests; i++){
+        if(tests[i].func()){
+            printf("FAIL: %s\n", tests[i].name);
+            nFailed++;
+        }
+        else
+            printf("PASS: %s\n", tests[i].name);
+    }
+    printf("%d of %d tests passed\n", nTests-nFailed, nTests);
+    return nFailed;
+}
@@ -0,0 +1,229 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Filename: test__convhull_3d.c
+ * -----------------------------
+ * Unit tests for the incremental convexhull object.
+ *
+ * Dependencies:
+ *     convhull_3d
+ * Author, date created:
+ *     agent, 18.10.2026
+ */
+
+#include "../include/saf_test.h"
+#include "../../framework/resources/convhull_3d/convhull_3d.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define TEST_CH_MAX_VERT ( 128 )
+
+/* rotates each face so that its smallest index comes first (keeping its orientation), and sorts the faces */
+static int cmpFace(const void* a, const void* b)
+{
+    const int* fa = (const int*)a, *fb = (const int*)b;
+    int k;
+    for(k=0; k<3; k++)
+        if(fa[k]!=fb[k])
+            return fa[k] < fb[k] ? -1 : 1;
+    return 0;
+}
+static void normaliseFaces(int* faces, int nFaces)
+{
+    int i, tmp;
+    for(i=0; i<nFaces; i++){
+        while(faces[i*3]>faces[i*3+1] || faces[i*3]>faces[i*3+2]){
+            tmp = faces[i*3];
+            faces[i*3] = faces[i*3+1];
+            faces[i*3+1] = faces[i*3+2];
+            faces[i*3+2] = tmp;
+        }
+    }
+    qsort(faces, nFaces, 3*sizeof(int), cmpFace);
+}
+
+/* checks that the faces of the object match those of a hull built from scratch from the vertices that are in use */
+static int compareWithRebuild(void* hCH, ch_vertex* vertices, int* inUse, int nVert)
+{
+    int i, nLive, nF, nF_ref;
+    int liveIdx[TEST_CH_MAX_VERT];
+    ch_vertex live[TEST_CH_MAX_VERT];
+    int* faces, *faces_ref;
+    
+    for(i=0, nLive=0; i<nVert; i++){
+        if(inUse[i]){
+            liveIdx[nLive] = i;
+            live[nLive++] = vertices[i];
+        }
+    }
+    faces = faces_ref = NULL;
+    convhull_3d_getFaces(hCH, &faces, &nF);
+    convhull_3d_build(live, nLive, &faces_ref, &nF_ref);
+    SAF_TEST_ASSERT(nF==nF_ref && nF>0);
+    for(i=0; i<nF_ref*3; i++)
+        faces_ref[i] = liveIdx[faces_ref[i]];
+    normaliseFaces(faces, nF);
+    normaliseFaces(faces_ref, nF_ref);
+    SAF_TEST_ASSERT(memcmp(faces, faces_ref, nF*3*sizeof(int))==0);
+    free(faces);
+    free(faces_ref);
+    return 0;
+}
+
+/* checks that no vertex in use lies in front of any face */
+static int checkConvex(void* hCH, ch_vertex* vertices, int* inUse, int nVert)
+{
+    int i, j, nF;
+    int* faces;
+    double a[3], b[3], n[3], d;
+    
+    faces = NULL;
+    convhull_3d_getFaces(hCH, &faces, &nF);
+    for(j=0; j<nF; j++){
+        for(i=0; i<3; i++){
+            a[i] = vertices[faces[j*3+1]].v[i] - vertices[faces[j*3]].v[i];
+            b[i] = vertices[faces[j*3+2]].v[i] - vertices[faces[j*3]].v[i];
+        }
+        n[0] = a[1]*b[2]-a[2]*b[1]; n[1] = a[2]*b[0]-a[0]*b[2]; n[2] = a[0]*b[1]-a[1]*b[0];
+        for(i=0; i<nVert; i++){
+            if(!inUse[i])
+                continue;
+            d = n[0]*(vertices[i].x-vertices[faces[j*3]].x) + n[1]*(vertices[i].y-vertices[faces[j*3]].y) +
+                n[2]*(vertices[i].z-vertices[faces[j*3]].z);
+            SAF_TEST_ASSERT(d < 1e-5);
+        }
+    }
+    free(faces);
+    return 0;
+}
+
+static ch_vertex randomVertex(double r)
+{
+    ch_vertex v;
+    double azi, z;
+    azi = 2.0*M_PI*rand()/(double)RAND_MAX;
+    z = 2.0*rand()/(double)RAND_MAX - 1.0;
+    v.x = r*sqrt(1.0-z*z)*cos(azi);
+    v.y = r*sqrt(1.0-z*z)*sin(azi);
+    v.z = r*z;
+    return v;
+}
+
+int test__convhull_3d_incremental(void)
+{
+    int i, j, nVert, nF;
+    int inUse[TEST_CH_MAX_VERT];
+    int* faces;
+    void* hCH;
+    ch_vertex vertices[TEST_CH_MAX_VERT];
+    ch_vertex octahedron[7] = { {{{1,0,0}}}, {{{-1,0,0}}}, {{{0,1,0}}}, {{{0,-1,0}}}, {{{0,0,1}}}, {{{0,0,-1}}},
+                                {{{0,0,0.5}}} };
+    
+    srand(1);
+    
+    /* points on the unit sphere, mixed with points inside it */
+    nVert = 40;
+    for(i=0; i<nVert; i++){
+        vertices[i] = randomVertex(i%4==3 ? 0.5+0.4*rand()/(double)RAND_MAX : 1.0);
+        inUse[i] = 1;
+    }
+    convhull_3d_create(&hCH, vertices, nVert);
+    SAF_TEST_ASSERT(compareWithRebuild(hCH, vertices, inUse, nVert)==0);
+    
+    /* insertions */
+    for(j=0; j<20; j++){
+        vertices[nVert] = randomVertex(j%2 ? 0.95 : 1.05);
+        inUse[nVert] = 1;
+        SAF_TEST_ASSERT(convhull_3d_insertVertex(hCH, vertices[nVert])==nVert);
+        nVert++;
+        SAF_TEST_ASSERT(compareWithRebuild(hCH, vertices, inUse, nVert)==0);
+    }
+    
+    /* removals (of hull and interior vertices), which may uncover interior vertices */
+    for(j=0; j<20; j++){
+        i = (j*7)%nVert;
+        if(!inUse[i])
+            continue;
+        convhull_3d_removeVertex(hCH, i);
+        inUse[i] = 0;
+        SAF_TEST_ASSERT(compareWithRebuild(hCH, vertices, inUse, nVert)==0);
+    }
+    
+    /* moves, including those of removed vertices (which re-adds them) */
+    for(j=0; j<30; j++){
+        i = (j*11)%nVert;
+        vertices[i] = randomVertex(j%3==0 ? 0.6 : 1.0);
+        convhull_3d_moveVertex(hCH, i, vertices[i]);
+        inUse[i] = 1;
+        SAF_TEST_ASSERT(compareWithRebuild(hCH, vertices, inUse, nVert)==0);
+    }
+    convhull_3d_destroy(&hCH);
+    
+    /* removing the top of an octahedron uncovers the interior point below it: 4 faces around the interior point, and
+     * the 4 faces of the bottom half (the equator is coplanar, so only the number of faces and convexity are checked) */
+    for(i=0; i<7; i++)
+        inUse[i] = 1;
+    convhull_3d_create(&hCH, octahedron, 7);
+    convhull_3d_removeVertex(hCH, 4);
+    inUse[4] = 0;
+    faces = NULL;
+    convhull_3d_getFaces(hCH, &faces, &nF);
+    SAF_TEST_ASSERT(nF==8);
+    for(i=0; i<nF*3 && faces[i]!=6; i++);
+    SAF_TEST_ASSERT(i<nF*3);
+    free(faces);
+    SAF_TEST_ASSERT(checkConvex(hCH, octahedron, inUse, 7)==0);
+    
+    /* moving the top back restores the octahedron */
+    convhull_3d_moveVertex(hCH, 4, octahedron[4]);
+    inUse[4] = 1;
+    convhull_3d_getFaces(hCH, &faces, &nF);
+    SAF_TEST_ASSERT(nF==8);
+    for(i=0; i<nF*3; i++)
+        SAF_TEST_ASSERT(faces[i]!=6);
+    free(faces);
+    SAF_TEST_ASSERT(checkConvex(hCH, octahedron, inUse, 7)==0);
+    convhull_3d_destroy(&hCH);
+    
+    /* starting from fewer than 4 vertices: there are no faces until 4 non-coplanar vertices exist */
+    vertices[0].x = 0.0; vertices[0].y = 0.0; vertices[0].z = 0.0;
+    vertices[1].x = 1.0; vertices[1].y = 0.0; vertices[1].z = 0.0;
+    vertices[2].x = 0.0; vertices[2].y = 1.0; vertices[2].z = 0.0;
+    vertices[3].x = 1.0; vertices[3].y = 1.0; vertices[3].z = 0.0;
+    vertices[4].x = 0.3; vertices[4].y = 0.4; vertices[4].z = 1.0;
+    vertices[5].x = 0.5; vertices[5].y = 0.5; vertices[5].z = -1.0;
+    for(i=0; i<6; i++)
+        inUse[i] = 1;
+    convhull_3d_create(&hCH, vertices, 2);
+    convhull_3d_getFaces(hCH, &faces, &nF);
+    SAF_TEST_ASSERT(nF==0 && faces==NULL);
+    convhull_3d_insertVertex(hCH, vertices[2]);
+    convhull_3d_insertVertex(hCH, vertices[3]); /* coplanar with the first three */
+    convhull_3d_getFaces(hCH, &faces, &nF);
+    SAF_TEST_ASSERT(nF==0 && faces==NULL);
+    convhull_3d_insertVertex(hCH, vertices[4]);
+    convhull_3d_getFaces(hCH, &faces, &nF);
+    SAF_TEST_ASSERT(nF==6);
+    free(faces);
+    SAF_TEST_ASSERT(checkConvex(hCH, vertices, inUse, 5)==0);
+    convhull_3d_insertVertex(hCH, vertices[5]);
+    SAF_TEST_ASSERT(compareWithRebuild(hCH, vertices, inUse, 6)==0);
+    convhull_3d_destroy(&hCH);
+    
+    return 0;
+}
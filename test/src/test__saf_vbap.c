@@ -0,0 +1,128 @@
+/*
+ * Copyright 2026 agent
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Filename: test__saf_vbap.c
+ * --------------------------
+ * Unit tests for the saf_vbap module.
+ *
+ * Dependencies:
+ *     saf_utilities, saf_vbap
+ * Author, date created:
+ *     agent, 18.10.2026
+ */
+
+#include "../include/saf_test.h"
+#include "../../framework/include/saf.h"
+
+#define TEST_VBAP_MAX_LS ( 32 )
+
+/* expands a compressed gain table into a dense one (FLAT: N x L) */
+static void expandGainTable(float* comp, int* idx, int nnz, int N, int L, float* dense)
+{
+    int i, k;
+    
+    memset(dense, 0, N*L*sizeof(float));
+    for(i=0; i<N; i++)
+        for(k=0; k<nnz; k++)
+            dense[i*L+idx[i*nnz+k]] += comp[i*nnz+k];
+}
+
+/* compares the incrementally updated table with one created from scratch for the same directions (returns 0 if they
+ * are the same) */
+static int compareWithCreate(float* comp, int* idx, int nnz, int nTri, float* ls_dirs_deg, int L, int omitLargeTriangles,
+                             float spread)
+{
+    int i, failed, nnz_ref, N_ref, nTri_ref;
+    int* idx_ref;
+    float* comp_ref, *dense, *dense_ref;
+    void* hRef;
+    
+    vbapGainTable3D_create(&hRef, ls_dirs_deg, L, 2, 5, omitLargeTriangles, 1, spread, &comp_ref, &idx_ref, &nnz_ref,
+                           &N_ref, &nTri_ref);
+    failed = nTri!=nTri_ref || nnz!=nnz_ref;
+    dense = malloc1d(N_ref*L*sizeof(float));
+    dense_ref = malloc1d(N_ref*L*sizeof(float));
+    if(!failed){
+        expandGainTable(comp, idx, nnz, N_ref, L, dense);
+        expandGainTable(comp_ref, idx_ref, nnz_ref, N_ref, L, dense_ref);
+        for(i=0; i<N_ref*L && !failed; i++)
+            failed = fabsf(dense[i]-dense_ref[i]) >= 1e-4f;
+    }
+    free(dense);
+    free(dense_ref);
+    free(comp_ref);
+    free(idx_ref);
+    vbapGainTable3D_destroy(&hRef);
+    return failed;
+}
+
+int test__vbapGainTable3D_update(void)
+{
+    int i, j, s, o, L, nnz, N_gtable, nTri, ls, failed;
+    int* idx;
+    float spread;
+    float ls_dirs_deg[TEST_VBAP_MAX_LS*2];
+    float* comp;
+    void* hVBAP;
+    
+    srand(2);
+    failed = 0;
+    for(o=0; o<2 && !failed; o++){ /* omitLargeTriangles 0 and 1 (the panner uses 1) */
+        for(s=0; s<2 && !failed; s++){
+            spread = s==0 ? 0.0f : 20.0f;
+            
+            /* a ring of loudspeakers with one below it, which moves above it: the dummy at the top is replaced by
+             * one at the bottom, while the number of dummies stays the same */
+            L = 9;
+            for(i=0; i<8; i++){
+                ls_dirs_deg[i*2] = -180.0f + (float)i*45.0f;
+                ls_dirs_deg[i*2+1] = 0.0f;
+            }
+            ls_dirs_deg[8*2] = 0.0f;
+            ls_dirs_deg[8*2+1] = -70.0f;
+            vbapGainTable3D_create(&hVBAP, ls_dirs_deg, L, 2, 5, o, 1, spread, &comp, &idx, &nnz, &N_gtable, &nTri);
+            ls_dirs_deg[8*2+1] = 70.0f;
+            vbapGainTable3D_update(hVBAP, ls_dirs_deg, L, spread, &comp, &idx, &nnz, &N_gtable, &nTri);
+            failed = compareWithCreate(comp, idx, nnz, nTri, ls_dirs_deg, L, o, spread);
+            free(comp);
+            free(idx);
+            vbapGainTable3D_destroy(&hVBAP);
+            SAF_TEST_ASSERT(!failed);
+            
+            /* random layouts, where one loudspeaker is moved at a time (with and without dummies being affected) */
+            L = 20;
+            for(i=0; i<L; i++){
+                ls_dirs_deg[i*2] = -180.0f + 360.0f*(float)rand()/(float)RAND_MAX;
+                ls_dirs_deg[i*2+1] = -50.0f + 130.0f*(float)rand()/(float)RAND_MAX;
+            }
+            vbapGainTable3D_create(&hVBAP, ls_dirs_deg, L, 2, 5, o, 1, spread, &comp, &idx, &nnz, &N_gtable, &nTri);
+            for(j=0; j<10 && !failed; j++){
+                ls = rand()%L;
+                ls_dirs_deg[ls*2] = -180.0f + 360.0f*(float)rand()/(float)RAND_MAX;
+                ls_dirs_deg[ls*2+1] = -80.0f + 160.0f*(float)rand()/(float)RAND_MAX;
+                vbapGainTable3D_update(hVBAP, ls_dirs_deg, L, spread, &comp, &idx, &nnz, &N_gtable, &nTri);
+                failed = compareWithCreate(comp, idx, nnz, nTri, ls_dirs_deg, L, o, spread);
+            }
+            free(comp);
+            free(idx);
+            vbapGainTable3D_destroy(&hVBAP);
+            SAF_TEST_ASSERT(!failed);
+        }
+    }
+    
+    return 0;
+}